@@ -0,0 +1,578 @@
+#include <benchmark/benchmark.h>
+#include <bit>
+#include <chrono>
+#include <execution>
+#include <string>
+#include <random>
+#include <vector>
+#include <ranges>
+#include <set>
+#include "bdd.h"
+#include "BDDHelper.hpp"
+#include "BDDFormulaBuilder.hpp"
+#include "Conditions.hpp"
+#include "VarOrder.hpp"
+#include "MDDHelper.hpp"
+#include "ZDDHelper.hpp"
+#include "DiagramFormulaBuilder.hpp"
+#include <tbb/global_control.h>
+#include <tbb/task_arena.h>
+
+using namespace bddHelper;
+
+namespace
+{
+  template < class T > using vect = std::vector< T >;
+
+  const std::set< ConditionTypes > puzzleTypes = {
+    ConditionTypes::FIRST,
+    ConditionTypes::SECOND,
+    ConditionTypes::FOURTH,
+    ConditionTypes::UNIQUE,
+    ConditionTypes::UPPER_BOUND
+  };
+
+  // Runs body once per iteration of state on a fresh kernel, with an
+  // initial table of the given number of nodes and the variables of the
+  // puzzle. Starting and stopping the kernel is not timed.
+  template < class F > void withKernel(benchmark::State &state, int nodes, F body)
+  {
+    for (auto _ : state)
+    {
+      state.PauseTiming();
+      bdd_init(nodes, 100000);
+      bdd_gbc_hook(nullptr);
+      bdd_setvarnum(BDDHelper::nTotalVars);
+      state.ResumeTiming();
+      body();
+      state.PauseTiming();
+      bdd_done();
+      state.ResumeTiming();
+    }
+  }
+}
+
+// Builds the full 144-variable puzzle from main.cpp and counts it.
+// The argument is the initial node table size; small tables force
+// garbage collections and resizes during the build.
+static void BM_PuzzleBuild(benchmark::State &state)
+{
+  double produced = 0;
+  withKernel(state, state.range(0), [&produced] {
+    BDDHelper h(varOrder::VarOrder(varOrder::Strategy::OBJECT_MAJOR).structedVars());
+    BDDFormulaBuilder builder;
+    conditions::addConditions(h, builder, puzzleTypes);
+    benchmark::DoNotOptimize(bdd_satcount(builder.result()));
+    bddStat stat;
+    bdd_stats(&stat);
+    produced += stat.produced;
+  });
+  state.counters["nodes/s"] = benchmark::Counter(produced, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_PuzzleBuild)->Arg(3000000)->Arg(20000)->Unit(benchmark::kMillisecond);
+
+// Lookups of the value and variable tables of BDDHelper, the way the
+// conditions make them: every value of every property of every object,
+// then the variables of every object property.
+static void BM_HelperAccess(benchmark::State &state)
+{
+  bdd_init(100000, 10000);
+  bdd_gbc_hook(nullptr);
+  bdd_setvarnum(BDDHelper::nTotalVars);
+  {
+    BDDHelper h(varOrder::VarOrder(varOrder::Strategy::OBJECT_MAJOR).structedVars());
+    for (auto _ : state)
+    {
+      for (auto objNum : std::views::iota(0, BDDHelper::nObjs))
+      {
+        auto obj = static_cast< Object >(objNum);
+        for (auto valNum : std::views::iota(0, BDDHelper::nVals))
+        {
+          benchmark::DoNotOptimize(h.getObjectVal(obj, static_cast< Hair >(valNum)));
+          benchmark::DoNotOptimize(h.getObjectVal(obj, static_cast< Nation >(valNum)));
+          benchmark::DoNotOptimize(h.getObjectVal(obj, static_cast< Transport >(valNum)));
+          benchmark::DoNotOptimize(h.getObjectVal(obj, static_cast< Owns >(valNum)));
+        }
+        for (auto propNum : std::views::iota(0, BDDHelper::nProps))
+        {
+          const auto &vars = h.getObjPropertyVars(obj, static_cast< Property >(propNum));
+          benchmark::DoNotOptimize(vars[BDDHelper::nValueBits - 1]);
+        }
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * BDDHelper::nObjs * BDDHelper::nProps * (BDDHelper::nVals + 1));
+  }
+  bdd_done();
+}
+BENCHMARK(BM_HelperAccess);
+
+// Builds the puzzle with each static variable order and no reordering.
+// The argument is a varOrder::Strategy; HEURISTIC includes the time spent
+// choosing the order.
+static void BM_VarOrder(benchmark::State &state)
+{
+  auto strategy = static_cast< varOrder::Strategy >(state.range(0));
+  double nodes = 0;
+  withKernel(state, 1000000, [strategy, &nodes] {
+    varOrder::VarOrder order(strategy);
+    if (strategy == varOrder::Strategy::HEURISTIC)
+      order = varOrder::VarOrder::heuristic([](const varOrder::VarOrder &probe) {
+        BDDFormulaBuilder collect(BDDFormulaBuilder::Mode::COLLECT);
+        BDDHelper probeHelper(probe.structedVars());
+        conditions::addConditions(probeHelper, collect, puzzleTypes);
+        return collect.conditions();
+      });
+    BDDHelper h(order.structedVars());
+    BDDFormulaBuilder builder;
+    conditions::addConditions(h, builder, puzzleTypes);
+    nodes = bdd_nodecount(builder.result());
+  });
+  state.SetLabel(std::string(varOrder::name(strategy)));
+  state.counters["nodes"] = nodes;
+}
+BENCHMARK(BM_VarOrder)
+  ->Arg(static_cast< int >(varOrder::Strategy::OBJECT_MAJOR))
+  ->Arg(static_cast< int >(varOrder::Strategy::PROPERTY_MAJOR))
+  ->Arg(static_cast< int >(varOrder::Strategy::INTERLEAVED))
+  ->Arg(static_cast< int >(varOrder::Strategy::HEURISTIC))
+  ->Unit(benchmark::kMillisecond);
+
+// Builds the puzzle with the bit encoding of BDDHelper (0) or its FDD
+// encoding (1), in the object-major or interleaved order (second
+// argument, a varOrder::Strategy), and decodes one solution: bdd_allsat
+// and the bits for the first, fdd_scanallvar for the second.
+static void BM_Encoding(benchmark::State &state)
+{
+  bool fdd = state.range(0) == 1;
+  auto strategy = static_cast< varOrder::Strategy >(state.range(1));
+  double nodes = 0;
+  double decodeUs = 0;
+  withKernel(state, 1000000, [fdd, strategy, &nodes, &decodeUs] {
+    varOrder::VarOrder order(strategy);
+    auto h = fdd ? BDDHelper(order.domainGroups()) : BDDHelper(order.structedVars());
+    BDDFormulaBuilder builder;
+    conditions::addConditions(h, builder, puzzleTypes);
+    nodes = bdd_nodecount(builder.result());
+
+    auto start = std::chrono::steady_clock::now();
+    vect< vect< int > > solution;
+    if (fdd)
+      solution = *h.anySolution(builder.result());
+    else
+    {
+      // Same as main.cpp: every satisfying path is visited, the first one
+      // is kept.
+      static std::string first;
+      first.clear();
+      bdd_allsat(builder.result(), [](char *varset, int size) {
+        if (first.empty())
+          first.assign(varset, size);
+      });
+      solution.assign(BDDHelper::nObjs, vect< int >(BDDHelper::nProps));
+      for (auto obj : std::views::iota(0, BDDHelper::nObjs))
+        for (auto prop : std::views::iota(0, BDDHelper::nProps))
+          for (auto bit : std::views::iota(0, BDDHelper::nValueBits))
+            solution[obj][prop] = (solution[obj][prop] << 1) + (first[order.var(obj, prop, bit)] == 1);
+    }
+    benchmark::DoNotOptimize(solution);
+    decodeUs = std::chrono::duration< double, std::micro >(std::chrono::steady_clock::now() - start).count();
+  });
+  state.SetLabel(std::string(fdd ? "fdd/" : "bits/") + std::string(varOrder::name(strategy)));
+  state.counters["nodes"] = nodes;
+  state.counters["decode_us"] = decodeUs;
+}
+BENCHMARK(BM_Encoding)
+  ->ArgsProduct({{0, 1},
+                 {static_cast< int >(varOrder::Strategy::OBJECT_MAJOR),
+                  static_cast< int >(varOrder::Strategy::INTERLEAVED)}})
+  ->Unit(benchmark::kMillisecond);
+
+// Builds the puzzle with the conditions conjoined in the
+// BDDFormulaBuilder::Mode of the first argument, in the order given by
+// the second, a varOrder::Strategy. The third is the batch size of
+// BALANCED mode. Batches are run in the object-major order only: in the
+// property-major one batches of four or more take over half a minute.
+static void BM_Conjoin(benchmark::State &state)
+{
+  auto mode = static_cast< BDDFormulaBuilder::Mode >(state.range(0));
+  auto strategy = static_cast< varOrder::Strategy >(state.range(1));
+  int batch = static_cast< int >(state.range(2));
+  double largest = 0;
+  withKernel(state, 1000000, [mode, strategy, batch, &largest] {
+    BDDHelper h(varOrder::VarOrder(strategy).structedVars());
+    BDDFormulaBuilder builder(mode, batch);
+    builder.measureLargest();
+    conditions::addConditions(h, builder, puzzleTypes);
+    benchmark::DoNotOptimize(builder.result());
+    largest = builder.largestNodes();
+  });
+  std::string label = mode == BDDFormulaBuilder::Mode::BALANCED    ? "balanced/" + std::to_string(batch)
+                      : mode == BDDFormulaBuilder::Mode::SCHEDULED ? "scheduled"
+                                                                   : "sequential";
+  state.SetLabel(label + "/" + std::string(varOrder::name(strategy)));
+  state.counters["largest"] = largest;
+}
+BENCHMARK(BM_Conjoin)
+  ->ArgsProduct({{static_cast< int >(BDDFormulaBuilder::Mode::CONJOIN),
+                  static_cast< int >(BDDFormulaBuilder::Mode::SCHEDULED)},
+                 {static_cast< int >(varOrder::Strategy::OBJECT_MAJOR),
+                  static_cast< int >(varOrder::Strategy::PROPERTY_MAJOR),
+                  static_cast< int >(varOrder::Strategy::INTERLEAVED)},
+                 {0}})
+  ->ArgsProduct({{static_cast< int >(BDDFormulaBuilder::Mode::BALANCED)},
+                 {static_cast< int >(varOrder::Strategy::OBJECT_MAJOR)},
+                 {2, 4, 8, 16, 32}})
+  ->Unit(benchmark::kMillisecond);
+
+// Builds the puzzle in SCHEDULED mode, whole (first argument 0) or
+// projected on the owns of every object (1, BDDFormulaBuilder::project),
+// in the order given by the second argument, a varOrder::Strategy.
+static void BM_Project(benchmark::State &state)
+{
+  bool projected = state.range(0) == 1;
+  auto strategy = static_cast< varOrder::Strategy >(state.range(1));
+  double largest = 0;
+  double nodes = 0;
+  withKernel(state, 1000000, [projected, strategy, &largest, &nodes] {
+    BDDHelper h(varOrder::VarOrder(strategy).structedVars());
+    BDDFormulaBuilder builder(BDDFormulaBuilder::Mode::SCHEDULED);
+    if (projected)
+      builder.project(h.propertyVars(Property::OWNS));
+    conditions::addConditions(h, builder, puzzleTypes);
+    nodes = bdd_nodecount(builder.result());
+    largest = builder.largestNodes();
+  });
+  state.SetLabel(std::string(projected ? "owns/" : "all/") + std::string(varOrder::name(strategy)));
+  state.counters["largest"] = largest;
+  state.counters["nodes"] = nodes;
+}
+BENCHMARK(BM_Project)
+  ->ArgsProduct({{0, 1},
+                 {static_cast< int >(varOrder::Strategy::OBJECT_MAJOR),
+                  static_cast< int >(varOrder::Strategy::PROPERTY_MAJOR),
+                  static_cast< int >(varOrder::Strategy::INTERLEAVED)}})
+  ->Unit(benchmark::kMillisecond);
+
+// Builds the puzzle from properties.properties with each backend:
+// 0 is the binary BDD encoding, 1 the MDD and 2 the one-hot ZDD.
+static void BM_Backend(benchmark::State &state)
+{
+  double nodes = 0;
+  double solutions = 0;
+  for (auto _ : state)
+  {
+    switch (state.range(0))
+    {
+      case 0:
+      {
+        bdd_init(1000000, 100000);
+        bdd_gbc_hook(nullptr);
+        bdd_setvarnum(BDDHelper::nTotalVars);
+        {
+          BDDHelper h(varOrder::VarOrder(varOrder::Strategy::OBJECT_MAJOR).structedVars());
+          BDDFormulaBuilder builder;
+          conditions::addConditions(h, builder, puzzleTypes);
+          nodes = bdd_nodecount(builder.result());
+          solutions = bdd_satcount(builder.result());
+        }
+        bdd_done();
+        break;
+      }
+      case 1:
+      {
+        mdd::Manager manager(MDDHelper::arities());
+        MDDHelper h(manager);
+        MDDFormulaBuilder builder(h.trueFormula());
+        conditions::addConditions(h, builder, puzzleTypes);
+        nodes = manager.nodeCount(builder.result());
+        solutions = manager.satCount(builder.result());
+        break;
+      }
+      default:
+      {
+        zdd::Manager manager(ZDDHelper::nTotalVars);
+        ZDDHelper h(manager);
+        ZDDFormulaBuilder builder(h.trueFormula());
+        conditions::addConditions(h, builder, puzzleTypes);
+        nodes = manager.nodeCount(builder.result());
+        solutions = manager.satCount(builder.result());
+        break;
+      }
+    }
+  }
+  constexpr const char *names[] = {"bdd", "mdd", "zdd"};
+  state.SetLabel(names[state.range(0)]);
+  state.counters["nodes"] = nodes;
+  state.counters["solutions"] = solutions;
+}
+BENCHMARK(BM_Backend)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+
+namespace
+{
+  // Encodings of a scaled puzzle with n objects, nScaledProps properties
+  // and n values per property, one per backend. top() is the formula
+  // true, which keeps every value in range.
+  constexpr int nScaledProps = 4;
+
+  class BddScaled
+  {
+  public:
+    explicit BddScaled(int n) : n_(n), bits_(std::bit_width(static_cast< unsigned >(n - 1)))
+    {
+      bdd_init(1000000, 100000);
+      bdd_gbc_hook(nullptr);
+      bdd_setvarnum(n * nScaledProps * bits_);
+    }
+
+    ~BddScaled() { bdd_done(); }
+
+    bdd value(int obj, int prop, int val) const
+    {
+      bdd res = bddtrue;
+      for (int bit = 0; bit < bits_; ++bit)
+        res &= (val >> bit) & 1 ? bdd_ithvar(var(obj, prop, bit)) : bdd_nithvar(var(obj, prop, bit));
+      return res;
+    }
+
+    bdd differ(int obj1, int obj2, int prop) const
+    {
+      bdd res = bddfalse;
+      for (int bit = 0; bit < bits_; ++bit)
+        res |= bdd_apply(bdd_ithvar(var(obj1, prop, bit)), bdd_ithvar(var(obj2, prop, bit)), bddop_xor);
+      return res;
+    }
+
+    bdd none() const { return bddfalse; }
+
+    bdd top() const
+    {
+      bdd res = bddtrue;
+      for (int obj = 0; obj < n_; ++obj)
+        for (int prop = 0; prop < nScaledProps; ++prop)
+        {
+          bdd inRange = bddfalse;
+          for (int val = 0; val < n_; ++val)
+            inRange |= value(obj, prop, val);
+          res &= inRange;
+        }
+      return res;
+    }
+
+    double nodes(const bdd &f) const { return bdd_nodecount(f); }
+
+    double count(const bdd &f) const { return bdd_satcount(f); }
+
+  private:
+    int var(int obj, int prop, int bit) const { return (obj * nScaledProps + prop) * bits_ + bit; }
+
+    int n_;
+    int bits_;
+  };
+
+  class MddScaled
+  {
+  public:
+    explicit MddScaled(int n) : manager_(vect< int >(n * nScaledProps, n)) {}
+
+    mdd::Mdd value(int obj, int prop, int val) { return manager_.value(obj * nScaledProps + prop, val); }
+
+    mdd::Mdd differ(int obj1, int obj2, int prop)
+    {
+      auto same = manager_.zero();
+      for (int val = 0; val < manager_.arity(0); ++val)
+        same |= value(obj1, prop, val) & value(obj2, prop, val);
+      return !same;
+    }
+
+    mdd::Mdd none() { return manager_.zero(); }
+
+    mdd::Mdd top() { return manager_.one(); }
+
+    double nodes(const mdd::Mdd &f) const { return manager_.nodeCount(f); }
+
+    double count(const mdd::Mdd &f) const { return manager_.satCount(f); }
+
+  private:
+    mdd::Manager manager_;
+  };
+
+  class ZddScaled
+  {
+  public:
+    explicit ZddScaled(int n) : n_(n), manager_(n * nScaledProps * n)
+    {
+      domain_ = manager_.base();
+      for (int group = n * nScaledProps - 1; group >= 0; --group)
+      {
+        auto oneOf = manager_.empty();
+        for (int val = n - 1; val >= 0; --val)
+          oneOf = manager_.node(group * n + val, oneOf, domain_);
+        domain_ = oneOf;
+      }
+    }
+
+    zdd::Zdd value(int obj, int prop, int val) { return manager_.withVar(domain_, var(obj, prop, val)); }
+
+    zdd::Zdd differ(int obj1, int obj2, int prop)
+    {
+      auto same = manager_.empty();
+      for (int val = 0; val < n_; ++val)
+        same |= manager_.withVar(value(obj1, prop, val), var(obj2, prop, val));
+      return domain_ - same;
+    }
+
+    zdd::Zdd none() { return manager_.empty(); }
+
+    zdd::Zdd top() { return domain_; }
+
+    double nodes(const zdd::Zdd &f) const { return manager_.nodeCount(f); }
+
+    double count(const zdd::Zdd &f) const { return manager_.satCount(f); }
+
+  private:
+    int var(int obj, int prop, int val) const { return (obj * nScaledProps + prop) * n_ + val; }
+
+    int n_;
+    zdd::Manager manager_;
+    zdd::Zdd domain_;
+  };
+
+  // All values of a property differ, value v of property 0 goes with
+  // value v of every other property, and the first two objects are fixed.
+  // There are (n-2)! solutions.
+  template < class Encoding_t >
+  void solveScaled(benchmark::State &state)
+  {
+    int n = static_cast< int >(state.range(1));
+    double nodes = 0;
+    double solutions = 0;
+    for (auto _ : state)
+    {
+      // Same order as the real puzzle: the conditions that tie values
+      // together come before the all-different ones.
+      Encoding_t e(n);
+      auto f = e.top();
+      f &= e.value(0, 0, 0);
+      f &= e.value(1, 0, 1);
+      for (int prop = 1; prop < nScaledProps; ++prop)
+        for (int val = 0; val < n; ++val)
+        {
+          auto somewhere = e.none();
+          for (int obj = 0; obj < n; ++obj)
+            somewhere |= e.value(obj, 0, val) & e.value(obj, prop, val);
+          f &= somewhere;
+        }
+      for (int prop = 0; prop < nScaledProps; ++prop)
+        for (int obj1 = 0; obj1 < n; ++obj1)
+          for (int obj2 = obj1 + 1; obj2 < n; ++obj2)
+            f &= e.differ(obj1, obj2, prop);
+      nodes = e.nodes(f);
+      solutions = e.count(f);
+    }
+    state.counters["nodes"] = nodes;
+    state.counters["solutions"] = solutions;
+  }
+}
+
+// The scaled puzzle with each backend, numbered as in BM_Backend. The
+// second argument is the number of objects and values.
+static void BM_BackendScaled(benchmark::State &state)
+{
+  constexpr const char *names[] = {"bdd", "mdd", "zdd"};
+  state.SetLabel(names[state.range(0)]);
+  switch (state.range(0))
+  {
+    case 0:
+      solveScaled< BddScaled >(state);
+      break;
+    case 1:
+      solveScaled< MddScaled >(state);
+      break;
+    default:
+      solveScaled< ZddScaled >(state);
+      break;
+  }
+}
+BENCHMARK(BM_BackendScaled)->ArgsProduct({{0, 1, 2}, {6, 9, 12}})->Unit(benchmark::kMillisecond);
+
+// The scaled BDD puzzle of BM_BackendScaled, its conditions made and
+// conjoined in parallel, each thread into a partial result of its own
+// (BDDFormulaBuilder::addConditionPartial). The arguments are the number
+// of threads and of objects.
+static void BM_Partial(benchmark::State &state)
+{
+  int threads = static_cast< int >(state.range(0));
+  int n = static_cast< int >(state.range(1));
+  // Lets the arena have more threads than cores.
+  tbb::global_control workers(tbb::global_control::max_allowed_parallelism, threads);
+  tbb::task_arena arena(threads);
+  double nodes = 0;
+  for (auto _ : state)
+  {
+    BddScaled e(n);
+    arena.execute([&] {
+      BDDFormulaBuilder builder;
+      builder.addCondition(e.top());
+      builder.addCondition(e.value(0, 0, 0));
+      builder.addCondition(e.value(1, 0, 1));
+      int prev = bdd_setconcurrent(threads > 1);
+      auto links = std::views::iota(0, (nScaledProps - 1) * n);
+      std::for_each(std::execution::par, links.begin(), links.end(), [&](int link) {
+        int prop = 1 + link / n;
+        int val = link % n;
+        bdd somewhere = bddfalse;
+        for (int obj = 0; obj < n; ++obj)
+          somewhere |= e.value(obj, 0, val) & e.value(obj, prop, val);
+        builder.addConditionPartial(somewhere);
+      });
+      builder.mergePartials();
+      auto rows = std::views::iota(0, nScaledProps * n);
+      std::for_each(std::execution::par, rows.begin(), rows.end(), [&](int row) {
+        int prop = row / n;
+        for (int obj2 = row % n + 1; obj2 < n; ++obj2)
+          builder.addConditionPartial(e.differ(row % n, obj2, prop));
+      });
+      builder.mergePartials();
+      bdd_setconcurrent(prev);
+      nodes = e.nodes(builder.result());
+    });
+  }
+  state.counters["nodes"] = nodes;
+}
+BENCHMARK(BM_Partial)
+  ->ArgsProduct({{1, 2, 4, 8, 16}, {12}})
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+
+// A synthetic puzzle much larger than the real one: a disjunction of random
+// cubes over 80 variables that keeps about 1M nodes alive. The argument
+// is the number of garbage collection threads; each iteration is one full
+// collection of the same table.
+static void BM_Gbc(benchmark::State &state)
+{
+  bdd_init(2000000, 100000);
+  bdd_gbc_hook(nullptr);
+  bdd_setvarnum(80);
+  bdd_setgbcthreads(state.range(0));
+  {
+    std::mt19937 rng(7);
+    bdd f = bddfalse;
+    for (int step = 0; step < 60; ++step)
+    {
+      bdd cube = bddtrue;
+      for (int lit = 0; lit < 12; ++lit)
+      {
+        int var = rng() % 80;
+        cube &= (rng() & 1) ? bdd_ithvar(var) : bdd_nithvar(var);
+      }
+      f |= cube;
+    }
+    for (auto _ : state)
+      bdd_gbc();
+    state.counters["live"] = bdd_nodecount(f);
+  }
+  bdd_done();
+}
+BENCHMARK(BM_Gbc)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Arg(16)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
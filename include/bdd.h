@@ -33,6 +33,7 @@
   DESCR: C,C++ User interface for the BDD package
   AUTH:  Jorn Lind
   DATE:  (C) feb 1997
+  NOTE:  Implemented by the in-tree C++ engine in src/bdd.
 *************************************************************************/
 
 #ifndef _BDD_H
@@ -62,6 +63,21 @@
 #define bddop_not      10
 #define bddop_simplify 11
 
+   /* Operator classes for the per operator cache counters. Lookups are
+      charged to the top level operator that caused them */
+#define bddstat_and       0   /* bdd_apply with bddop_and */
+#define bddstat_or        1   /* bdd_apply with bddop_or */
+#define bddstat_xor       2   /* bdd_apply with bddop_xor */
+#define bddstat_apply     3   /* bdd_apply with any other operator */
+#define bddstat_not       4   /* bdd_not, free with complement edges */
+#define bddstat_ite       5   /* bdd_ite */
+#define bddstat_exist     6   /* bdd_exist, bdd_forall, bdd_unique */
+#define bddstat_appex     7   /* bdd_appex, bdd_appall, bdd_appuni */
+#define bddstat_replace   8   /* bdd_replace, bdd_compose, bdd_veccompose */
+#define bddstat_cofactor  9   /* bdd_restrict, bdd_constrain, bdd_simplify */
+#define bddstat_satcount 10   /* bdd_satcount(ln), bdd_pathcount */
+#define BDDSTAT_NUM      11
+
 
 /*=== User BDD types ===================================================*/
 
@@ -97,6 +113,8 @@ PROTO   {* typedef struct s_bddStat
    int varnum;
    int cachesize;
    int gbcnum;
+   long unsigned int refcalls;
+   long unsigned int refsaved;
 } bddStat;  *}
 DESCR   {* The fields are \\[\baselineskip] \begin{tabular}{lp{10cm}}
   {\tt produced}     & total number of new nodes ever produced \\
@@ -107,7 +125,10 @@ DESCR   {* The fields are \\[\baselineskip] \begin{tabular}{lp{10cm}}
                        garbage collection. \\
   {\tt varnum}       & number of defined bdd variables \\
   {\tt cachesize}    & number of entries in the internal caches \\
-  {\tt gbcnum}       & number of garbage collections done until now
+  {\tt gbcnum}       & number of garbage collections done until now \\
+  {\tt refcalls}     & number of calls to bdd\_addref and bdd\_delref \\
+  {\tt refsaved}     & number of such calls saved by moving C++ {\tt bdd}
+                       handles instead of copying them
   \end{tabular} *}
 ALSO    {* bdd\_stats *}
 */
@@ -121,6 +142,8 @@ typedef struct s_bddStat
    int varnum;
    int cachesize;
    int gbcnum;
+   long unsigned int refcalls;
+   long unsigned int refsaved;
 } bddStat;
 
 
@@ -155,6 +178,29 @@ typedef struct s_bddGbcStat
 } bddGbcStat;
 
 
+/*
+NAME    {* bddOpCacheStat *}
+SECTION {* kernel *}
+SHORT   {* Cache counters for one class of operators *}
+PROTO   {* typedef struct s_bddOpCacheStat
+{
+   long unsigned int hit;
+   long unsigned int miss;
+   long unsigned int evict;
+} bddOpCacheStat; *}
+DESCR   {* {\tt hit} and {\tt miss} count operator cache lookups,
+           {\tt evict} counts valid entries pushed out of their set by
+           a miss. *}
+ALSO    {* bddCacheStat, bdd\_cachestats *}
+*/
+typedef struct s_bddOpCacheStat
+{
+   long unsigned int hit;
+   long unsigned int miss;
+   long unsigned int evict;
+} bddOpCacheStat;
+
+
 /*
 NAME    {* bddCacheStat *}
 SECTION {* kernel *}
@@ -168,6 +214,7 @@ PROTO   {* typedef struct s_bddCacheStat
    long unsigned int opHit;
    long unsigned int opMiss;
    long unsigned int swapCount;
+   bddOpCacheStat op[BDDSTAT_NUM];
 } bddCacheStat; *}
 DESCR   {* The fields are \\[\baselineskip] \begin{tabular}{ll}
   {\bf Name}         & {\bf Number of } \\
@@ -178,6 +225,7 @@ DESCR   {* The fields are \\[\baselineskip] \begin{tabular}{ll}
   opHit        & entries found in the operator caches \\
   opMiss       & entries not found in the operator caches \\
   swapCount    & number of variable swaps in reordering \\
+  op           & hits, misses and evictions per {\tt bddstat\_} class \\
 \end{tabular} *}
 ALSO    {* bdd\_cachestats *}
 */
@@ -190,6 +238,7 @@ typedef struct s_bddCacheStat
    long unsigned int opHit;
    long unsigned int opMiss;
    long unsigned int swapCount;
+   bddOpCacheStat op[BDDSTAT_NUM];
 } bddCacheStat;
 
 /*=== BDD interface prototypes =========================================*/
@@ -235,6 +284,9 @@ extern int      bdd_isrunning(void);
 extern int      bdd_setmaxnodenum(int);
 extern int      bdd_setmaxincrease(int);
 extern int      bdd_setminfreenodes(int);
+extern int      bdd_setconcurrent(int);
+extern int      bdd_isconcurrent(void);
+extern int      bdd_setgbcthreads(int);
 extern int      bdd_getnodenum(void);
 extern int      bdd_getallocnum(void);
 extern char*    bdd_versionstr(void);
@@ -338,7 +390,11 @@ extern void     bdd_clrvarblocks(void);
 extern int      bdd_addvarblock(BDD, int);
 extern int      bdd_intaddvarblock(int, int, int);
 extern void     bdd_varblockall(void);
+extern int      bdd_addinteraction(BDD);
+extern void     bdd_clrinteraction(void);
 extern bddfilehandler bdd_blockfile_hook(bddfilehandler);
+   /* Automatic reordering stops after a pass that saves less than 10%
+      of the nodes in use, until one of these two is called again */
 extern int      bdd_autoreorder(int);
 extern int      bdd_autoreorder_times(int, int);
 extern int      bdd_var2level(int);
@@ -417,9 +473,17 @@ extern const BDD bddtrue;
 *************************************************************************/
 #ifdef CPLUSPLUS
 #include <iostream>
+#include <atomic>
 
 /*=== User BDD class ===================================================*/
 
+   /* Reference count calls skipped by moving bdd handles instead of
+      copying them. Counted per thread and summed by bdd_stats */
+extern thread_local constinit std::atomic<long unsigned int> bddrefsaved;
+
+inline void bdd_countsaved(int n)
+{ bddrefsaved.store(bddrefsaved.load(std::memory_order_relaxed)+n, std::memory_order_relaxed); }
+
 class bvec;
 
 class bdd
@@ -428,27 +492,29 @@ class bdd
 
    bdd(void)         { root=0; }
    bdd(const bdd &r) { bdd_addref(root=r.root); }
-   ~bdd(void)        { bdd_delref(root); }
+   bdd(bdd &&r) noexcept { root=r.root; r.root=0; bdd_countsaved(2); }
+   ~bdd(void)        { if (root > 1) bdd_delref(root); }
 
    int id(void) const;
    
-   bdd operator=(const bdd &r);
+   bdd &operator=(const bdd &r);
+   bdd &operator=(bdd &&r) noexcept;
    
    bdd operator&(const bdd &r) const;
-   bdd operator&=(const bdd &r);
+   bdd &operator&=(const bdd &r);
    bdd operator^(const bdd &r) const;
-   bdd operator^=(const bdd &r);
+   bdd &operator^=(const bdd &r);
    bdd operator|(const bdd &r) const;
-   bdd operator|=(const bdd &r);
+   bdd &operator|=(const bdd &r);
    bdd operator!(void) const;
    bdd operator>>(const bdd &r) const;
-   bdd operator>>=(const bdd &r);
+   bdd &operator>>=(const bdd &r);
    bdd operator-(const bdd &r) const;
-   bdd operator-=(const bdd &r);
+   bdd &operator-=(const bdd &r);
    bdd operator>(const bdd &r) const;
    bdd operator<(const bdd &r) const;
    bdd operator<<(const bdd &r) const;
-   bdd operator<<=(const bdd &r);
+   bdd &operator<<=(const bdd &r);
    int operator==(const bdd &r) const;
    int operator!=(const bdd &r) const;
    
@@ -456,7 +522,7 @@ private:
    BDD root;
 
    bdd(BDD r) { bdd_addref(root=r); }
-   bdd operator=(BDD r);
+   bdd &operator=(BDD r);
 
    friend int      bdd_init(int, int);
    friend int      bdd_setvarnum(int);
@@ -532,6 +598,7 @@ private:
    friend int    fdd_scanset(const bdd &, int *&, int &);
 
    friend int    bdd_addvarblock(const bdd &, int);
+   friend int    bdd_addinteraction(const bdd &);
 
    friend class bvec;
    friend bvec bvec_ite(const bdd& a, const bvec& b, const bvec& c);
@@ -558,8 +625,6 @@ extern const bdd bddtruepp;
 
 /*=== C++ interface ====================================================*/
 
-extern int bdd_cpp_init(int, int);
-
 inline void bdd_stats(bddStat& s)
 { bdd_stats(&s); }
 
@@ -727,8 +792,10 @@ inline int bdd_load(FILE *ifile, bdd &r)
 inline int bdd_addvarblock(const bdd &v, int f)
 { return bdd_addvarblock(v.root, f); }
 
+inline int bdd_addinteraction(const bdd &v)
+{ return bdd_addinteraction(v.root); }
+
    /* Hack to allow for overloading */
-//#define bdd_init bdd_cpp_init
 #define bdd_ithvar bdd_ithvarpp
 #define bdd_nithvar bdd_nithvarpp
 #define bdd_makeset bdd_makesetpp
@@ -740,22 +807,37 @@ inline int bdd_addvarblock(const bdd &v, int f)
 inline int bdd::id(void) const
 { return root; }
 
+   /* Takes over the reference of 'r', which saves an addref here and
+      the delref in the destructor of 'r' */
+inline bdd &bdd::operator=(bdd &&r) noexcept
+{
+   if (this != &r)
+   {
+      if (root > 1)
+         bdd_delref(root);
+      root = r.root;
+      r.root = 0;
+      bdd_countsaved(2);
+   }
+   return *this;
+}
+
 inline bdd bdd::operator&(const bdd &r) const
 { return bdd_apply(*this,r,bddop_and); }
 
-inline bdd bdd::operator&=(const bdd &r)
+inline bdd &bdd::operator&=(const bdd &r)
 { return (*this=bdd_apply(*this,r,bddop_and)); }
 
 inline bdd bdd::operator^(const bdd &r) const
 { return bdd_apply(*this,r,bddop_xor); }
 
-inline bdd bdd::operator^=(const bdd &r)
+inline bdd &bdd::operator^=(const bdd &r)
 { return (*this=bdd_apply(*this,r,bddop_xor)); }
 
 inline bdd bdd::operator|(const bdd &r) const
 { return bdd_apply(*this,r,bddop_or); }
 
-inline bdd bdd::operator|=(const bdd &r)
+inline bdd &bdd::operator|=(const bdd &r)
 { return (*this=bdd_apply(*this,r,bddop_or)); }
 
 inline bdd bdd::operator!(void) const
@@ -764,13 +846,13 @@ inline bdd bdd::operator!(void) const
 inline bdd bdd::operator>>(const bdd &r) const
 { return bdd_apply(*this,r,bddop_imp); }
 
-inline bdd bdd::operator>>=(const bdd &r)
+inline bdd &bdd::operator>>=(const bdd &r)
 { return (*this=bdd_apply(*this,r,bddop_imp)); }
 
 inline bdd bdd::operator-(const bdd &r) const
 { return bdd_apply(*this,r,bddop_diff); }
 
-inline bdd bdd::operator-=(const bdd &r)
+inline bdd &bdd::operator-=(const bdd &r)
 { return (*this=bdd_apply(*this,r,bddop_diff)); }
 
 inline bdd bdd::operator>(const bdd &r) const
@@ -782,7 +864,7 @@ inline bdd bdd::operator<(const bdd &r) const
 inline bdd bdd::operator<<(const bdd &r) const
 { return bdd_apply(*this,r,bddop_invimp); }
 
-inline bdd bdd::operator<<=(const bdd &r)
+inline bdd &bdd::operator<<=(const bdd &r)
 { return (*this=bdd_apply(*this,r,bddop_invimp)); }
 
 inline int bdd::operator==(const bdd &r) const
@@ -820,7 +902,6 @@ extern bdd_ioformat bddset;
 extern bdd_ioformat bddtable;
 extern bdd_ioformat bdddot;
 extern bdd_ioformat bddall;
-extern bdd_ioformat fddset;
 
 typedef void (*bddstrmhandler)(std::ostream &, int);
 
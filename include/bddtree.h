@@ -53,6 +53,7 @@ BddTree *bddtree_new(int);
 void     bddtree_del(BddTree *);
 BddTree *bddtree_addrange(BddTree *, int, int, int, int);
 void     bddtree_print(FILE *, BddTree *, int);
+int      bddtree_updateseq(BddTree *);
 
 #endif /* _TREE_H */
 
@@ -38,21 +38,29 @@
 #ifndef _CACHE_H
 #define _CACHE_H
 
-typedef struct
+#include <string.h>
+
+   /* Entries per set. A set of four 16 byte entries fills one 64 byte
+      cache line, so a lookup touches a single line */
+#define BDDCACHE_WAYS 4
+
+typedef struct alignas(16) s_BddCacheData
 {
+   int a,c;
    union
    {
-      double dres;
-      int res;
-   } r;
-   int a,b,c;
+      struct { int b; int res; };   /* Binary keys and BDD results */
+      double dres;                   /* Counting results, unary keys only */
+   };
 } BddCacheData;
 
 
 typedef struct
 {
    BddCacheData *table;
-   int tablesize;
+   unsigned char *locks;  /* One try-lock per set, for concurrent mode */
+   int tablesize;         /* Number of entries, a power of two */
+   int shift;             /* 32 - log2(number of sets) */
 } BddCache;
 
 
@@ -60,8 +68,123 @@ extern int  BddCache_init(BddCache *, int);
 extern void BddCache_done(BddCache *);
 extern int  BddCache_resize(BddCache *, int);
 extern void BddCache_reset(BddCache *);
+extern BddCacheData *BddCache_lookupmt(BddCache *, unsigned int, int, int, int);
+extern void BddCache_storemt(BddCache *, unsigned int, const BddCacheData *);
+
+
+   /* First entry of the set for 'hash'. The multiplicative hash spreads
+      the poorly mixed low bits of PAIR/TRIPLE over the index bits */
+static inline BddCacheData *BddCache_set(BddCache *cache, unsigned int hash)
+{
+   return &cache->table[((hash * 0x9E3779B1u) >> cache->shift) * BDDCACHE_WAYS];
+}
+
+
+   /* A hit moves to the front of its set, so the ways are ordered by
+      their last hit */
+static inline BddCacheData *BddCache_hit(BddCacheData *set, int way)
+{
+   if (way > 0)
+   {
+      BddCacheData tmp = set[way];
+      memmove(set+1, set, sizeof(BddCacheData)*way);
+      set[0] = tmp;
+   }
+
+   bddopstat->hit++;
+   return set;
+}
+
+
+   /* Returns the entry holding the key (a,b,c) or NULL */
+static inline BddCacheData *BddCache_lookup(BddCache *cache, unsigned int hash,
+                                            int a, int b, int c)
+{
+   BddCacheData *set = BddCache_set(cache, hash);
+
+   for (int n=0 ; n<BDDCACHE_WAYS ; n++)
+      if (set[n].a == a  &&  set[n].b == b  &&  set[n].c == c)
+         return BddCache_hit(set, n);
+
+   bddopstat->miss++;
+   return NULL;
+}
+
+
+   /* Same for unary keys (a,c), whose entries may hold a double */
+static inline BddCacheData *BddCache_lookup1(BddCache *cache, unsigned int hash,
+                                             int a, int c)
+{
+   BddCacheData *set = BddCache_set(cache, hash);
 
-#define BddCache_lookup(cache, hash) (&(cache)->table[hash % (cache)->tablesize])
+   for (int n=0 ; n<BDDCACHE_WAYS ; n++)
+      if (set[n].a == a  &&  set[n].c == c)
+         return BddCache_hit(set, n);
+
+   bddopstat->miss++;
+   return NULL;
+}
+
+
+   /* New results replace the last way and reach the front only when
+      they are hit again. Most results of a build are never asked for
+      twice, and this keeps them from flushing the ones that are.
+      Results are inserted once they are known rather than at lookup
+      time, since the recursion in between may reorder the set */
+static inline void BddCache_store(BddCache *cache, unsigned int hash,
+                                  const BddCacheData *data)
+{
+   BddCacheData *entry = BddCache_set(cache, hash) + BDDCACHE_WAYS-1;
+
+   if (entry->a != -1)
+      bddopstat->evict++;
+
+   *entry = *data;
+}
+
+
+static inline void BddCache_insert(BddCache *cache, unsigned int hash,
+                                   int a, int b, int c, int res)
+{
+   BddCacheData data;
+   data.a = a;
+   data.b = b;
+   data.c = c;
+   data.res = res;
+   BddCache_store(cache, hash, &data);
+}
+
+
+static inline void BddCache_insert1(BddCache *cache, unsigned int hash,
+                                    int a, int c, int res)
+{
+   BddCache_insert(cache, hash, a, 0, c, res);
+}
+
+
+static inline void BddCache_insertd(BddCache *cache, unsigned int hash,
+                                    int a, int c, double dres)
+{
+   BddCacheData data;
+   data.a = a;
+   data.c = c;
+   data.dres = dres;
+   BddCache_store(cache, hash, &data);
+}
+
+
+   /* Binary inserts for operators running in concurrent mode, whose
+      lookups go through BddCache_lookupmt */
+static inline void BddCache_insertmt(BddCache *cache, unsigned int hash,
+                                     int a, int b, int c, int res)
+{
+   BddCacheData data;
+   data.a = a;
+   data.b = b;
+   data.c = c;
+   data.res = res;
+   BddCache_storemt(cache, hash, &data);
+}
 
 
 #endif /* _CACHE_H */
@@ -33,6 +33,7 @@
   DESCR: Kernel specific definitions for BDD package
   AUTH:  Jorn Lind
   DATE:  (C) june 1997
+  NOTE:  Modified for the in-tree C++ engine (src/bdd).
 *************************************************************************/
 
 #ifndef _KERNEL_H
@@ -41,9 +42,17 @@
 /*=== Includes =========================================================*/
 
 #include <limits.h>
-#include <setjmp.h>
+#include <shared_mutex>
 #include "bdd.h"
 
+   /* The kernel is compiled as C++, so the C entry points must not be
+      renamed to their C++ overloads by the hacks at the end of bdd.h */
+#undef bdd_ithvar
+#undef bdd_nithvar
+#undef bdd_makeset
+#undef bdd_ibuildcube
+#undef bdd_anodecount
+
 /*=== SANITY CHECKS ====================================================*/
 
    /* Make sure we use at least 32 bit integers */
@@ -55,38 +64,68 @@
    /* Sanity check argument and return eventual error code */
 #define CHECK(r)\
    if (!bddrunning) return bdd_error(BDD_RUNNING);\
-   else if ((r) < 0  ||  (r) >= bddnodesize) return bdd_error(BDD_ILLBDD);\
-   else if (r >= 2 && LOW(r) == -1) return bdd_error(BDD_ILLBDD)\
+   else if ((r) < 0  ||  NODE(r) >= bddnodesize) return bdd_error(BDD_ILLBDD);\
+   else if (r >= 2 && ISFREE(r)) return bdd_error(BDD_ILLBDD)\
 
    /* Sanity check argument and return eventually the argument 'a' */
 #define CHECKa(r,a)\
    if (!bddrunning) { bdd_error(BDD_RUNNING); return (a); }\
-   else if ((r) < 0  ||  (r) >= bddnodesize)\
+   else if ((r) < 0  ||  NODE(r) >= bddnodesize)\
      { bdd_error(BDD_ILLBDD); return (a); }\
-   else if (r >= 2 && LOW(r) == -1)\
+   else if (r >= 2 && ISFREE(r))\
      { bdd_error(BDD_ILLBDD); return (a); }
 
 #define CHECKn(r)\
    if (!bddrunning) { bdd_error(BDD_RUNNING); return; }\
-   else if ((r) < 0  ||  (r) >= bddnodesize)\
+   else if ((r) < 0  ||  NODE(r) >= bddnodesize)\
      { bdd_error(BDD_ILLBDD); return; }\
-   else if (r >= 2 && LOW(r) == -1)\
+   else if (r >= 2 && ISFREE(r))\
      { bdd_error(BDD_ILLBDD); return; }
 
 
 /*=== SEMI-INTERNAL TYPES ==============================================*/
 
-typedef struct s_BddNode /* Node table entry */
+   /* The part of a node that traversals read. Level and children share
+      one 16 byte slot so a node never straddles a cache line, while the
+      unique table chains live in separate arrays owned by kernel.cpp */
+typedef struct alignas(16) s_BddNode /* Node table entry */
 {
-   unsigned int refcou : 10;
-   unsigned int level  : 22;
+   unsigned int level;   /* Variable level, MARKON is used while marking */
    int low;
    int high;
-   int hash;
-   int next;
+   unsigned int refcou;  /* External references, saturates at MAXREF */
 } BddNode;
 
 
+   /* Per thread state. Statistics are counted here and summed on demand
+      so no counter is shared between threads. In concurrent mode new
+      nodes come from a private chunk of the free list, and the last
+      result handed out is kept alive by the garbage collector until the
+      thread has had the chance to reference it */
+typedef struct s_BddThread
+{
+   bddCacheStat stats;
+   long produced;         /* Number of new nodes produced by this thread */
+   long unsigned int refcalls;  /* Calls to bdd_addref and bdd_delref */
+   long unsigned int refsaved;  /* Saved calls folded in at thread exit */
+   std::atomic<long unsigned int> *refsavedtls; /* bddrefsaved of thread */
+   int *refstack;         /* Reference stack owned by this thread */
+   int refstacksize;
+   int freepos;           /* Private chunk of free nodes */
+   int freenum;
+   BDD lastres;           /* Last result returned in concurrent mode */
+   struct s_BddThread *next;
+} BddThread;
+
+
+   /* Thrown by bdd_makenode in concurrent mode when the free list is
+      empty. The operator is then restarted after a garbage collection */
+typedef struct s_BddNodesExhausted
+{
+   int gbcnum;            /* Number of collections seen by the thrower */
+} BddNodesExhausted;
+
+
 /*=== KERNEL VARIABLES =================================================*/
 
 #ifdef CPLUSPLUS
@@ -100,14 +139,24 @@ extern int       bddmaxnodesize;     /* Maximum allowed number of nodes */
 extern int       bddmaxnodeincrease; /* Max. # of nodes used to inc. table */
 extern BddNode*  bddnodes;           /* All of the bdd nodes */
 extern int       bddvarnum;          /* Number of defined BDD variables */
-extern int*      bddrefstack;        /* Internal node reference stack */
-extern int*      bddrefstacktop;     /* Internal node reference stack top */
 extern int*      bddvar2level;
 extern int*      bddlevel2var;
-extern jmp_buf   bddexception;
-extern int       bddreorderdisabled;
 extern int       bddresized;
-extern bddCacheStat bddcachestats;
+extern int*      bddhash;            /* Unique table chains, see kernel.cpp */
+extern int*      bddnext;
+extern int       bddfreepos;         /* Free list, linked through bddnext */
+extern int       bddfreenum;
+extern int       bddconcurrent;      /* Flag - concurrent apply enabled */
+extern int       bddgeneration;      /* Bumped when refstacks must regrow */
+extern std::shared_mutex bddkernellock; /* Shared by apply, exclusive else */
+extern std::atomic<int> bddreorderpending; /* Reorder after the operator */
+
+extern thread_local constinit int*  bddrefstack;    /* Node reference stack */
+extern thread_local constinit int*  bddrefstacktop; /* - and its top */
+extern thread_local constinit int   bddrefstackgen; /* Generation of stack */
+extern thread_local constinit int   bddinexclusive; /* Holds kernel lock */
+extern thread_local constinit BddThread* bddthread; /* Context of thread */
+extern thread_local constinit bddOpCacheStat* bddopstat; /* Charged counters */
 
 #ifdef CPLUSPLUS
 }
@@ -117,9 +166,9 @@ extern bddCacheStat bddcachestats;
 /*=== KERNEL DEFINITIONS ===============================================*/
 
 #define MAXVAR 0x1FFFFF
-#define MAXREF 0x3FF
+#define MAXREF 0x7FFFFFFF
 
-   /* Reference counting */
+   /* Reference counting, by node index */
 #define DECREF(n) if (bddnodes[n].refcou!=MAXREF && bddnodes[n].refcou>0) bddnodes[n].refcou--
 #define INCREF(n) if (bddnodes[n].refcou<MAXREF) bddnodes[n].refcou++
 #define DECREFp(n) if (n->refcou!=MAXREF && n->refcou>0) n->refcou--
@@ -130,9 +179,9 @@ extern bddCacheStat bddcachestats;
 #define MARKON   0x200000    /* Bit used to mark a node (1) */
 #define MARKOFF  0x1FFFFF    /* - unmark */
 #define MARKHIDE 0x1FFFFF
-#define SETMARK(n)  (bddnodes[n].level |= MARKON)
-#define UNMARK(n)   (bddnodes[n].level &= MARKOFF)
-#define MARKED(n)   (bddnodes[n].level & MARKON)
+#define SETMARK(e)  (bddnodes[NODE(e)].level |= MARKON)
+#define UNMARK(e)   (bddnodes[NODE(e)].level &= MARKOFF)
+#define MARKED(e)   (bddnodes[NODE(e)].level & MARKON)
 #define SETMARKp(p) (node->level |= MARKON)
 #define UNMARKp(p)  (node->level &= MARKOFF)
 #define MARKEDp(p)  (node->level & MARKON)
@@ -143,20 +192,37 @@ extern bddCacheStat bddcachestats;
 #define TRIPLE(a,b,c)  ((unsigned int)(PAIR((unsigned int)c,PAIR(a,b))))
 
 
-   /* Inspection of BDD nodes */
+   /* Complement edges. A BDD is an edge: the node index shifted left
+      once, with bit 0 telling whether the function is negated. Node 0
+      is the single terminal, so edge 0 is false and edge 1 is true.
+      The high edge stored in a node is never complemented, which keeps
+      the representation canonical (see bdd_makenode) */
+#define NODE(e)     ((e) >> 1)
+#define EDGE(n)     ((n) << 1)
+#define ISCOMPL(e)  ((e) & 1)
+#define REGULAR(e)  ((e) & ~1)
+#define NOT(e)      ((e) ^ 1)
+
+   /* Inspection of BDD nodes. LOW and HIGH take an edge and return the
+      cofactors of the function it denotes, complement included, while
+      the p-variants read the raw children of a node record */
 #define ISCONST(a) ((a) < 2)
 #define ISNONCONST(a) ((a) >= 2)
 #define ISONE(a)   ((a) == 1)
 #define ISZERO(a)  ((a) == 0)
-#define LEVEL(a)   (bddnodes[a].level)
-#define LOW(a)     (bddnodes[a].low)
-#define HIGH(a)    (bddnodes[a].high)
+#define ISFREE(a)  (bddnodes[NODE(a)].low == -1)
+#define LEVEL(a)   (bddnodes[NODE(a)].level)
+#define LOW(a)     (bddnodes[NODE(a)].low ^ ISCOMPL(a))
+#define HIGH(a)    (bddnodes[NODE(a)].high ^ ISCOMPL(a))
 #define LEVELp(p)   ((p)->level)
 #define LOWp(p)     ((p)->low)
 #define HIGHp(p)    ((p)->high)
 
-   /* Stacking for garbage collector */
-#define INITREF    bddrefstacktop = bddrefstack
+   /* Stacking for garbage collector. Every thread has its own stack,
+      which is (re)allocated by the first operator after bdd_init or
+      bdd_setvarnum */
+#define INITREF    (bddrefstackgen != bddgeneration ? (void)bdd_threadinit() : (void)0,\
+                    bddrefstacktop = bddrefstack)
 #define PUSHREF(a) *(bddrefstacktop++) = (a)
 #define READREF(a) *(bddrefstacktop-(a))
 #define POPREF(a)  bddrefstacktop -= (a)
@@ -175,6 +241,12 @@ extern bddCacheStat bddcachestats;
 
 #define DEFAULTMAXNODEINC 50000
 
+   /* Context of the calling thread, created on first use */
+#define BDDTHREAD (bddthread != NULL ? bddthread : bdd_threadinit())
+
+   /* Selects the counters charged by the operator caches */
+#define SETOPSTAT(n) (bddopstat = &BDDTHREAD->stats.op[n])
+
 #define MIN(a,b) ((a) < (b) ? (a) : (b))
 #define MAX(a,b) ((a) > (b) ? (a) : (b))
 #define NEW(t,n) ( (t*)malloc(sizeof(t)*(n)) )
@@ -188,42 +260,87 @@ extern "C" {
 
 extern int    bdd_error(int);
 extern int    bdd_makenode(unsigned int, int, int);
+extern int    bdd_makenode_concurrent(unsigned int, int, int);
 extern int    bdd_noderesize(int);
-extern void   bdd_checkreorder(void);
 extern void   bdd_mark(int);
 extern void   bdd_mark_upto(int, int);
 extern void   bdd_markcount(int, int*);
 extern void   bdd_unmark(int);
 extern void   bdd_unmark_upto(int, int);
 extern void   bdd_register_pair(bddPair*);
-extern int   *fdddec2bin(int, int);
 
 extern int    bdd_operator_init(int);
 extern void   bdd_operator_done(void);
 extern void   bdd_operator_varresize(void);
 extern void   bdd_operator_reset(void);
+extern void   bdd_operator_noderesize(void);
 
 extern void   bdd_pairs_init(void);
 extern void   bdd_pairs_done(void);
 extern int    bdd_pairs_resize(int,int);
 extern void   bdd_pairs_vardown(int);
 
-extern void   bdd_fdd_init(void);
-extern void   bdd_fdd_done(void);
+extern BddThread* bdd_threadinit(void);
+extern int    bdd_gbc_concurrent(int);
+extern void   bdd_unique_rehash(void);
+extern void   bdd_forlastres(void (*)(int));
 
 extern void   bdd_reorder_init(void);
 extern void   bdd_reorder_done(void);
 extern int    bdd_reorder_ready(void);
 extern void   bdd_reorder_auto(void);
-extern int    bdd_reorder_vardown(int);
-extern int    bdd_reorder_varup(int);
 
-extern void   bdd_cpp_init(void);
+extern void   bdd_fdd_init(void);
+extern void   bdd_fdd_done(void);
 
 #ifdef CPLUSPLUS
 }
 #endif
 
+
+/*=== CONCURRENCY ======================================================*/
+
+   /* In concurrent mode apply, ite and the reference counting run under
+      a shared lock on the kernel. Every other operator holds the lock
+      exclusively for its whole run and then behaves as in sequential
+      mode, including operators it calls itself */
+class BddExclusive
+{
+ public:
+   BddExclusive(void) : locked(bddconcurrent && !bddinexclusive)
+   {
+      if (locked)
+      {
+         bddkernellock.lock();
+         bddinexclusive = 1;
+      }
+   }
+
+   ~BddExclusive(void)
+   {
+      if (locked)
+      {
+         bddinexclusive = 0;
+         bddkernellock.unlock();
+      }
+   }
+
+ private:
+   int locked;
+};
+
+#define BDD_EXCLUSIVE BddExclusive bddexclusive_
+
+
+   /* Protects a result from garbage collection until the caller has had
+      the chance to reference it (see BddThread) */
+static inline BDD bdd_keepres(BDD r)
+{
+   if (bddconcurrent)
+      BDDTHREAD->lastres = r;
+   return r;
+}
+
 #endif /* _KERNEL_H */
 
 
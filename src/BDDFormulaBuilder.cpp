@@ -1,21 +1,425 @@
 #include "BDDFormulaBuilder.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <execution>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <ranges>
+#include <utility>
+#include "BDDMetrics.hpp"
 
-BDDFormulaBuilder::BDDFormulaBuilder() :
+namespace
+{
+  // Runs conjunction and records how long it took, see
+  // bddMetrics::recordConjunction.
+  template < class F > bdd timed(F conjunction)
+  {
+    auto start = std::chrono::steady_clock::now();
+    bdd res = conjunction();
+    bddMetrics::recordConjunction(std::chrono::steady_clock::now() - start);
+    return res;
+  }
+
+  // Variables formula depends on, in increasing order.
+  std::vector< int > supportVars(const bdd &formula)
+  {
+    int *vars = nullptr;
+    int nVars = 0;
+    if (bdd_scanset(bdd_support(formula), vars, nVars) < 0 || !vars)
+      return {};
+    std::vector< int > res(vars, vars + nVars);
+    free(vars);
+    std::ranges::sort(res);
+    return res;
+  }
+}
+
+BDDFormulaBuilder::BDDFormulaBuilder(Mode mode, int batch) :
+  mode_(mode),
+  batch_(batch > 0 ? batch : std::numeric_limits< int >::max()),
+  measureLargest_(mode == Mode::BALANCED || mode == Mode::SCHEDULED),
   formula_(bdd_true())
 {}
 
 void BDDFormulaBuilder::addCondition(bdd formula)
 {
-  formula_ &= formula;
+  mergePartials();
+  if (mode_ == Mode::COLLECT)
+  {
+    conditions_.push_back(std::move(formula));
+    return;
+  }
+  // Sifting then only moves a variable past those it shares a condition
+  // with.
+  bdd_addinteraction(bdd_support(formula));
+  if (mode_ == Mode::SCHEDULED)
+  {
+    conditions_.push_back(std::move(formula));
+    return;
+  }
+  if (mode_ == Mode::BALANCED)
+  {
+    conditions_.push_back(std::move(formula));
+    if (static_cast< int >(conditions_.size()) >= batch_)
+      conjoinPending();
+    return;
+  }
+  if (!keep_.empty())
+  {
+    // The last condition mentioning a variable is only known in result().
+    conditions_.push_back(std::move(formula));
+    return;
+  }
+  conjoin(formula, bdd_true());
+}
+
+void BDDFormulaBuilder::addConditionPartial(bdd formula)
+{
+  auto &partial = partials_.local();
+  // Starting from the result keeps the partial result as restricted as
+  // the result would be, which the conditions of UNIQUE need.
+  if (mode_ == Mode::CONJOIN && keep_.empty())
+  {
+    if (!partial.seeded)
+    {
+      partial.formula = formula_;
+      partial.seeded = true;
+    }
+    partial.formula = timed([&partial, &formula] { return partial.formula & formula; });
+  }
+  partial.conditions.push_back(std::move(formula));
 }
 
-void BDDFormulaBuilder::addConditionTh(bdd formula)
+// One lock guarding formula_ made the threads take turns on the one
+// large formula. The partial results are as large as the result, but
+// independent, and each level of the tree halves their number.
+void BDDFormulaBuilder::mergePartials()
 {
-  std::unique_lock lock(mut_);
-  formula_ &= formula;
+  if (partials_.empty())
+    return;
+  std::vector< bdd > formulas;
+  std::vector< bdd > conditions;
+  for (auto &partial : partials_)
+  {
+    if (partial.seeded)
+      formulas.push_back(std::move(partial.formula));
+    std::ranges::move(partial.conditions, std::back_inserter(conditions));
+  }
+  partials_.clear();
+  if (formulas.empty())
+  {
+    for (auto &condition : conditions)
+      addCondition(std::move(condition));
+    return;
+  }
+  for (const auto &condition : conditions)
+    bdd_addinteraction(bdd_support(condition));
+  if (measureLargest_)
+    for (const auto &formula : formulas)
+      largestNodes_ = std::max(largestNodes_, bdd_nodecount(formula));
+  while (formulas.size() > 1)
+  {
+    std::vector< bdd > merged((formulas.size() + 1) / 2);
+    auto pairs = std::views::iota(size_t{0}, formulas.size() / 2);
+    auto merge = [&formulas, &merged](auto pair) {
+      merged[pair] = timed([&formulas, pair] { return formulas[2 * pair] & formulas[2 * pair + 1]; });
+    };
+    // Only a concurrent kernel takes apply calls from several threads.
+    if (bdd_isconcurrent())
+      std::for_each(std::execution::par, pairs.begin(), pairs.end(), merge);
+    else
+      std::for_each(pairs.begin(), pairs.end(), merge);
+    if (formulas.size() % 2)
+      merged.back() = std::move(formulas.back());
+    formulas = std::move(merged);
+    if (measureLargest_)
+      for (const auto &formula : formulas)
+        largestNodes_ = std::max(largestNodes_, bdd_nodecount(formula));
+  }
+  formula_ = std::move(formulas.front());
 }
 
 bdd BDDFormulaBuilder::result()
 {
+  mergePartials();
+  if (mode_ == Mode::BALANCED)
+    conjoinPending();
+  else if (mode_ == Mode::SCHEDULED)
+    conjoinScheduled();
+  else if (!conditions_.empty())
+  {
+    std::vector< int > order(conditions_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::vector< std::vector< int > > supports;
+    for (const auto &condition : conditions_)
+      supports.push_back(supportVars(condition));
+    auto quantify = quantifySets(order, supports);
+    for (auto pos : std::views::iota(size_t{0}, order.size()))
+      conjoin(conditions_[order[pos]], quantify[pos]);
+    conditions_.clear();
+  }
+  if (!keep_.empty())
+  {
+    // Left for the end: variables of the result no condition mentions,
+    // and in BALANCED mode all of them.
+    auto rest = bdd_true();
+    for (auto var : supportVars(formula_))
+      if (!keep_[var])
+        rest &= bdd_ithvar(var);
+    if (rest != bdd_true())
+      formula_ = bdd_exist(formula_, rest);
+  }
   return formula_;
 }
+
+const std::vector< bdd > &BDDFormulaBuilder::conditions() const
+{
+  return conditions_;
+}
+
+void BDDFormulaBuilder::project(bdd keep)
+{
+  keep_.assign(bdd_varnum(), false);
+  for (auto var : supportVars(keep))
+    keep_[var] = true;
+}
+
+void BDDFormulaBuilder::measureLargest()
+{
+  measureLargest_ = true;
+}
+
+int BDDFormulaBuilder::largestNodes() const
+{
+  return largestNodes_;
+}
+
+const std::vector< BDDFormulaBuilder::Step > &BDDFormulaBuilder::schedule() const
+{
+  return schedule_;
+}
+
+void BDDFormulaBuilder::printSchedule(std::ostream &out) const
+{
+  out << "{\"schedule\": [";
+  for (size_t i = 0; i < schedule_.size(); ++i)
+  {
+    const auto &step = schedule_[i];
+    out << (i ? ", " : "") << "{\"conditions\": [";
+    for (size_t j = 0; j < step.conditions.size(); ++j)
+      out << (j ? ", " : "") << step.conditions[j];
+    out << "], \"support\": " << step.supportSize
+        << ", \"new_vars\": " << step.newVars
+        << ", \"quantified\": " << step.quantified
+        << ", \"restriction\": " << step.restriction
+        << ", \"nodes\": " << step.nodes << '}';
+  }
+  out << "]}\n";
+}
+
+// Conjoining the conditions in the order they come makes every step
+// work on the whole formula built so far. Taking the two smallest
+// formulas each time, as in a Huffman tree, keeps the operands small
+// until the last steps of a batch, and the result takes part as one more
+// formula. Small conditions are not always the restrictive ones though:
+// those of UNIQUE are, without the SECOND ones that pin the values, large
+// together, so the batches bound how far the tree can run ahead of them.
+void BDDFormulaBuilder::conjoinPending()
+{
+  if (conditions_.empty())
+    return;
+  // A min-heap on node counts.
+  using Sized = std::pair< int, bdd >;
+  auto larger = [](const Sized &l, const Sized &r) { return l.first > r.first; };
+  std::vector< Sized > heap;
+  heap.reserve(conditions_.size() + 1);
+  heap.emplace_back(bdd_nodecount(formula_), std::move(formula_));
+  for (auto &condition : conditions_)
+  {
+    int nodes = bdd_nodecount(condition);
+    heap.emplace_back(nodes, std::move(condition));
+  }
+  conditions_.clear();
+  std::ranges::make_heap(heap, larger);
+  while (heap.size() > 1)
+  {
+    std::ranges::pop_heap(heap, larger);
+    auto smallest = std::move(heap.back().second);
+    heap.pop_back();
+    std::ranges::pop_heap(heap, larger);
+    auto conjunction = timed([&smallest, &heap] { return smallest & heap.back().second; });
+    heap.pop_back();
+    if (conjunction == bdd_false())
+    {
+      formula_ = conjunction;
+      return;
+    }
+    int nodes = bdd_nodecount(conjunction);
+    largestNodes_ = std::max(largestNodes_, nodes);
+    heap.emplace_back(nodes, std::move(conjunction));
+    std::ranges::push_heap(heap, larger);
+  }
+  formula_ = std::move(heap.front().second);
+}
+
+// The order the conditions come in follows the condition types, not the
+// variables they touch. Here conditions are first clustered: one whose
+// support lies within the support of another, at most twice as large,
+// is conjoined with it (an upper bound or a fixed value with a pair of
+// UNIQUE, the neighbour rules with a SECOND one over the same property).
+// The limit keeps clusters on the same objects or properties, where
+// their conjunction stays small.
+//
+// The clusters then go into the result greedily. One over variables the
+// result already has can only narrow it and goes first; this also
+// finishes the conditions on a property before the next one comes in,
+// so with a projection its variables leave early. Otherwise the cluster
+// goes by what it does to the number of satisfying assignments of the
+// result: the bits its conditions rule out (-log2 of the share of
+// assignments satisfying each, summed as if they were independent) less
+// one per variable new to the result, plus one per variable it is the
+// last to mention outside the projection. Ties go to the cluster sharing
+// the most variables with the result, and in a cluster the most
+// restrictive conditions go first.
+// Going by the supports alone would follow the variables and build the
+// all-different constraints of UNIQUE before the SECOND conditions that
+// pin their values, which is exponential, as is a cluster of SECOND
+// conditions before the FIRST ones in the property-major order.
+void BDDFormulaBuilder::conjoinScheduled()
+{
+  if (conditions_.empty())
+    return;
+  int nConditions = static_cast< int >(conditions_.size());
+  std::vector< std::vector< int > > supports;
+  for (const auto &condition : conditions_)
+    supports.push_back(supportVars(condition));
+
+  struct Cluster
+  {
+    std::vector< int > conditions;
+    std::vector< int > support;
+    double restriction;
+  };
+  std::vector< Cluster > clusters;
+  std::vector< int > bySize(nConditions);
+  std::iota(bySize.begin(), bySize.end(), 0);
+  std::ranges::stable_sort(bySize, std::greater{}, [&supports](int i) { return supports[i].size(); });
+  for (auto i : bySize)
+  {
+    Cluster *home = nullptr;
+    for (auto &cluster : clusters)
+      if (cluster.support.size() <= 2 * supports[i].size() && std::ranges::includes(cluster.support, supports[i]) &&
+          (!home || cluster.support.size() < home->support.size()))
+        home = &cluster;
+    if (home)
+      home->conditions.push_back(i);
+    else
+      clusters.push_back({{i}, supports[i], 0});
+  }
+  // Summing over the conditions takes them as independent, but needs no
+  // conjunction of a cluster on its own, which can be far larger than
+  // with the result it goes into.
+  std::vector< double > bits;
+  for (const auto &condition : conditions_)
+    bits.push_back(bdd_varnum() - bdd_satcountln(condition));
+  for (auto &cluster : clusters)
+  {
+    std::ranges::stable_sort(cluster.conditions, std::greater{}, [&bits](int i) { return bits[i]; });
+    for (auto i : cluster.conditions)
+      cluster.restriction += bits[i];
+  }
+
+  std::vector< bool > inResult(bdd_varnum());
+  for (auto v : supportVars(formula_))
+    inResult[v] = true;
+  // Clusters left that mention a variable.
+  std::vector< int > mentions(bdd_varnum());
+  for (const auto &cluster : clusters)
+    for (auto v : cluster.support)
+      ++mentions[v];
+  std::vector< int > order;
+  auto firstStep = schedule_.size();
+  while (!clusters.empty())
+  {
+    auto newVars = [&inResult](const Cluster &c) {
+      return std::ranges::count_if(c.support, [&inResult](int v) { return !inResult[v]; });
+    };
+    // Bits the cluster takes off the satisfying assignments of the result,
+    // less those its new variables add.
+    // With a projection, the variables only the cluster still mentions
+    // leave the result after it.
+    auto closed = [this, &mentions](const Cluster &c) {
+      return keep_.empty() ? 0 : std::ranges::count_if(c.support, [this, &mentions](int v) {
+        return mentions[v] == 1 && !keep_[v];
+      });
+    };
+    auto gain = [&newVars, &closed](const Cluster &c) {
+      return c.restriction - static_cast< double >(newVars(c)) + static_cast< double >(closed(c));
+    };
+    auto next = std::ranges::max_element(clusters, [&gain, &newVars](const Cluster &l, const Cluster &r) {
+      if ((newVars(l) == 0) != (newVars(r) == 0))
+        return newVars(l) != 0;
+      auto lGain = gain(l);
+      auto rGain = gain(r);
+      if (lGain != rGain)
+        return lGain < rGain;
+      return l.support.size() - newVars(l) < r.support.size() - newVars(r);
+    });
+    for (auto i : next->conditions)
+      order.push_back(i);
+    schedule_.push_back({std::move(next->conditions), static_cast< int >(next->support.size()),
+                         static_cast< int >(newVars(*next)), 0, next->restriction, 0});
+    for (auto v : next->support)
+    {
+      inResult[v] = true;
+      --mentions[v];
+    }
+    clusters.erase(next);
+  }
+
+  // The order only depends on the supports, so the variables each
+  // condition is the last to mention are known before conjoining.
+  auto quantify = quantifySets(order, supports);
+  size_t pos = 0;
+  for (auto &step : schedule_ | std::views::drop(firstStep))
+  {
+    for (size_t n = 0; n < step.conditions.size(); ++n)
+    {
+      step.quantified += static_cast< int >(supportVars(quantify[pos]).size());
+      conjoin(conditions_[order[pos]], quantify[pos]);
+      ++pos;
+    }
+    step.nodes = bdd_nodecount(formula_);
+  }
+  conditions_.clear();
+}
+
+// Per position in order, the variables outside the projection that the
+// condition there is the last to mention, bdd_true() for none.
+std::vector< bdd > BDDFormulaBuilder::quantifySets(const std::vector< int > &order,
+                                                   const std::vector< std::vector< int > > &supports) const
+{
+  std::vector< bdd > res(order.size(), bdd_true());
+  if (keep_.empty())
+    return res;
+  std::vector< int > last(bdd_varnum(), -1);
+  for (auto pos : std::views::iota(size_t{0}, order.size()))
+    for (auto var : supports[order[pos]])
+      last[var] = static_cast< int >(pos);
+  for (auto var : std::views::iota(0, bdd_varnum()))
+    if (last[var] >= 0 && !keep_[var])
+      res[last[var]] &= bdd_ithvar(var);
+  return res;
+}
+
+void BDDFormulaBuilder::conjoin(const bdd &condition, const bdd &quantify)
+{
+  formula_ = timed([this, &condition, &quantify] {
+    return quantify == bdd_true() ? formula_ & condition : bdd_appex(formula_, condition, bddop_and, quantify);
+  });
+  if (measureLargest_)
+    largestNodes_ = std::max(largestNodes_, bdd_nodecount(formula_));
+}
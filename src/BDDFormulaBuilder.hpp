@@ -2,23 +2,112 @@
 #define BDD_FORMULA_BUILDER_HPP
 
 #include "bdd.h"
-#include <mutex>
+#include <ostream>
+#include <vector>
+#include <tbb/enumerable_thread_specific.h>
 #include "config.h"
 
 class BDDFormulaBuilder
 {
 public:
-  BDDFormulaBuilder();
+  enum class Mode
+  {
+    CONJOIN,  // conjoin the conditions into result() as they come, and
+              // register their supports with bdd_addinteraction
+    BALANCED, // as CONJOIN, but conjoin them in batches, the two smallest
+              // formulas of a batch first, see conjoinPending()
+    SCHEDULED, // as CONJOIN, but conjoin them in result(), clustered and
+               // ordered by their supports, see conjoinScheduled()
+    COLLECT   // only keep the conditions, see conditions()
+  };
+
+  // batch is the number of conditions BALANCED mode collects before it
+  // conjoins them with the result, 0 for all of them.
+  explicit BDDFormulaBuilder(Mode mode = Mode::CONJOIN, int batch = 0);
 
   void addCondition(bdd formula);
 
-  void addConditionTh(bdd formula);
+  // addCondition for worker threads, with the kernel in concurrent mode
+  // (bdd_setconcurrent). Each thread keeps the conditions it adds apart,
+  // and in CONJOIN mode without a projection conjoins them into a partial
+  // result of its own, starting from the result so far. Call
+  // mergePartials() once the threads are done, while the kernel is still
+  // concurrent.
+  void addConditionPartial(bdd formula);
+
+  // Conjoins the partial results pairwise in a tree into the result, and
+  // hands the conditions of the other modes on to addCondition. The tree
+  // runs in parallel only while the kernel is concurrent; addCondition
+  // and result() also call it, and then it runs on one thread.
+  void mergePartials();
 
   bdd result();
 
+  // Conditions added in COLLECT mode, in order.
+  const std::vector< bdd > &conditions() const;
+
+  // Makes result() the conjunction with every variable outside keep (a
+  // variable set) existentially quantified. In CONJOIN and SCHEDULED
+  // modes a variable goes in the bdd_appex of the last condition that
+  // mentions it, so it never reaches the larger formulas after it;
+  // BALANCED mode quantifies at the end. Call before adding conditions.
+  void project(bdd keep);
+
+  // Makes CONJOIN mode record largestNodes(), at the cost of a
+  // bdd_nodecount per condition. BALANCED and SCHEDULED modes always
+  // record it.
+  void measureLargest();
+
+  // Largest formula a conjunction has produced so far, in nodes.
+  int largestNodes() const;
+
+  // One conjunction of SCHEDULED mode: a cluster of conditions conjoined
+  // into the result.
+  struct Step
+  {
+    std::vector< int > conditions; // numbered in the order they were added,
+                                   // from 0, and conjoined in this order
+    int supportSize;               // variables of the cluster
+    int newVars;                   // of those, not in the result before
+    int quantified;                // variables the step quantified, see project()
+    double restriction;            // bits of assignments it rules out, see
+                                   // conjoinScheduled()
+    int nodes;                     // of the result after the step
+  };
+
+  // The steps result() took in SCHEDULED mode.
+  const std::vector< Step > &schedule() const;
+
+  // schedule() as JSON, like bddMetrics::printJson.
+  void printSchedule(std::ostream &out) const;
+
 private:
+  void conjoinPending();
+
+  void conjoinScheduled();
+
+  std::vector< bdd > quantifySets(const std::vector< int > &order,
+                                  const std::vector< std::vector< int > > &supports) const;
+
+  void conjoin(const bdd &condition, const bdd &quantify);
+
+  // What one thread has added since the last mergePartials().
+  struct Partial
+  {
+    bool seeded = false;           // formula starts from the result
+    bdd formula;
+    std::vector< bdd > conditions; // in the order the thread added them
+  };
+
+  Mode mode_;
+  int batch_;
+  bool measureLargest_;
   bdd formula_;
-  std::mutex mut_;
+  std::vector< bdd > conditions_;
+  int largestNodes_ = 0;
+  std::vector< Step > schedule_;
+  std::vector< bool > keep_; // per variable, empty without project()
+  tbb::enumerable_thread_specific< Partial > partials_;
 };
 
 #endif
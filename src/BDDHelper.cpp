@@ -3,57 +3,138 @@
 #include <utility>
 #include <algorithm>
 #include <ranges>
+#include <cstdlib>
+#include "fdd.h"
 
 namespace bddHelper
 {
-  BDDHelper::BDDHelper(vect< vect< vect< bdd > > > structedVars) :
-    structVars_(std::move(structedVars))
+  // structedVars is [obj][prop][bit], most significant bit first; the
+  // variables move into one flat table.
+  BDDHelper::BDDHelper(vect< vect< vect< bdd > > > &&structedVars)
   {
-    values_ = vect< vect< vect< bdd > > >(nObjs);
+    assert(structedVars.size() == nObjs);
     for (auto objNum : std::views::iota(0, nObjs))
     {
-      values_[objNum] = vect< vect< bdd > >(nProps);
+      assert(structedVars[objNum].size() == nProps);
       for (auto propNum : std::views::iota(0, nProps))
       {
-        values_[objNum][propNum] = vect< bdd > (nVals);
+        auto &vars = structedVars[objNum][propNum];
+        assert(vars.size() == nValueBits);
+        std::ranges::move(vars, structVars_.begin() + slot(objNum, propNum) * nValueBits);
+        auto propVars = getObjPropertyVars(static_cast< Object >(objNum), static_cast< Property >(propNum));
         for (auto valNum : std::views::iota(0, nVals))
         {
-          values_[objNum][propNum][valNum] = numToBin(valNum, structVars_[objNum][propNum]);
+          values_[slot(objNum, propNum) * nVals + valNum] = numToBin(valNum, propVars);
         }
       }
     }
   }
 
-  std::vector< bdd > BDDHelper::getObjPropertyVars(Object obj, Property prop)
+  // Every group becomes one fdd_extdomain call, so the bits of its domains
+  // are interleaved and the groups follow each other from variable 0 on.
+  // A group is also a variable block: fixed when it is a single value, so
+  // reordering moves the value as a whole, free otherwise, like
+  // VarOrder::blocks. The domains live until bdd_done, build one FDD helper
+  // per bdd_init.
+  BDDHelper::BDDHelper(const vect< vect< std::pair< int, int > > > &domainGroups) :
+    encoding_(Encoding::FDD),
+    domains_(nObjs, vect< int >(nProps, -1))
+  {
+    for (const auto &group : domainGroups)
+    {
+      vect< int > sizes(group.size(), nVals);
+      int first = fdd_extdomain(sizes.data(), static_cast< int >(sizes.size()));
+      assert(first >= 0);
+      for (auto i : std::views::iota(0, static_cast< int >(group.size())))
+        domains_[group[i].first][group[i].second] = first + i;
+      int last = first + static_cast< int >(group.size()) - 1;
+      fdd_intaddvarblock(first, last, first == last ? BDD_REORDER_FIXED : BDD_REORDER_FREE);
+    }
+
+    for (auto objNum : std::views::iota(0, nObjs))
+      for (auto propNum : std::views::iota(0, nProps))
+      {
+        int domain = domains_[objNum][propNum];
+        assert(("Every object property needs a domain", domain >= 0));
+        assert(fdd_varnum(domain) == nValueBits);
+        // fdd_vars lists the least significant bit first, numToBin wants
+        // the most significant one.
+        const int *vars = fdd_vars(domain);
+        for (auto bit : std::views::iota(0, nValueBits))
+          structVars_[slot(objNum, propNum) * nValueBits + bit] = bdd_ithvar(vars[nValueBits - 1 - bit]);
+        for (auto valNum : std::views::iota(0, nVals))
+          values_[slot(objNum, propNum) * nVals + valNum] = fdd_ithvar(domain, valNum);
+      }
+  }
+
+  bdd BDDHelper::equals(Object obj1, Object obj2, Property prop) const
+  {
+    assert(encoding_ == Encoding::FDD);
+    auto propNum = toNum(prop);
+    return fdd_equals(domains_[toNum(obj1)][propNum], domains_[toNum(obj2)][propNum]);
+  }
+
+  bdd BDDHelper::domain(Object obj, Property prop) const
+  {
+    assert(encoding_ == Encoding::FDD);
+    return fdd_domain(domains_[toNum(obj)][toNum(prop)]);
+  }
+
+  std::optional< std::vector< std::vector< int > > > BDDHelper::anySolution(const bdd &formula) const
+  {
+    assert(encoding_ == Encoding::FDD);
+    int *values = fdd_scanallvar(formula);
+    if (values == nullptr)
+      return std::nullopt;
+    vect< vect< int > > solution(nObjs, vect< int >(nProps));
+    for (auto objNum : std::views::iota(0, nObjs))
+      for (auto propNum : std::views::iota(0, nProps))
+        solution[objNum][propNum] = values[domains_[objNum][propNum]];
+    std::free(values);
+    return solution;
+  }
+
+  // The nValueBits variables of prop of obj, most significant first. The
+  // span points into the helper.
+  std::span< const bdd > BDDHelper::getObjPropertyVars(Object obj, Property prop) const
   {
     auto objNum = toNum(obj);
     auto propNum = toNum(prop);
-    return structVars_[objNum][propNum];
+    return std::span(structVars_).subspan(slot(objNum, propNum) * nValueBits, nValueBits);
+  }
+
+  // Conjunction of the variables, the form bdd_exist and bdd_appex take
+  // variable sets in. Same in both encodings.
+  bdd BDDHelper::propertyVars(Property prop) const
+  {
+    auto res = bdd_true();
+    for (auto objNum : std::views::iota(0, nObjs))
+      for (const auto &var : getObjPropertyVars(static_cast< Object >(objNum), prop))
+        res &= var;
+    return res;
   }
 
   // See BDDHelper::numToBinUnsafe - right the next
-  bdd BDDHelper::numToBin(int num, vect< bdd > vars)
+  bdd BDDHelper::numToBin(int num, std::span< const bdd > vars) const
   {
-    assert(vars.size() == 4);
-    assert(num >= 0 and num <= 8);
+    assert(vars.size() == nValueBits);
+    assert(num >= 0 and num < nVals);
     return numToBinUnsafe(num, vars);
   }
 
-  bdd BDDHelper::numToBinUnsafe(int num, vect< bdd > vars)
+  // The bit patterns come from Shape::valueBits, one step per bit.
+  bdd BDDHelper::numToBinUnsafe(int num, std::span< const bdd > vars) const
   {
-    assert(vars.size() == 4);
-    assert(num >= 0 and num <= 15);
+    assert(vars.size() == nValueBits);
+    assert(num >= 0 and num < Shape::nCodes);
+    const auto &bits = Shape::valueBits[num];
     auto resFormula = bdd_true();
-    auto currentNum = num;
-    for (auto var : std::views::reverse(vars))
-    {
-      auto bit = currentNum % 2;
-      currentNum /= 2;
-      if (bit == 1)
-        resFormula &= var;
+    puzzle::unrolled< nValueBits >([&](auto bit) {
+      if (bits[bit])
+        resFormula &= vars[bit];
       else
-        resFormula &= not var;
-    }
+        resFormula &= not vars[bit];
+    });
     return resFormula;
   }
 
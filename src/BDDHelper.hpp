@@ -2,11 +2,15 @@
 #define BDD_HELPER_HPP
 
 #include <vector>
+#include <array>
+#include <span>
 #include <type_traits>
 #include <cassert>
 #include <utility>
 #include <cmath>
+#include <optional>
 #include "bdd.h"
+#include "Puzzle.hpp"
 
 namespace bddHelper
 {
@@ -151,30 +155,60 @@ namespace bddHelper
   {
   public:
     template < class T > using vect = std::vector< T >;
+
+    // How the value of an object property is put into its nValueBits
+    // variables.
+    enum class Encoding
+    {
+      BITS, // conjunctions of the bits built here, see numToBin
+      FDD   // a finite domain of fdd.h per object and property
+    };
+
     /// See all these in \b main.cpp
 
-    static constexpr int nObjs = 9;
-    static constexpr int nProps = 4;
-    static constexpr int nVals = 9;
-    static constexpr int nValueBits = 4;
+    using Shape = puzzle::Shape;
+    static constexpr int nObjs = Shape::nObjs;
+    static constexpr int nProps = Shape::nProps;
+    static constexpr int nVals = Shape::nVals;
+    static constexpr int nValueBits = Shape::nValueBits;
     static constexpr int nValuesVars = nObjs * nProps * nValueBits;
     static constexpr int nTotalVars = nValuesVars;
 
     // See BDDHelper.cpp file
-    BDDHelper(vect< vect< vect< bdd > > > structedVars);
+    BDDHelper(vect< vect< vect< bdd > > > &&structedVars);
+
+    // FDD encoding. Every group holds the (object, property) pairs of one
+    // fdd_extdomain call, whose bits are interleaved; see BDDHelper.cpp.
+    explicit BDDHelper(const vect< vect< std::pair< int, int > > > &domainGroups);
+
+    Encoding encoding() const { return encoding_; }
 
     // See below
     template< class V_t >
-    bdd getObjectVal(Object obj, V_t value);
+    const bdd &getObjectVal(Object obj, V_t value) const;
 
     // See BDDHelper.cpp file
-    std::vector< bdd > getObjPropertyVars(Object obj, Property prop);
+    std::span< const bdd > getObjPropertyVars(Object obj, Property prop) const;
+
+    // Variables of prop of every object, as a variable set. See
+    // BDDHelper.cpp file
+    bdd propertyVars(Property prop) const;
 
     // See BDDHelper.cpp file
-    bdd numToBin(int num, vect< bdd > vars);
+    bdd numToBin(int num, std::span< const bdd > vars) const;
 
     // See BDDHelper.cpp file
-    bdd numToBinUnsafe(int num, vect< bdd > vars);
+    bdd numToBinUnsafe(int num, std::span< const bdd > vars) const;
+
+    // FDD encoding only: obj1 and obj2 have the same value of prop.
+    bdd equals(Object obj1, Object obj2, Property prop) const;
+
+    // FDD encoding only: the value of prop of obj is below nVals.
+    bdd domain(Object obj, Property prop) const;
+
+    // FDD encoding only: the values of one solution of formula as
+    // [obj][prop], decoded with fdd_scanallvar; empty if it has none.
+    std::optional< vect< vect< int > > > anySolution(const bdd &formula) const;
 
   private:
   #ifdef GTEST_TESTING // ignore
@@ -182,20 +216,26 @@ namespace bddHelper
     friend class ::VarsSetupFixture;
     BDDHelper();
   #endif
+    // The tables hold the entries of one object property next to each
+    // other, at Shape::slot.
+    static constexpr int slot(int objNum, int propNum) { return Shape::slot(objNum, propNum); }
+
     // See constructor
-    vect< vect< vect< bdd > > > structVars_;
-    vect< vect< vect< bdd > > > values_;
+    std::array< bdd, nObjs * nProps * nValueBits > structVars_; // [obj][prop][bit]
+    std::array< bdd, nObjs * nProps * nVals > values_;          // [obj][prop][val]
+    Encoding encoding_ = Encoding::BITS;
+    vect< vect< int > > domains_; // fdd domain of [obj][prop]
   };
 
 
   template < class V_t >
-  inline bdd BDDHelper::getObjectVal(Object obj, V_t value)
+  inline const bdd &BDDHelper::getObjectVal(Object obj, V_t value) const
   {
     static_assert(traits_::IsValueType_v< V_t >, "Value must be one of properties type");
     auto objNum = toNum(obj);
     auto propNum = toNum(traits_::PropertyFromValueEnum_v< V_t >);
     auto valNum = toNum(value);
-    return values_[objNum][propNum][valNum];
+    return values_[slot(objNum, propNum) * nVals + valNum];
   }
 
   template < class Enum_Val_t >
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <mutex>
+#include "bdd.h"
+#include "BDDMetrics.hpp"
+
+namespace bddMetrics
+{
+  namespace
+  {
+    using clock = std::chrono::steady_clock;
+
+    // The kernel calls the hooks with every other operator stopped, so
+    // no locking is needed here.
+    std::vector<GcEvent> gcs;
+    std::vector<ResizeEvent> resizes;
+    clock::time_point gcStart;
+    int gcFreeBefore = 0;
+
+    // Partial results are conjoined on worker threads.
+    std::mutex conjunctionLock;
+    std::vector<double> conjunctions;
+    bool recording = false;
+
+    // Bucket n holds times below 2^n microseconds and at least half that.
+    std::vector<int> conjunctionHistogram()
+    {
+      std::vector<int> res;
+      for (double us : conjunctions)
+      {
+        auto bucket = static_cast< size_t >(std::bit_width(static_cast< unsigned long >(us)));
+        if (res.size() <= bucket)
+          res.resize(bucket + 1);
+        res[bucket]++;
+      }
+      return res;
+    }
+
+    void onGc(int pre, bddGbcStat *stat)
+    {
+      if (pre)
+      {
+        gcFreeBefore = stat->freenodes;
+        gcStart = clock::now();
+        return;
+      }
+      double pauseMs = std::chrono::duration< double, std::milli >(clock::now() - gcStart).count();
+      gcs.push_back({ pauseMs, gcFreeBefore, stat->freenodes, stat->nodes, stat->nodes });
+    }
+
+    void onResize(int oldSize, int newSize)
+    {
+      resizes.push_back({ oldSize, newSize });
+      // A resize right after a collection is the kernel growing the table
+      // because too little was freed.
+      if (!gcs.empty() && gcs.back().sizeAfter == oldSize)
+        gcs.back().sizeAfter = newSize;
+    }
+  }
+
+  void install()
+  {
+    gcs.clear();
+    resizes.clear();
+    conjunctions.clear();
+    recording = true;
+    bdd_gbc_hook(onGc);
+    bdd_resize_hook(onResize);
+  }
+
+  const std::vector<GcEvent> &gcEvents()
+  {
+    return gcs;
+  }
+
+  const std::vector<ResizeEvent> &resizeEvents()
+  {
+    return resizes;
+  }
+
+  void recordConjunction(clock::duration time)
+  {
+    if (!recording)
+      return;
+    std::lock_guard lock(conjunctionLock);
+    conjunctions.push_back(std::chrono::duration< double, std::micro >(time).count());
+  }
+
+  const std::vector<double> &conjunctionTimes()
+  {
+    return conjunctions;
+  }
+
+  void printSummary(std::ostream &out)
+  {
+    double totalMs = 0, maxMs = 0;
+    long freed = 0;
+    for (const auto &gc : gcs)
+    {
+      totalMs += gc.pauseMs;
+      maxMs = std::max(maxMs, gc.pauseMs);
+      freed += gc.freeAfter - gc.freeBefore;
+    }
+    out << "Garbage collections: " << gcs.size() << ", " << totalMs << " ms total, "
+        << maxMs << " ms longest, " << freed << " nodes freed\n";
+    out << "Node table resizes: " << resizes.size();
+    if (!resizes.empty())
+      out << ", " << resizes.front().oldSize << " -> " << resizes.back().newSize << " nodes";
+    out << '\n';
+    out << "Conjunctions: " << conjunctions.size();
+    auto histogram = conjunctionHistogram();
+    for (size_t bucket = 0; bucket < histogram.size(); ++bucket)
+      if (histogram[bucket])
+        out << ", <" << (1ul << bucket) << " us: " << histogram[bucket];
+    out << '\n';
+  }
+
+  void printJson(std::ostream &out)
+  {
+    out << "{\"gc\": [";
+    for (size_t i = 0; i < gcs.size(); ++i)
+    {
+      const auto &gc = gcs[i];
+      out << (i ? ", " : "") << "{\"pause_ms\": " << gc.pauseMs
+          << ", \"freed\": " << gc.freeAfter - gc.freeBefore
+          << ", \"size_before\": " << gc.sizeBefore
+          << ", \"size_after\": " << gc.sizeAfter << '}';
+    }
+    out << "], \"resize\": [";
+    for (size_t i = 0; i < resizes.size(); ++i)
+    {
+      out << (i ? ", " : "") << "{\"old_size\": " << resizes[i].oldSize
+          << ", \"new_size\": " << resizes[i].newSize << '}';
+    }
+    out << "], \"conjunction_us\": [";
+    auto histogram = conjunctionHistogram();
+    for (size_t bucket = 0; bucket < histogram.size(); ++bucket)
+      out << (bucket ? ", " : "") << "{\"below\": " << (1ul << bucket) << ", \"count\": " << histogram[bucket] << '}';
+    out << "]}\n";
+  }
+}
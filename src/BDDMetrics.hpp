@@ -0,0 +1,48 @@
+#ifndef BDD_METRICS
+#define BDD_METRICS
+
+#include <chrono>
+#include <ostream>
+#include <vector>
+
+namespace bddMetrics
+{
+  struct GcEvent
+  {
+    double pauseMs;  // wall time of the collection
+    int freeBefore;  // free nodes when the collection started
+    int freeAfter;   // free nodes when it ended
+    int sizeBefore;  // node table size when it started
+    int sizeAfter;   // node table size after any resize that followed it
+  };
+
+  struct ResizeEvent
+  {
+    int oldSize;
+    int newSize;
+  };
+
+  // Starts recording through bdd_gbc_hook and bdd_resize_hook. Must be
+  // called after bdd_init, which installs the default handlers.
+  void install();
+
+  const std::vector<GcEvent> &gcEvents();
+
+  const std::vector<ResizeEvent> &resizeEvents();
+
+  // Records the time of one conjunction of the formula builder, from any
+  // thread. Ignored before install().
+  void recordConjunction(std::chrono::steady_clock::duration time);
+
+  // Times of the recorded conjunctions, in microseconds, in no
+  // particular order.
+  const std::vector<double> &conjunctionTimes();
+
+  // Includes a histogram of the conjunction times, in power-of-two
+  // microsecond buckets.
+  void printSummary(std::ostream &out);
+
+  void printJson(std::ostream &out);
+}
+
+#endif
@@ -0,0 +1,37 @@
+#include <algorithm>
+#include <sys/resource.h>
+#include "BDDSizing.hpp"
+
+namespace bddSizing
+{
+  namespace
+  {
+    // Every conjunction keeps roughly a few layers of nodes per variable
+    // alive at once, so the table scales with variables times constraints.
+    constexpr int nodesPerVarConstraint = 8;
+    constexpr int minNodes = 10000;
+    // Same ratio as bdd_setcacheratio(4): one cache entry per four nodes.
+    constexpr int nodesPerCacheEntry = 4;
+    constexpr int minCache = 1000;
+  }
+
+  TableSize estimate(int nVars, int nConstraints, int nodesOverride, int cacheOverride)
+  {
+    TableSize size{};
+    size.nodes = nodesOverride > 0
+      ? nodesOverride
+      : std::max(minNodes, nVars * (nConstraints + 1) * nodesPerVarConstraint);
+    size.cache = cacheOverride > 0
+      ? cacheOverride
+      : std::max(minCache, size.nodes / nodesPerCacheEntry);
+    return size;
+  }
+
+  long peakRssKb()
+  {
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+      return 0;
+    return usage.ru_maxrss;
+  }
+}
@@ -0,0 +1,20 @@
+#ifndef BDD_SIZING
+#define BDD_SIZING
+
+namespace bddSizing
+{
+  struct TableSize
+  {
+    int nodes;
+    int cache;
+  };
+
+  // Initial node table and operator cache size for a puzzle with nVars
+  // variables and nConstraints loaded constraints. Nonzero overrides win.
+  TableSize estimate(int nVars, int nConstraints, int nodesOverride = 0, int cacheOverride = 0);
+
+  // Peak resident set size of the process in kilobytes.
+  long peakRssKb();
+}
+
+#endif
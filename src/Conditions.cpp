@@ -9,6 +9,11 @@
 #include <type_traits>
 #include <set>
 #include <utility>
+#include <bit>
+#include <array>
+#include <span>
+#include <tbb/task_arena.h>
+#include "bvec.h"
 
 using namespace bddHelper;
 
@@ -28,26 +33,9 @@ namespace
   };
 }
 
-namespace std
-{
-  template< class T >
-  bool between(T const &val, T const &lo, T const &hi)
-  {
-    return between( val, lo, hi, std::less_equal< T >() );
-  }
-
-  template< class T, class Compare >
-  bool between(T const &val, T const &lo, T const &hi, Compare comp)
-  {
-    return comp(lo, val) && comp(val, hi);
-  }
-}
-
 namespace
 {
   config config;
-  std::vector leftNeighbourXYOffset = config.getLeftNeighbourXyOffset();
-  std::vector rightNeighbourXYOffset = config.getRightNeighbourXyOffset();
 
   bool vSkl = config.isVertSkleika();
   bool hSkl = config.isHorSkleika();
@@ -55,57 +43,142 @@ namespace
   // Don't touch it...
   bool useSkleika = vSkl || hSkl;
 
-  template < class ... V_ts >
-  void addLoopCondition(std::tuple< V_ts... > values, BDDHelper &h, BDDFormulaBuilder &builder);
+  // Lets several threads run BDD operations at once while it is alive.
+  // Must be created and destroyed outside of any parallel section. When
+  // the parallel algorithms run on one thread the locking would only cost
+  // time, so the kernel stays sequential there. That is decided by the
+  // task arena, which can have more threads than cores.
+  class ConcurrentKernel
+  {
+  public:
+    ConcurrentKernel() : prev_(bdd_setconcurrent(tbb::this_task_arena::max_concurrency() > 1)) {}
+    ~ConcurrentKernel() { bdd_setconcurrent(prev_); }
 
-  template < class V_t1, class V_t2 >
-  void addNeighbours(V_t1 value1, V_t2 value2, BDDHelper &h, BDDFormulaBuilder &builder);
+  private:
+    int prev_;
+  };
 
-  template < class V_t1, class V_t2 >
-  void addLeftNeighbour(V_t1 value1, V_t2 value2, BDDHelper &h, BDDFormulaBuilder &builder);
+  // The conditions are written once for both backends. Helper_t is
+  // BDDHelper or MDDHelper, Builder_t the matching formula builder.
+  template < class ... V_ts, class Helper_t, class Builder_t >
+  void addLoopCondition(std::tuple< V_ts... > values, Helper_t &h, Builder_t &builder);
 
-  template < class V_t1, class V_t2 >
-  void addRightNeighbour(V_t1 value1, V_t2 value2, BDDHelper &h, BDDFormulaBuilder &builder);
+  template < class V_t1, class V_t2, class Helper_t, class Builder_t >
+  void addNeighbours(V_t1 value1, V_t2 value2, Helper_t &h, Builder_t &builder);
+
+  template < class V_t1, class V_t2, class Helper_t, class Builder_t >
+  void addLeftNeighbour(V_t1 value1, V_t2 value2, Helper_t &h, Builder_t &builder);
+
+  template < class V_t1, class V_t2, class Helper_t, class Builder_t >
+  void addRightNeighbour(V_t1 value1, V_t2 value2, Helper_t &h, Builder_t &builder);
+
+  // Set by addConditions: every value is held by exactly one object once
+  // UNIQUE is among the conditions, so the neighbour rules on the BDD
+  // backend can compare the positions of two values instead of
+  // enumerating object pairs.
+  bool valuesUnique = false;
+
+  // Objects sit on a gridWidth x gridHeight grid, see puzzle::Puzzle.
+  constexpr int gridWidth = BDDHelper::Shape::width;
+  constexpr int gridHeight = BDDHelper::Shape::height;
+
+  // Neighbour topology of the configuration, built once by adjacency().
+  // Bit n of left[obj] is set when object n is the left neighbour of obj,
+  // the same for right, and both is their union.
+  struct Adjacency
+  {
+    using Mask = BDDHelper::Shape::Mask;
+
+    std::array< std::array< int, 2 >, 2 > offsets; // XY of the left, then the right neighbour
+    std::array< Mask, BDDHelper::nObjs > left;
+    std::array< Mask, BDDHelper::nObjs > right;
+    std::array< Mask, BDDHelper::nObjs > both;
+  };
+
+  // Column and row of the object that has a value, as bit-vectors. Bit i
+  // of a coordinate is the disjunction of the objects whose coordinate has
+  // bit i set, one term per object. Only meaningful when a single object
+  // has the value.
+  struct Position
+  {
+    bvec x;
+    bvec y;
+    bdd held; // some object has the value
+  };
 
   // See below
-  std::optional< Object > getNeighbour_(Object obj, std::vector< int > neighbourXYOffset);
+  template < class V_t >
+  Position position(V_t value, const BDDHelper &h);
   // See below
-  std::optional< Object > getLeftNeighbour(Object obj);
+  bdd shifted(const bvec &from, const bvec &to, int offset, int size, bool wrap);
   // See below
-  std::optional< Object > getRightNeighbour(Object obj);
+  template < class V_t1, class V_t2 >
+  bdd positionalNeighbour(V_t1 value1, V_t2 value2, const BDDHelper &h, std::span< const std::array< int, 2 > > offsets);
   // See below
-  std::vector< Object > getNeighbours(Object obj);
+  const Adjacency &adjacency();
 
   // See below
-  bdd equal(bdd a, bdd b);
+  bdd equal(const bdd &a, const bdd &b);
   // See below
-  bdd notEqual(std::vector< bdd > v1, std::vector< bdd > v2);
+  bdd notEqual(std::span< const bdd > v1, std::span< const bdd > v2);
+
+  // Constants and value inequality of each backend. The BDD ones are
+  // here, the other helpers have them as members.
+  bdd falseFormula(const BDDHelper &) { return bdd_false(); }
+  bdd trueFormula(const BDDHelper &) { return bdd_true(); }
+
+  template < class Helper_t >
+  auto falseFormula(const Helper_t &h) { return h.falseFormula(); }
+
+  template < class Helper_t >
+  auto trueFormula(const Helper_t &h) { return h.trueFormula(); }
+
+  bdd differ(const BDDHelper &h, Object obj1, Object obj2, Property prop)
+  {
+    if (h.encoding() == BDDHelper::Encoding::FDD)
+      return not h.equals(obj1, obj2, prop);
+    return notEqual(h.getObjPropertyVars(obj1, prop), h.getObjPropertyVars(obj2, prop));
+  }
+
+  template < class Helper_t >
+  auto differ(const Helper_t &h, Object obj1, Object obj2, Property prop)
+  {
+    return h.differ(obj1, obj2, prop);
+  }
 
   // See below
-  void addFirstCondition(BDDHelper &h, BDDFormulaBuilder &builder);
+  template < class Helper_t, class Builder_t >
+  void addFirstCondition(Helper_t &h, Builder_t &builder);
   // See below
-  void addSecondCondition(BDDHelper &h, BDDFormulaBuilder &builder);
+  template < class Helper_t, class Builder_t >
+  void addSecondCondition(Helper_t &h, Builder_t &builder);
   // See below
-  void addThirdCondition(BDDHelper &h, BDDFormulaBuilder &builder);
+  template < class Helper_t, class Builder_t >
+  void addThirdCondition(Helper_t &h, Builder_t &builder);
   // See below
-  void addFourthCondition(BDDHelper &h, BDDFormulaBuilder &builder);
+  template < class Helper_t, class Builder_t >
+  void addFourthCondition(Helper_t &h, Builder_t &builder);
   // See below
-  void addUniqueCondition(BDDHelper &h, BDDFormulaBuilder &builder);
+  template < class Helper_t, class Builder_t >
+  void addUniqueCondition(Helper_t &h, Builder_t &builder);
   // See below
   void addValuesUpperBoundCondition(BDDHelper &h, BDDFormulaBuilder &builder);
+  // See below
+  template < class Helper_t, class Builder_t >
+  void addValuesUpperBoundCondition(Helper_t &h, Builder_t &builder);
 
-  template < class ... V_ts >
-  void addLoopCondition(std::tuple< V_ts... > values, BDDHelper &h, BDDFormulaBuilder &builder)
+  template < class ... V_ts, class Helper_t, class Builder_t >
+  void addLoopCondition(std::tuple< V_ts... > values, Helper_t &h, Builder_t &builder)
   {
     // Helps to avoid controversy in conditions.
     unique_types< V_ts... > check_uniquness;
-    auto resultFormulaToAdd = bdd_false();
+    auto resultFormulaToAdd = falseFormula(h);
     // Here we loop through objects and say that
     // current object must have all given values.
     for (auto i : std::views::iota(0, BDDHelper::nObjs))
     {
       auto obj = static_cast< Object >(i);
-      auto formulas = bdd_true();
+      auto formulas = trueFormula(h);
       std::apply([&formulas, &h, &obj](auto &&... args) {
         ((formulas &= h.getObjectVal(obj, args)), ...); //Here we say current object must have all given values.
       }, values);
@@ -115,148 +188,167 @@ namespace
     builder.addCondition(resultFormulaToAdd);
   }
 
-  template < class V_t1, class V_t2 >
-  void addNeighbours(V_t1 value1, V_t2 value2, BDDHelper &h, BDDFormulaBuilder &builder)
+  template < class V_t1, class V_t2, class Helper_t, class Builder_t >
+  void addNeighbours(V_t1 value1, V_t2 value2, Helper_t &h, Builder_t &builder)
   {
     static_assert(traits_::IsValueType_v< V_t1 > && traits_::IsValueType_v< V_t2 >, "Value must be one of properties type");
-    auto resultFormulaToAdd = bdd_false();
+    if constexpr (std::is_same_v< Helper_t, BDDHelper >)
+      if (valuesUnique)
+      {
+        builder.addConditionPartial(positionalNeighbour(value1, value2, h, adjacency().offsets));
+        return;
+      }
+    const auto &both = adjacency().both;
+    auto resultFormulaToAdd = falseFormula(h);
     for (auto objNum : std::views::iota(0, BDDHelper::nObjs))
     {
       auto obj = static_cast< Object >(objNum);
-      for (auto neighbObj : getNeighbours(obj))
+      for (auto mask = both[objNum]; mask; mask &= mask - 1)
+      {
+        auto neighbObj = static_cast< Object >(std::countr_zero(mask));
         resultFormulaToAdd |= (h.getObjectVal(obj, value1) & h.getObjectVal(neighbObj, value2));
+      }
     }
-    builder.addCondition(resultFormulaToAdd);
+    builder.addConditionPartial(resultFormulaToAdd);
   }
 
-  template < class V_t1, class V_t2 >
-  void addLeftNeighbour(V_t1 value1, V_t2 value2, BDDHelper &h, BDDFormulaBuilder &builder)
+  template < class V_t1, class V_t2, class Helper_t, class Builder_t >
+  void addLeftNeighbour(V_t1 value1, V_t2 value2, Helper_t &h, Builder_t &builder)
   {
     static_assert(traits_::IsValueType_v< V_t1 > && traits_::IsValueType_v< V_t2 >, "Value must be one of properties type");
-    auto resultFormulaToAdd = bdd_false();
+    if constexpr (std::is_same_v< Helper_t, BDDHelper >)
+      if (valuesUnique)
+      {
+        builder.addCondition(positionalNeighbour(value1, value2, h, std::span(adjacency().offsets).first(1)));
+        return;
+      }
+    const auto &left = adjacency().left;
+    auto resultFormulaToAdd = falseFormula(h);
     for (auto objNum : std::views::iota(0, BDDHelper::nObjs))
     {
       auto obj = static_cast< Object >(objNum);
-      if (auto neighbObj = getLeftNeighbour(obj); neighbObj.has_value())
-        resultFormulaToAdd |= (h.getObjectVal(obj, value1) & h.getObjectVal(*neighbObj, value2));
+      if (auto mask = left[objNum])
+        resultFormulaToAdd |= (h.getObjectVal(obj, value1) & h.getObjectVal(static_cast< Object >(std::countr_zero(mask)), value2));
     }
     builder.addCondition(resultFormulaToAdd);
   }
 
-  template < class V_t1, class V_t2 >
-  void addRightNeighbour(V_t1 value1, V_t2 value2, BDDHelper &h, BDDFormulaBuilder &builder)
+  template < class V_t1, class V_t2, class Helper_t, class Builder_t >
+  void addRightNeighbour(V_t1 value1, V_t2 value2, Helper_t &h, Builder_t &builder)
   {
     static_assert(traits_::IsValueType_v< V_t1 > && traits_::IsValueType_v< V_t2 >, "Value must be one of properties type");
-    auto resultFormulaToAdd = bdd_false();
+    if constexpr (std::is_same_v< Helper_t, BDDHelper >)
+      if (valuesUnique)
+      {
+        builder.addCondition(positionalNeighbour(value1, value2, h, std::span(adjacency().offsets).last(1)));
+        return;
+      }
+    const auto &right = adjacency().right;
+    auto resultFormulaToAdd = falseFormula(h);
     for (auto objNum : std::views::iota(0, BDDHelper::nObjs))
     {
       auto obj = static_cast< Object >(objNum);
-      if (auto neighbObj = getRightNeighbour(obj); neighbObj.has_value())
-        resultFormulaToAdd |= (h.getObjectVal(obj, value1) & h.getObjectVal(*neighbObj, value2));
+      if (auto mask = right[objNum])
+        resultFormulaToAdd |= (h.getObjectVal(obj, value1) & h.getObjectVal(static_cast< Object >(std::countr_zero(mask)), value2));
     }
     builder.addCondition(resultFormulaToAdd);
   }
 
-  std::optional< Object > getLeftNeighbour(Object obj)
+  template < class V_t >
+  Position position(V_t value, const BDDHelper &h)
   {
-    return getNeighbour_(obj, leftNeighbourXYOffset);
+    constexpr int xBits = std::bit_width(static_cast< unsigned >(gridWidth - 1));
+    constexpr int yBits = std::bit_width(static_cast< unsigned >(gridHeight - 1));
+    Position res{bvec_false(xBits), bvec_false(yBits), bdd_false()};
+    // Unrolled: which object goes into which coordinate bit is known at
+    // compile time.
+    puzzle::unrolled< BDDHelper::nObjs >([&](auto objNum) {
+      const auto &held = h.getObjectVal(static_cast< Object >(objNum()), value);
+      res.held |= held;
+      puzzle::unrolled< xBits >([&](auto bit) {
+        if constexpr ((BDDHelper::Shape::column(objNum) >> bit) & 1)
+          res.x.set(bit, res.x[bit] | held);
+      });
+      puzzle::unrolled< yBits >([&](auto bit) {
+        if constexpr ((BDDHelper::Shape::row(objNum) >> bit) & 1)
+          res.y.set(bit, res.y[bit] | held);
+      });
+    });
+    return res;
   }
 
-  std::optional< Object > getRightNeighbour(Object obj)
+  // to == (from + offset) mod size, where from + offset may only leave
+  // [0, size) if wrap is set. This is Puzzle::neighbourMasks along one
+  // axis: a neighbour off the grid exists only through the Skleika flag
+  // of that axis.
+  bdd shifted(const bvec &from, const bvec &to, int offset, int size, bool wrap)
   {
-    auto res = getNeighbour_(obj, rightNeighbourXYOffset);
+    // Adding a multiple of size keeps the sum non-negative without
+    // changing it modulo size.
+    int base = (std::max(0, -offset) + size - 1) / size * size;
+    // Wide enough for the largest sum and for the bounds the sum is
+    // checked against without wrapping.
+    int largest = std::max(size - 1 + offset, size - 1) + base;
+    int width = std::max(from.bitnum(), static_cast< int >(std::bit_width(static_cast< unsigned >(largest))));
+    auto sum = bvec_coerce(width, from) + bvec_con(width, offset + base);
+    bvec quotient;
+    bvec remainder;
+    bvec_divfixed(sum, size, quotient, remainder);
+    auto res = bvec_coerce(width, to) == remainder;
+    if (!wrap)
+      res &= (sum >= bvec_con(width, base)) & (sum <= bvec_con(width, base + size - 1));
     return res;
   }
 
-  std::optional< Object > getNeighbour_(Object obj, std::vector< int > neighbourXYOffset)
+  // value2 is at one of offsets from value1. The positions take one term
+  // per object and the comparison a few per coordinate bit, where the
+  // enumeration takes one per pair of neighbouring objects.
+  template < class V_t1, class V_t2 >
+  bdd positionalNeighbour(V_t1 value1, V_t2 value2, const BDDHelper &h, std::span< const std::array< int, 2 > > offsets)
   {
-    assert(neighbourXYOffset.size() == 2);
-    struct Point
-    {
-      int x;
-      int y;
-      constexpr bool operator==(const Point &rhs) const
-      {
-        return x == rhs.x && y == rhs.y;
-      }
-    };
-    auto pointToObj =
-      [](Point p) -> Object {
-        assert(std::between(p.x, 0, 2) and std::between(p.y, 0, 2));
-        return static_cast< Object >(p.x + p.y * 3);
-      };
-    auto normX =
-      [](Point p) -> Point {
-        assert(!std::between(p.x, 0, 2));
-        Point res = p;
-        if (p.x < 0)
-          res.x = 3 + p.x % 3;
-        else
-          res.x = p.x % 3;
-        return res;
-      };
-    auto normY =
-      [](Point p) -> Point {
-        assert(!std::between(p.y, 0, 2));
-        Point res = p;
-        if (p.y < 0)
-          res.y = 3 + p.y % 3;
-        else
-          res.y = p.y % 3;
-        return res;
-      };
-    assert((normX({ 3, 0 }) == Point{ 0, 0 }));
-    assert((normY({ 0, 3 }) == Point{ 0, 0 }));
-    assert((normX({ -1, 0 }) == Point{ 2, 0 }));
-    assert((normY({ 0, -1 }) == Point{ 0, 2 }));
-    assert((normX(normY({ -1, -1 })) == Point{ 2, 2 }));
-    assert((normX(normY({ 4, 3 })) == Point{ 1, 0 }));
-    auto objNum = toNum(obj); // First we convert obj to int
-    Point objPos = { objNum % 3, objNum / 3 }; // next we calculate obj coordinates
-    Point neighbObjPos = { objPos.x + neighbourXYOffset[0], objPos.y + neighbourXYOffset[1] }; // calcuate neighbour coords
-
-    if (!std::between(neighbObjPos.x, 0, 2) and !std::between(neighbObjPos.y, 0, 2))
-    {
-      if (!vSkl or !hSkl)
-        return std::nullopt;
-      return pointToObj(normX(normY(neighbObjPos)));
-    }
-    if (!std::between(neighbObjPos.x, 0, 2))
-    {
-      if (!hSkl)
-        return std::nullopt;
-      return pointToObj(normX(neighbObjPos));
-    }
-
-    if (!std::between(neighbObjPos.y, 0, 2))
+    auto from = position(value1, h);
+    auto to = position(value2, h);
+    auto neighbour = bdd_false();
+    for (const auto &offset : offsets)
     {
-      if (!vSkl)
-        return std::nullopt;
-      return pointToObj(normY(neighbObjPos));
+      neighbour |= shifted(from.x, to.x, offset[0], gridWidth, hSkl) & shifted(from.y, to.y, offset[1], gridHeight, vSkl);
     }
-
-    return pointToObj(neighbObjPos);
+    return from.held & to.held & neighbour;
   }
 
-
-  std::vector< Object > getNeighbours(Object obj)
+  // The configuration does not change, so neither do the neighbours: the
+  // rules only read the masks, taken on first use from the table of
+  // puzzle::Puzzle, or computed for an offset of a grid or more.
+  const Adjacency &adjacency()
   {
-    auto left = getLeftNeighbour(obj);
-    auto right = getRightNeighbour(obj);
-    std::vector< Object > resArr;
-    if (left)
-      resArr.push_back(*left);
-    if (right)
-      resArr.push_back(*right);
-    return resArr;
+    static const Adjacency adj = [] {
+      using Shape = BDDHelper::Shape;
+      Adjacency res{};
+      auto toOffset = [](const std::vector< int > &offset) {
+        assert(offset.size() == 2);
+        return std::array< int, 2 >{offset[0], offset[1]};
+      };
+      res.offsets = {toOffset(config.getLeftNeighbourXyOffset()), toOffset(config.getRightNeighbourXyOffset())};
+      auto masks = [](const std::array< int, 2 > &offset) {
+        if (auto tabled = Shape::tabledNeighbours(offset[0], offset[1], hSkl, vSkl))
+          return *tabled;
+        return Shape::neighbourMasks(offset[0], offset[1], hSkl, vSkl);
+      };
+      res.left = masks(res.offsets[0]);
+      res.right = masks(res.offsets[1]);
+      for (auto objNum : std::views::iota(0, BDDHelper::nObjs))
+        res.both[objNum] = res.left[objNum] | res.right[objNum];
+      return res;
+    }();
+    return adj;
   }
 
-  bdd equal(bdd a, bdd b)
+  bdd equal(const bdd &a, const bdd &b)
   {
     return (a & b) | ((not a) & (not b));
   }
 
-  bdd notEqual(std::vector< bdd > a, std::vector< bdd > b)
+  bdd notEqual(std::span< const bdd > a, std::span< const bdd > b)
   {
     assert(a.size() == 4 && a.size() == b.size());
     return std::inner_product(
@@ -265,14 +357,16 @@ namespace
       b.begin(),
       bdd_false(),
       std::bit_or< bdd >(),
-      [](bdd a, bdd b) {
+      [](const bdd &a, const bdd &b) {
       return not equal(a, b);
     });
   }
 
 
-  void addUniqueCondition(BDDHelper &h, BDDFormulaBuilder &builder)
+  template < class Helper_t, class Builder_t >
+  void addUniqueCondition(Helper_t &h, Builder_t &builder)
   {
+    ConcurrentKernel concurrent;
     auto propRange = std::views::iota(0, BDDHelper::nProps);
     //We loop over properties
     std::for_each(std::execution::par, propRange.begin(), propRange.end(),
@@ -286,10 +380,11 @@ namespace
         std::for_each(std::execution::par, obj2Range.begin(), obj2Range.end(),
           [&](auto objNum2) {
           auto obj2 = static_cast< Object >(objNum2);
-          builder.addConditionTh(notEqual(h.getObjPropertyVars(obj1, prop), h.getObjPropertyVars(obj2, prop)));
+          builder.addConditionPartial(differ(h, obj1, obj2, prop));
         });
       });
     });
+    builder.mergePartials();
   }
 
   void addValuesUpperBoundCondition(BDDHelper &h, BDDFormulaBuilder &builder)
@@ -300,7 +395,12 @@ namespace
       for (auto propNum : std::views::iota(0, BDDHelper::nProps))
       {
         auto prop = static_cast< Property >(propNum);
-        for (auto valNum : std::views::iota(9, 16))
+        if (h.encoding() == BDDHelper::Encoding::FDD)
+        {
+          builder.addCondition(h.domain(obj, prop));
+          continue;
+        }
+        for (auto valNum : std::views::iota(BDDHelper::Shape::nVals, BDDHelper::Shape::nCodes))
         {
           builder.addCondition(not h.numToBinUnsafe(valNum, h.getObjPropertyVars(obj, prop)));
         }
@@ -308,14 +408,21 @@ namespace
     }
   }
 
-  void addFirstCondition(BDDHelper &h, BDDFormulaBuilder &builder)
+  // MDD variables have exactly nVals values and ZDD sets stay in the
+  // one-hot domain, there are no codes to exclude.
+  template < class Helper_t, class Builder_t >
+  void addValuesUpperBoundCondition(Helper_t &, Builder_t &) {}
+
+  template < class Helper_t, class Builder_t >
+  void addFirstCondition(Helper_t &h, Builder_t &builder)
   {
       for (auto fconfig: config.getFirstCondition()) {
           builder.addCondition(h.getObjectVal(std::get<0>(fconfig), std::get<1>(fconfig)));
       }
   }
 
-  void addSecondCondition(BDDHelper &h, BDDFormulaBuilder &builder)
+  template < class Helper_t, class Builder_t >
+  void addSecondCondition(Helper_t &h, Builder_t &builder)
   {
       for (auto fconfig: config.getSecondConditionWithOwns()) {
           addLoopCondition(fconfig, h, builder);
@@ -330,19 +437,26 @@ namespace
       }
   }
 
-  void addThirdCondition(BDDHelper &h, BDDFormulaBuilder &builder) {}
+  template < class Helper_t, class Builder_t >
+  void addThirdCondition(Helper_t &h, Builder_t &builder) {}
 
-  void addFourthCondition(BDDHelper &h, BDDFormulaBuilder &builder)
+  template < class Helper_t, class Builder_t >
+  void addFourthCondition(Helper_t &h, Builder_t &builder)
   {
-        for (auto fconfig: config.getForthCondition()) {
+        ConcurrentKernel concurrent;
+        auto &fconfigs = config.getForthCondition();
+        std::for_each(std::execution::par, fconfigs.begin(), fconfigs.end(),
+          [&](auto &fconfig) {
             addNeighbours(std::get<0>(fconfig), std::get<1>(fconfig), h, builder);
-        }
+        });
+        builder.mergePartials();
   }
 }
 
 namespace conditions
 {
-    void addConditionByType(ConditionTypes type, BDDHelper &h, BDDFormulaBuilder &builder) {
+    template < class Helper_t, class Builder_t >
+    void addConditionByType(ConditionTypes type, Helper_t &h, Builder_t &builder) {
         switch (type) {
             case ConditionTypes::FIRST: {
                 addFirstCondition(h, builder);
@@ -372,6 +486,21 @@ namespace conditions
     }
 
       void addConditions(BDDHelper &h, BDDFormulaBuilder &builder, const std::set<ConditionTypes>& types)
+      {
+          valuesUnique = types.contains(ConditionTypes::UNIQUE);
+          for (auto type: types) {
+              addConditionByType(type, h, builder);
+          }
+      }
+
+      void addConditions(MDDHelper &h, MDDFormulaBuilder &builder, const std::set<ConditionTypes>& types)
+      {
+          for (auto type: types) {
+              addConditionByType(type, h, builder);
+          }
+      }
+
+      void addConditions(ZDDHelper &h, ZDDFormulaBuilder &builder, const std::set<ConditionTypes>& types)
       {
           for (auto type: types) {
               addConditionByType(type, h, builder);
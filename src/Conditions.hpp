@@ -2,9 +2,18 @@
 #include "bdd.h"
 #include "BDDHelper.hpp"
 #include "BDDFormulaBuilder.hpp"
+#include "MDDHelper.hpp"
+#include "ZDDHelper.hpp"
+#include "DiagramFormulaBuilder.hpp"
 
 using namespace bddHelper;
 namespace conditions
 {
   void addConditions(bddHelper::BDDHelper &h, BDDFormulaBuilder &builder, const std::set<ConditionTypes>& types);
+
+  // Same conditions on the MDD and ZDD backends, UPPER_BOUND adds nothing
+  // there.
+  void addConditions(bddHelper::MDDHelper &h, MDDFormulaBuilder &builder, const std::set<ConditionTypes>& types);
+
+  void addConditions(bddHelper::ZDDHelper &h, ZDDFormulaBuilder &builder, const std::set<ConditionTypes>& types);
 }
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef DIAGRAM_FORMULA_BUILDER_HPP
+#define DIAGRAM_FORMULA_BUILDER_HPP
+
+#include <mutex>
+#include "MDD.hpp"
+#include "ZDD.hpp"
+
+// BDDFormulaBuilder for the MDD and ZDD backends. Starts from the true
+// formula of the backend, which for ZDDs is the domain and not a constant.
+template < class Diagram_t >
+class DiagramFormulaBuilder
+{
+public:
+  explicit DiagramFormulaBuilder(Diagram_t trueFormula) :
+    formula_(trueFormula)
+  {}
+
+  void addCondition(const Diagram_t &formula)
+  {
+    formula_ &= formula;
+  }
+
+  // The MDD and ZDD managers take one lock per operation anyway, so the
+  // threads share the formula.
+  void addConditionPartial(const Diagram_t &formula)
+  {
+    std::unique_lock lock(mut_);
+    addCondition(formula);
+  }
+
+  void mergePartials() {}
+
+  Diagram_t result()
+  {
+    return formula_;
+  }
+
+private:
+  Diagram_t formula_;
+  std::mutex mut_;
+};
+
+using MDDFormulaBuilder = DiagramFormulaBuilder< mdd::Mdd >;
+using ZDDFormulaBuilder = DiagramFormulaBuilder< zdd::Zdd >;
+
+#endif
@@ -0,0 +1,254 @@
+#include "MDD.hpp"
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace mdd
+{
+  Mdd Mdd::operator&(const Mdd &rhs) const
+  {
+    return manager_->wrap(manager_->apply(Manager::AND, id_, rhs.id_));
+  }
+
+  Mdd Mdd::operator|(const Mdd &rhs) const
+  {
+    return manager_->wrap(manager_->apply(Manager::OR, id_, rhs.id_));
+  }
+
+  Mdd Mdd::operator^(const Mdd &rhs) const
+  {
+    return manager_->wrap(manager_->apply(Manager::XOR, id_, rhs.id_));
+  }
+
+  Mdd Mdd::operator!() const
+  {
+    return manager_->wrap(manager_->apply(Manager::NOT, id_, 0));
+  }
+
+  Mdd &Mdd::operator&=(const Mdd &rhs)
+  {
+    return *this = *this & rhs;
+  }
+
+  Mdd &Mdd::operator|=(const Mdd &rhs)
+  {
+    return *this = *this | rhs;
+  }
+
+  Manager::Manager(std::vector< int > arities, int cacheSize) :
+    arity_(std::move(arities)),
+    spaceBelow_(arity_.size() + 1, 1.0),
+    buckets_(1024, -1),
+    cache_(cacheSize)
+  {
+    for (int var = varNum() - 1; var >= 0; --var)
+    {
+      assert(arity_[var] >= 2);
+      spaceBelow_[var] = spaceBelow_[var + 1] * arity_[var];
+    }
+    // The terminals come first so that their ids are FALSE_ID and TRUE_ID.
+    nodes_.push_back({varNum(), 0, -1});
+    nodes_.push_back({varNum(), 0, -1});
+  }
+
+  Mdd Manager::value(int var, int val)
+  {
+    assert(var >= 0 && var < varNum() && val >= 0 && val < arity_[var]);
+    std::unique_lock lock(mut_);
+    auto base = static_cast< int >(stack_.size());
+    for (int v = 0; v < arity_[var]; ++v)
+      stack_.push_back(v == val ? TRUE_ID : FALSE_ID);
+    return wrap(make(var, base));
+  }
+
+  int Manager::apply(Op op, int a, int b)
+  {
+    std::unique_lock lock(mut_);
+    return op == NOT ? negateRec(a) : applyRec(op, a, b);
+  }
+
+  int Manager::applyRec(Op op, int a, int b)
+  {
+    switch (op)
+    {
+      case AND:
+        if (a == FALSE_ID || b == FALSE_ID)
+          return FALSE_ID;
+        if (a == TRUE_ID || a == b)
+          return b;
+        if (b == TRUE_ID)
+          return a;
+        break;
+      case OR:
+        if (a == TRUE_ID || b == TRUE_ID)
+          return TRUE_ID;
+        if (a == FALSE_ID || a == b)
+          return b;
+        if (b == FALSE_ID)
+          return a;
+        break;
+      case XOR:
+        if (a == b)
+          return FALSE_ID;
+        if (a == FALSE_ID)
+          return b;
+        if (b == FALSE_ID)
+          return a;
+        if (a == TRUE_ID)
+          return negateRec(b);
+        if (b == TRUE_ID)
+          return negateRec(a);
+        break;
+      case NOT:
+        assert(false);
+    }
+    if (a > b)
+      std::swap(a, b);
+
+    auto &slot = cache_[(static_cast< unsigned >(a) * 12582917u + static_cast< unsigned >(b) * 4256249u + op) % cache_.size()];
+    if (slot.op == op && slot.a == a && slot.b == b)
+      return slot.res;
+
+    int var = std::min(nodes_[a].var, nodes_[b].var);
+    auto base = static_cast< int >(stack_.size());
+    for (int val = 0; val < arity_[var]; ++val)
+    {
+      int ca = nodes_[a].var == var ? child(a, val) : a;
+      int cb = nodes_[b].var == var ? child(b, val) : b;
+      int res = applyRec(op, ca, cb);
+      stack_.push_back(res);
+    }
+    int res = make(var, base);
+    slot = {op, a, b, res};
+    return res;
+  }
+
+  int Manager::negateRec(int a)
+  {
+    if (a == FALSE_ID || a == TRUE_ID)
+      return a ^ 1;
+
+    auto &slot = cache_[(static_cast< unsigned >(a) * 12582917u + NOT) % cache_.size()];
+    if (slot.op == NOT && slot.a == a)
+      return slot.res;
+
+    int var = nodes_[a].var;
+    auto base = static_cast< int >(stack_.size());
+    for (int val = 0; val < arity_[var]; ++val)
+    {
+      int res = negateRec(child(a, val));
+      stack_.push_back(res);
+    }
+    int res = make(var, base);
+    slot = {NOT, a, 0, res};
+    return res;
+  }
+
+  unsigned Manager::hash(int var, const int *children) const
+  {
+    unsigned h = static_cast< unsigned >(var) * 2654435761u;
+    for (int val = 0; val < arity_[var]; ++val)
+      h = (h ^ static_cast< unsigned >(children[val])) * 16777619u;
+    return h;
+  }
+
+  int Manager::make(int var, int base)
+  {
+    const int *children = stack_.data() + base;
+    int n = arity_[var];
+    bool redundant = true;
+    for (int val = 1; val < n; ++val)
+      redundant = redundant && children[val] == children[0];
+    if (redundant)
+    {
+      int res = children[0];
+      stack_.resize(base);
+      return res;
+    }
+
+    auto bucket = hash(var, children) & (buckets_.size() - 1);
+    for (int id = buckets_[bucket]; id >= 0; id = nodes_[id].next)
+      if (nodes_[id].var == var && std::equal(children, children + n, pool_.begin() + nodes_[id].first))
+      {
+        stack_.resize(base);
+        return id;
+      }
+
+    auto id = static_cast< int >(nodes_.size());
+    nodes_.push_back({var, static_cast< int >(pool_.size()), buckets_[bucket]});
+    pool_.insert(pool_.end(), children, children + n);
+    buckets_[bucket] = id;
+    stack_.resize(base);
+    if (nodes_.size() > buckets_.size())
+      rehash();
+    return id;
+  }
+
+  void Manager::rehash()
+  {
+    buckets_.assign(buckets_.size() * 2, -1);
+    for (int id = TRUE_ID + 1; id < static_cast< int >(nodes_.size()); ++id)
+    {
+      auto bucket = hash(nodes_[id].var, pool_.data() + nodes_[id].first) & (buckets_.size() - 1);
+      nodes_[id].next = buckets_[bucket];
+      buckets_[bucket] = id;
+    }
+  }
+
+  int Manager::nodeCount(const Mdd &f) const
+  {
+    std::unordered_set< int > seen;
+    std::function< void(int) > visit = [&](int id) {
+      if (id <= TRUE_ID || !seen.insert(id).second)
+        return;
+      for (int val = 0; val < arity_[nodes_[id].var]; ++val)
+        visit(child(id, val));
+    };
+    visit(f.id());
+    return static_cast< int >(seen.size());
+  }
+
+  double Manager::satCount(const Mdd &f) const
+  {
+    // Assignments to the variables from the one of id on.
+    std::unordered_map< int, double > memo;
+    std::function< double(int) > count = [&](int id) -> double {
+      if (id <= TRUE_ID)
+        return id;
+      if (auto it = memo.find(id); it != memo.end())
+        return it->second;
+      int var = nodes_[id].var;
+      double res = 0;
+      for (int val = 0; val < arity_[var]; ++val)
+      {
+        int c = child(id, val);
+        res += count(c) * spaceBelow_[var + 1] / spaceBelow_[nodes_[c].var];
+      }
+      memo[id] = res;
+      return res;
+    };
+    return count(f.id()) * spaceBelow_[0] / spaceBelow_[nodes_[f.id()].var];
+  }
+
+  std::optional< std::vector< int > > Manager::anySat(const Mdd &f) const
+  {
+    if (f.id() == FALSE_ID)
+      return std::nullopt;
+    // Variables skipped on the path may take any value, 0 is as good as
+    // any other.
+    std::vector< int > values(varNum(), 0);
+    for (int id = f.id(); id != TRUE_ID;)
+    {
+      int var = nodes_[id].var;
+      int val = 0;
+      while (child(id, val) == FALSE_ID)
+        ++val;
+      values[var] = val;
+      id = child(id, val);
+    }
+    return values;
+  }
+}
@@ -0,0 +1,128 @@
+#ifndef MDD_HPP
+#define MDD_HPP
+
+#include <mutex>
+#include <optional>
+#include <vector>
+
+// Multi-valued decision diagrams: every variable takes one of arity(var)
+// values and a node has exactly that many children, stored side by side.
+// Variables are tested in index order. Nodes live as long as their manager,
+// there is no garbage collection.
+namespace mdd
+{
+  class Manager;
+
+  // Handle of a diagram, cheap to copy. Operators lock the manager, so
+  // handles can be combined from several threads.
+  class Mdd
+  {
+  public:
+    Mdd() = default;
+
+    Mdd operator&(const Mdd &rhs) const;
+    Mdd operator|(const Mdd &rhs) const;
+    Mdd operator^(const Mdd &rhs) const;
+    Mdd operator!() const;
+    Mdd &operator&=(const Mdd &rhs);
+    Mdd &operator|=(const Mdd &rhs);
+
+    bool operator==(const Mdd &rhs) const = default;
+
+    int id() const { return id_; }
+
+  private:
+    friend class Manager;
+
+    Mdd(Manager *manager, int id) : manager_(manager), id_(id) {}
+
+    Manager *manager_ = nullptr;
+    int id_ = 0;
+  };
+
+  class Manager
+  {
+  public:
+    explicit Manager(std::vector< int > arities, int cacheSize = 1 << 18);
+
+    Manager(const Manager &) = delete;
+    Manager &operator=(const Manager &) = delete;
+
+    int varNum() const { return static_cast< int >(arity_.size()); }
+
+    int arity(int var) const { return arity_[var]; }
+
+    Mdd zero() { return {this, FALSE_ID}; }
+
+    Mdd one() { return {this, TRUE_ID}; }
+
+    // var == val
+    Mdd value(int var, int val);
+
+    // Nodes reachable from f, terminals excluded.
+    int nodeCount(const Mdd &f) const;
+
+    // Nodes built so far, terminals included.
+    int allocated() const { return static_cast< int >(nodes_.size()); }
+
+    // Number of assignments to all variables that satisfy f.
+    double satCount(const Mdd &f) const;
+
+    // One satisfying assignment, a value per variable; empty if f is false.
+    std::optional< std::vector< int > > anySat(const Mdd &f) const;
+
+  private:
+    friend class Mdd;
+
+    static constexpr int FALSE_ID = 0;
+    static constexpr int TRUE_ID = 1;
+
+    enum Op
+    {
+      AND,
+      OR,
+      XOR,
+      NOT
+    };
+
+    struct Node
+    {
+      int var;   // varNum() for the terminals
+      int first; // first child in pool_
+      int next;  // next node in the same unique table chain
+    };
+
+    struct CacheEntry
+    {
+      int op = -1;
+      int a = 0;
+      int b = 0;
+      int res = 0;
+    };
+
+    Mdd wrap(int id) { return {this, id}; }
+
+    int apply(Op op, int a, int b);
+    int applyRec(Op op, int a, int b);
+    int negateRec(int a);
+
+    // Node testing var with the children on top of stack_ from base on.
+    int make(int var, int base);
+
+    unsigned hash(int var, const int *children) const;
+    void rehash();
+
+    int child(int node, int val) const { return pool_[nodes_[node].first + val]; }
+
+    std::vector< int > arity_;
+    std::vector< double > spaceBelow_; // product of the arities of vars >= index
+    std::vector< Node > nodes_;
+    std::vector< int > pool_;
+    std::vector< int > buckets_;
+    std::vector< CacheEntry > cache_;
+    std::vector< int > stack_;
+    std::mutex mut_;
+  };
+}
+
+#endif
@@ -0,0 +1,47 @@
+#include "MDDHelper.hpp"
+#include <ranges>
+
+namespace bddHelper
+{
+  std::vector< int > MDDHelper::arities()
+  {
+    return vect< int >(nTotalVars, nVals);
+  }
+
+  MDDHelper::MDDHelper(mdd::Manager &manager) :
+    manager_(manager)
+  {
+    assert(manager.varNum() == nTotalVars);
+    values_ = vect< vect< vect< mdd::Mdd > > >(nObjs);
+    for (auto objNum : std::views::iota(0, nObjs))
+    {
+      values_[objNum] = vect< vect< mdd::Mdd > >(nProps);
+      for (auto propNum : std::views::iota(0, nProps))
+        for (auto valNum : std::views::iota(0, nVals))
+          values_[objNum][propNum].push_back(manager.value(var(objNum, propNum), valNum));
+    }
+  }
+
+  mdd::Mdd MDDHelper::differ(Object obj1, Object obj2, Property prop) const
+  {
+    auto objNum1 = toNum(obj1);
+    auto objNum2 = toNum(obj2);
+    auto propNum = toNum(prop);
+    auto same = manager_.zero();
+    for (auto valNum : std::views::iota(0, nVals))
+      same |= values_[objNum1][propNum][valNum] & values_[objNum2][propNum][valNum];
+    return !same;
+  }
+
+  std::optional< std::vector< std::vector< int > > > MDDHelper::anySolution(const mdd::Mdd &f) const
+  {
+    auto values = manager_.anySat(f);
+    if (!values)
+      return std::nullopt;
+    auto solution = vect< vect< int > >(nObjs, vect< int >(nProps));
+    for (auto objNum : std::views::iota(0, nObjs))
+      for (auto propNum : std::views::iota(0, nProps))
+        solution[objNum][propNum] = (*values)[var(objNum, propNum)];
+    return solution;
+  }
+}
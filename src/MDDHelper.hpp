@@ -0,0 +1,63 @@
+#ifndef MDD_HELPER_HPP
+#define MDD_HELPER_HPP
+
+#include <optional>
+#include <vector>
+#include "BDDHelper.hpp"
+#include "MDD.hpp"
+
+namespace bddHelper
+{
+  // BDDHelper for the MDD backend: every object/property pair is one
+  // variable with nVals values, so there are no value bits and no codes
+  // outside the enums.
+  class MDDHelper
+  {
+  public:
+    template < class T > using vect = std::vector< T >;
+
+    static constexpr int nObjs = BDDHelper::nObjs;
+    static constexpr int nProps = BDDHelper::nProps;
+    static constexpr int nVals = BDDHelper::nVals;
+    static constexpr int nTotalVars = nObjs * nProps;
+
+    // Arities of the variables of a manager for the puzzle.
+    static vect< int > arities();
+
+    static int var(int objNum, int propNum) { return objNum * nProps + propNum; }
+
+    explicit MDDHelper(mdd::Manager &manager);
+
+    // Same as BDDHelper::getObjectVal
+    template < class V_t >
+    const mdd::Mdd &getObjectVal(Object obj, V_t value) const;
+
+    // obj1 and obj2 have different values of prop.
+    mdd::Mdd differ(Object obj1, Object obj2, Property prop) const;
+
+    mdd::Mdd falseFormula() const { return manager_.zero(); }
+
+    mdd::Mdd trueFormula() const { return manager_.one(); }
+
+    // Value of every property of every object in one solution of f.
+    std::optional< vect< vect< int > > > anySolution(const mdd::Mdd &f) const;
+
+    mdd::Manager &manager() const { return manager_; }
+
+  private:
+    mdd::Manager &manager_;
+    vect< vect< vect< mdd::Mdd > > > values_;
+  };
+
+  template < class V_t >
+  inline const mdd::Mdd &MDDHelper::getObjectVal(Object obj, V_t value) const
+  {
+    static_assert(traits_::IsValueType_v< V_t >, "Value must be one of properties type");
+    auto objNum = toNum(obj);
+    auto propNum = toNum(traits_::PropertyFromValueEnum_v< V_t >);
+    auto valNum = toNum(value);
+    return values_[objNum][propNum][valNum];
+  }
+}
+
+#endif
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include "bdd.h"
+#include "OrderCache.hpp"
+
+namespace orderCache
+{
+  std::string shapeKey(std::string_view orderName, const std::set< bddHelper::ConditionTypes > &types, config &cfg)
+  {
+    using bddHelper::BDDHelper;
+    std::ostringstream key;
+    key << BDDHelper::nObjs << 'x' << BDDHelper::nProps << 'x' << BDDHelper::nValueBits
+        << '/' << orderName << "/t";
+    for (auto type : types)
+      key << static_cast< int >(type);
+    key << "/c" << cfg.getFirstCondition().size()
+        << '.' << cfg.getSecondConditionWithOwns().size()
+        << '.' << cfg.getSecondConditionWithTransport().size()
+        << '.' << cfg.getSecondConditionWithColor().size()
+        << '.' << cfg.getThirdCondition().size()
+        << '.' << cfg.getForthCondition().size() << "/n";
+    for (auto offset : cfg.getLeftNeighbourXyOffset())
+      key << offset << '.';
+    for (auto offset : cfg.getRightNeighbourXyOffset())
+      key << offset << '.';
+    key << "w" << cfg.isVertSkleika() << cfg.isHorSkleika();
+    return key.str();
+  }
+
+  std::vector< int > load(const std::string &file, const std::string &key, int nVars)
+  {
+    std::ifstream in(file);
+    std::string line;
+    while (std::getline(in, line))
+    {
+      std::istringstream fields(line);
+      std::string lineKey;
+      if (!(fields >> lineKey) || lineKey != key)
+        continue;
+      std::vector< int > levelOrder;
+      for (int var; fields >> var;)
+        levelOrder.push_back(var);
+      // Anything but a permutation of the variables is ignored.
+      auto sorted = levelOrder;
+      std::ranges::sort(sorted);
+      if (static_cast< int >(sorted.size()) != nVars)
+        return {};
+      for (int i = 0; i < nVars; ++i)
+        if (sorted[i] != i)
+          return {};
+      return levelOrder;
+    }
+    return {};
+  }
+
+  bool save(const std::string &file, const std::string &key)
+  {
+    std::vector< std::string > lines;
+    {
+      std::ifstream in(file);
+      std::string line;
+      while (std::getline(in, line))
+        if (!line.starts_with(key + ' '))
+          lines.push_back(line);
+    }
+    std::ostringstream entry;
+    entry << key;
+    for (int level = 0; level < bdd_varnum(); ++level)
+      entry << ' ' << bdd_level2var(level);
+    lines.push_back(entry.str());
+
+    std::ofstream out(file, std::ios::trunc);
+    for (const auto &line : lines)
+      out << line << '\n';
+    return static_cast< bool >(out);
+  }
+
+  bool reordered()
+  {
+    for (int level = 0; level < bdd_varnum(); ++level)
+      if (bdd_level2var(level) != level)
+        return true;
+    return false;
+  }
+
+  bool respectsBlocks(const std::vector< int > &levelOrder, const std::vector< varOrder::Block > &blocks)
+  {
+    std::vector< int > levelOf(levelOrder.size());
+    for (int level = 0; level < static_cast< int >(levelOrder.size()); ++level)
+      levelOf[levelOrder[level]] = level;
+    for (const auto &block : blocks)
+    {
+      auto levels = std::ranges::subrange(levelOf.begin() + block.first, levelOf.begin() + block.last + 1);
+      auto [lo, hi] = std::ranges::minmax(levels);
+      if (hi - lo != block.last - block.first)
+        return false;
+    }
+    return true;
+  }
+}
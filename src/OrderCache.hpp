@@ -0,0 +1,38 @@
+#ifndef ORDER_CACHE_HPP
+#define ORDER_CACHE_HPP
+
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "BDDHelper.hpp"
+#include "VarOrder.hpp"
+#include "config.h"
+
+// Variable orders found by reordering, saved in a text file with one line
+// per puzzle shape: the key, then the variable at each level.
+namespace orderCache
+{
+  // Key of a puzzle shape: the sizes, the static order, the condition types
+  // and the number of constraints of each kind, but not their values, so
+  // puzzles of one family share an entry.
+  std::string shapeKey(std::string_view orderName, const std::set< bddHelper::ConditionTypes > &types, config &cfg);
+
+  // Level order saved for key (variable at each level), empty when there
+  // is none or it is not a permutation of nVars variables.
+  std::vector< int > load(const std::string &file, const std::string &key, int nVars);
+
+  // Saves the current order of all BDD variables for key, replacing an
+  // older entry. Returns false if the file could not be written.
+  bool save(const std::string &file, const std::string &key);
+
+  // Whether some variable is no longer at the level of its index, where
+  // every variable starts; only such an order is worth saving.
+  bool reordered();
+
+  // Whether the variables of every block are on adjacent levels, which
+  // bdd_setvarorder needs to keep the blocks.
+  bool respectsBlocks(const std::vector< int > &levelOrder, const std::vector< varOrder::Block > &blocks);
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef PUZZLE_HPP
+#define PUZZLE_HPP
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace puzzle
+{
+  // Calls f(std::integral_constant< int, i >{}) for i from 0 to n - 1, one
+  // call per i, so f can use i in constant expressions.
+  template < int n, class F >
+  constexpr void unrolled(F &&f)
+  {
+    [&f]< int ... is >(std::integer_sequence< int, is... >) {
+      (f(std::integral_constant< int, is >{}), ...);
+    }(std::make_integer_sequence< int, n >{});
+  }
+
+  // Shape of a puzzle: W x H objects on a grid, numbered row by row, each
+  // with Props properties of Vals values. Everything the conditions look
+  // up that only depends on the shape is computed here at compile time.
+  template < int W, int H, int Props, int Vals >
+  struct Puzzle
+  {
+    static constexpr int width = W;
+    static constexpr int height = H;
+    static constexpr int nObjs = W * H;
+    static constexpr int nProps = Props;
+    static constexpr int nVals = Vals;
+    static constexpr int nValueBits = std::bit_width(static_cast< unsigned >(Vals - 1));
+    static constexpr int nCodes = 1 << nValueBits; // values the bits can hold, nVals and up are invalid
+
+    static_assert(nObjs <= 64, "Neighbour masks have one bit per object");
+    using Mask = std::conditional_t< nObjs <= 16, std::uint16_t,
+                                     std::conditional_t< nObjs <= 32, std::uint32_t, std::uint64_t > >;
+    // Per object, a mask of objects.
+    using Masks = std::array< Mask, nObjs >;
+
+    static constexpr int column(int obj) { return obj % W; }
+    static constexpr int row(int obj) { return obj / W; }
+
+    // Index of [obj][prop] in tables with one entry per object property;
+    // times nValueBits or nVals for the tables of BDDHelper.
+    static constexpr int slot(int obj, int prop) { return obj * Props + prop; }
+
+    // valueBits[code][bit] is bit of code, the most significant one first
+    // as in BDDHelper::numToBin.
+    static constexpr auto valueBits = [] {
+      std::array< std::array< bool, nValueBits >, nCodes > res{};
+      for (int code = 0; code < nCodes; ++code)
+        for (int bit = 0; bit < nValueBits; ++bit)
+          res[code][bit] = (code >> (nValueBits - 1 - bit)) & 1;
+      return res;
+    }();
+
+    // Bit n of [obj] is set when object n is at offset (dx, dy) from obj.
+    // Off the grid there is no neighbour, unless the axis wraps around
+    // (the Skleika flags of the configuration).
+    static constexpr Masks neighbourMasks(int dx, int dy, bool wrapX, bool wrapY)
+    {
+      Masks res{};
+      for (int obj = 0; obj < nObjs; ++obj)
+      {
+        int x = column(obj) + dx;
+        int y = row(obj) + dy;
+        if ((!wrapX && (x < 0 || x >= W)) || (!wrapY && (y < 0 || y >= H)))
+          continue;
+        x = (x % W + W) % W;
+        y = (y % H + H) % H;
+        res[obj] = static_cast< Mask >(Mask{1} << (x + y * W));
+      }
+      return res;
+    }
+
+    // neighbourMasks of every offset less than a grid away, which are all
+    // the offsets that give a neighbour without wrapping.
+    static constexpr auto neighbourTable = [] {
+      std::array< std::array< std::array< Masks, 2 * H - 1 >, 2 * W - 1 >, 4 > res{};
+      for (int wrap = 0; wrap < 4; ++wrap)
+        for (int dx = 1 - W; dx < W; ++dx)
+          for (int dy = 1 - H; dy < H; ++dy)
+            res[wrap][dx + W - 1][dy + H - 1] = neighbourMasks(dx, dy, wrap & 1, wrap & 2);
+      return res;
+    }();
+
+    // The entry of neighbourTable, nothing for a larger offset, whose
+    // masks neighbourMasks computes at runtime.
+    static constexpr std::optional< Masks > tabledNeighbours(int dx, int dy, bool wrapX, bool wrapY)
+    {
+      if (dx <= -W || dx >= W || dy <= -H || dy >= H)
+        return std::nullopt;
+      return neighbourTable[(wrapX ? 1 : 0) | (wrapY ? 2 : 0)][dx + W - 1][dy + H - 1];
+    }
+  };
+
+  // The shape of the puzzle in main.cpp.
+  using Shape = Puzzle< 3, 3, 4, 9 >;
+
+  static_assert(Shape::nValueBits == 4);
+  static_assert(Shape::valueBits[5] == std::array{false, true, false, true});
+  // Left neighbours in the 3 x 3 grid: none in the first column unless it
+  // wraps, then the last one of the row.
+  static_assert(Shape::neighbourTable[0][1][2][3] == 0 && Shape::neighbourTable[0][1][2][4] == 1u << 3);
+  static_assert(Shape::neighbourTable[1][1][2][3] == 1u << 5);
+  static_assert(Shape::neighbourMasks(-1, -1, true, true)[0] == 1u << 8);
+  static_assert(Shape::neighbourMasks(4, 3, true, true)[0] == 1u << 1);
+  static_assert(Shape::neighbourMasks(1, 0, false, true)[2] == 0);
+}
+
+#endif
@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <ranges>
+#include "VarOrder.hpp"
+
+namespace varOrder
+{
+  namespace
+  {
+    constexpr std::pair< std::string_view, Strategy > strategyNames[] = {
+      {"object", Strategy::OBJECT_MAJOR},
+      {"property", Strategy::PROPERTY_MAJOR},
+      {"interleaved", Strategy::INTERLEAVED},
+      {"heuristic", Strategy::HEURISTIC} };
+
+    constexpr int nGroups = VarOrder::nObjs * VarOrder::nProps;
+  }
+
+  std::optional< Strategy > parse(std::string_view name)
+  {
+    for (auto [strategyName, strategy] : strategyNames)
+      if (strategyName == name)
+        return strategy;
+    return std::nullopt;
+  }
+
+  std::string_view name(Strategy strategy)
+  {
+    for (auto [strategyName, s] : strategyNames)
+      if (s == strategy)
+        return strategyName;
+    return {};
+  }
+
+  VarOrder::VarOrder(Strategy strategy) :
+    strategy_(strategy)
+  {
+    // HEURISTIC starts from object-major, heuristic() moves the groups.
+    for (auto obj : std::views::iota(0, nObjs))
+      for (auto prop : std::views::iota(0, nProps))
+        for (auto bit : std::views::iota(0, nValueBits))
+        {
+          int var = 0;
+          switch (strategy)
+          {
+            case Strategy::OBJECT_MAJOR:
+            case Strategy::HEURISTIC:
+              var = (obj * nProps + prop) * nValueBits + bit;
+              break;
+            case Strategy::PROPERTY_MAJOR:
+              var = (prop * nObjs + obj) * nValueBits + bit;
+              break;
+            case Strategy::INTERLEAVED:
+              var = (prop * nValueBits + bit) * nObjs + obj;
+              break;
+          }
+          assign(obj, prop, bit, var);
+        }
+  }
+
+  VarOrder VarOrder::heuristic(const Collect &collect)
+  {
+    auto size = [](const vect< bdd > &conditions) {
+      long nodes = 0;
+      for (const auto &condition : conditions)
+        nodes += bdd_nodecount(condition);
+      return nodes;
+    };
+
+    VarOrder probe(Strategy::OBJECT_MAJOR);
+    auto probeConditions = collect(probe);
+    VarOrder best = supportGraph(probe, probeConditions);
+    long bestSize = size(collect(best));
+    for (auto strategy : {Strategy::OBJECT_MAJOR, Strategy::PROPERTY_MAJOR, Strategy::INTERLEAVED})
+    {
+      VarOrder candidate(strategy);
+      long candidateSize = size(strategy == Strategy::OBJECT_MAJOR ? probeConditions : collect(candidate));
+      if (candidateSize < bestSize)
+      {
+        best = candidate;
+        bestSize = candidateSize;
+      }
+    }
+    best.strategy_ = Strategy::HEURISTIC;
+    return best;
+  }
+
+  VarOrder VarOrder::supportGraph(const VarOrder &probe, const vect< bdd > &conditions)
+  {
+    // Weight of a pair of value groups: the number of conditions whose
+    // support contains both.
+    std::array< std::array< int, nGroups >, nGroups > weight{};
+    for (const auto &condition : conditions)
+    {
+      int *vars = nullptr;
+      int nVars = 0;
+      if (bdd_scanset(bdd_support(condition), vars, nVars) < 0)
+        continue;
+      std::array< bool, nGroups > used{};
+      for (auto i : std::views::iota(0, nVars))
+      {
+        const auto &s = probe.slot(vars[i]);
+        used[s.obj * nProps + s.prop] = true;
+      }
+      free(vars);
+      for (auto g1 : std::views::iota(0, nGroups))
+        for (auto g2 : std::views::iota(g1 + 1, nGroups))
+          if (used[g1] && used[g2])
+          {
+            ++weight[g1][g2];
+            ++weight[g2][g1];
+          }
+    }
+
+    // Greedy placement: start with the group tied most strongly to all
+    // others, then always append the group tied most strongly to the
+    // ones already placed. Ties keep object-major order.
+    std::array< int, nGroups > placedWeight{};
+    std::array< bool, nGroups > placed{};
+    for (auto g : std::views::iota(0, nGroups))
+      for (auto other : std::views::iota(0, nGroups))
+        placedWeight[g] += weight[g][other];
+    auto first = std::ranges::max_element(placedWeight) - placedWeight.begin();
+    placedWeight.fill(0);
+
+    VarOrder order(Strategy::HEURISTIC);
+    for (auto pos : std::views::iota(0, nGroups))
+    {
+      int best = pos == 0 ? static_cast< int >(first) : -1;
+      for (auto g : std::views::iota(0, nGroups))
+        if (pos > 0 && !placed[g] && (best < 0 || placedWeight[g] > placedWeight[best]))
+          best = g;
+      placed[best] = true;
+      for (auto g : std::views::iota(0, nGroups))
+        placedWeight[g] += weight[best][g];
+      for (auto bit : std::views::iota(0, nValueBits))
+        order.assign(best / nProps, best % nProps, bit, pos * nValueBits + bit);
+    }
+    return order;
+  }
+
+  vect< vect< vect< bdd > > > VarOrder::structedVars() const
+  {
+    auto structedVars = vect< vect< vect< bdd > > >(nObjs);
+    for (auto obj : std::views::iota(0, nObjs))
+    {
+      structedVars[obj] = vect< vect< bdd > >(nProps);
+      for (auto prop : std::views::iota(0, nProps))
+        for (auto bit : std::views::iota(0, nValueBits))
+          structedVars[obj][prop].push_back(bdd_ithvar(var(obj, prop, bit)));
+    }
+    return structedVars;
+  }
+
+  vect< Block > VarOrder::blocks() const
+  {
+    vect< Block > res;
+    bool valuesAdjacent = true;
+    for (auto obj : std::views::iota(0, nObjs))
+      for (auto prop : std::views::iota(0, nProps))
+      {
+        vect< Slot > value;
+        for (auto bit : std::views::iota(0, nValueBits))
+          value.push_back({obj, prop, bit});
+        valuesAdjacent = valuesAdjacent && adjacent(value);
+      }
+    if (valuesAdjacent)
+    {
+      for (int first = 0; first < nTotalVars; first += nValueBits)
+        res.push_back({first, first + nValueBits - 1, BDD_REORDER_FIXED});
+      return res;
+    }
+
+    // The bits of a value are spread out, so at most whole properties move.
+    for (auto prop : std::views::iota(0, nProps))
+    {
+      vect< Slot > property;
+      for (auto obj : std::views::iota(0, nObjs))
+        for (auto bit : std::views::iota(0, nValueBits))
+          property.push_back({obj, prop, bit});
+      if (!adjacent(property))
+        return {};
+      int first = nTotalVars;
+      for (const auto &s : property)
+        first = std::min(first, var(s.obj, s.prop, s.bit));
+      res.push_back({first, first + static_cast< int >(property.size()) - 1, BDD_REORDER_FREE});
+    }
+    return res;
+  }
+
+  vect< vect< std::pair< int, int > > > VarOrder::domainGroups() const
+  {
+    auto sorted = blocks();
+    std::ranges::sort(sorted, {}, &Block::first);
+    vect< vect< std::pair< int, int > > > res;
+    for (const auto &block : sorted)
+    {
+      auto &group = res.emplace_back();
+      for (auto var : std::views::iota(block.first, block.last + 1))
+      {
+        std::pair value{slots_[var].obj, slots_[var].prop};
+        if (std::ranges::find(group, value) == group.end())
+          group.push_back(value);
+      }
+    }
+    return res;
+  }
+
+  bool VarOrder::adjacent(const vect< Slot > &slots) const
+  {
+    auto vars = slots | std::views::transform([this](const Slot &s) { return var(s.obj, s.prop, s.bit); });
+    auto [lo, hi] = std::ranges::minmax(vars);
+    return hi - lo + 1 == static_cast< int >(slots.size());
+  }
+
+  void VarOrder::assign(int obj, int prop, int bit, int var)
+  {
+    assert(var >= 0 && var < nTotalVars);
+    vars_[slotIndex(obj, prop, bit)] = var;
+    slots_[var] = {obj, prop, bit};
+  }
+}
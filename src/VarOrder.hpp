@@ -0,0 +1,103 @@
+#ifndef VAR_ORDER_HPP
+#define VAR_ORDER_HPP
+
+#include <array>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "bdd.h"
+#include "BDDHelper.hpp"
+
+namespace varOrder
+{
+  template < class T > using vect = std::vector< T >;
+
+  enum class Strategy
+  {
+    OBJECT_MAJOR,   // all properties of object 0, then object 1, ...
+    PROPERTY_MAJOR, // one property of all objects, then the next property
+    INTERLEAVED,    // per property, bit 0 of every object, then bit 1, ...
+    HEURISTIC       // value groups placed by the supports of the conditions
+  };
+
+  std::optional< Strategy > parse(std::string_view name);
+
+  std::string_view name(Strategy strategy);
+
+  // Position of one variable in the puzzle: object, property and value bit.
+  struct Slot
+  {
+    int obj;
+    int prop;
+    int bit;
+  };
+
+  // Range of variable indices reordering should keep together.
+  struct Block
+  {
+    int first;
+    int last;
+    int fixed; // BDD_REORDER_FIXED or BDD_REORDER_FREE
+  };
+
+  // Mapping between puzzle slots and BDD variable indices. Variables start
+  // at the level of their index, so the mapping is the initial order.
+  class VarOrder
+  {
+  public:
+    static constexpr int nObjs = bddHelper::BDDHelper::nObjs;
+    static constexpr int nProps = bddHelper::BDDHelper::nProps;
+    static constexpr int nValueBits = bddHelper::BDDHelper::nValueBits;
+    static constexpr int nTotalVars = bddHelper::BDDHelper::nTotalVars;
+
+    // Builds the conditions of the puzzle with the variables of an order.
+    using Collect = std::function< vect< bdd >(const VarOrder &) >;
+
+    // HEURISTIC gives object-major here, see heuristic()
+    explicit VarOrder(Strategy strategy);
+
+    // Support-graph order: value groups that occur in the same conditions
+    // are placed close together. The result is compared with the fixed
+    // strategies by the total size of the conditions, and the smallest
+    // wins.
+    static VarOrder heuristic(const Collect &collect);
+
+    Strategy strategy() const { return strategy_; }
+
+    int var(int obj, int prop, int bit) const { return vars_[slotIndex(obj, prop, bit)]; }
+
+    const Slot &slot(int var) const { return slots_[var]; }
+
+    // Variables in the layout BDDHelper takes: [obj][prop][bit].
+    vect< vect< vect< bdd > > > structedVars() const;
+
+    // Blocks for bdd_intaddvarblock: a fixed block per value if the bits of
+    // every value are adjacent, else a free block per property if those
+    // are adjacent, else none.
+    vect< Block > blocks() const;
+
+    // (object, property) groups for the FDD encoding of BDDHelper, one per
+    // block in variable order, with the values in the order their first
+    // bit appears. The domains then take the variables of this order, up
+    // to the order of the bits within a value. Empty if there are no
+    // blocks.
+    vect< vect< std::pair< int, int > > > domainGroups() const;
+
+  private:
+    static int slotIndex(int obj, int prop, int bit) { return (obj * nProps + prop) * nValueBits + bit; }
+
+    void assign(int obj, int prop, int bit, int var);
+
+    // Whether the given slots occupy adjacent variables.
+    bool adjacent(const vect< Slot > &slots) const;
+
+    static VarOrder supportGraph(const VarOrder &probe, const vect< bdd > &conditions);
+
+    Strategy strategy_;
+    std::array< int, nTotalVars > vars_{};
+    std::array< Slot, nTotalVars > slots_{};
+  };
+}
+
+#endif
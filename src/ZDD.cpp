@@ -0,0 +1,217 @@
+#include "ZDD.hpp"
+#include <cassert>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace zdd
+{
+  Zdd Zdd::operator&(const Zdd &rhs) const
+  {
+    return manager_->wrap(manager_->apply(Manager::INTERSECT, id_, rhs.id_));
+  }
+
+  Zdd Zdd::operator|(const Zdd &rhs) const
+  {
+    return manager_->wrap(manager_->apply(Manager::UNION, id_, rhs.id_));
+  }
+
+  Zdd Zdd::operator-(const Zdd &rhs) const
+  {
+    return manager_->wrap(manager_->apply(Manager::DIFF, id_, rhs.id_));
+  }
+
+  Zdd &Zdd::operator&=(const Zdd &rhs)
+  {
+    return *this = *this & rhs;
+  }
+
+  Zdd &Zdd::operator|=(const Zdd &rhs)
+  {
+    return *this = *this | rhs;
+  }
+
+  Zdd &Zdd::operator-=(const Zdd &rhs)
+  {
+    return *this = *this - rhs;
+  }
+
+  Manager::Manager(int varNum, int cacheSize) :
+    varNum_(varNum),
+    buckets_(1024, -1),
+    cache_(cacheSize)
+  {
+    // The terminals come first so that their ids are EMPTY_ID and BASE_ID.
+    nodes_.push_back({varNum_, EMPTY_ID, EMPTY_ID, -1});
+    nodes_.push_back({varNum_, BASE_ID, BASE_ID, -1});
+  }
+
+  Zdd Manager::node(int var, const Zdd &lo, const Zdd &hi)
+  {
+    std::unique_lock lock(mut_);
+    assert(var >= 0 && var < nodes_[lo.id()].var && var < nodes_[hi.id()].var);
+    return wrap(make(var, lo.id(), hi.id()));
+  }
+
+  Zdd Manager::withVar(const Zdd &f, int var)
+  {
+    return wrap(apply(WITHVAR, f.id(), var));
+  }
+
+  int Manager::apply(Op op, int a, int b)
+  {
+    std::unique_lock lock(mut_);
+    return op == WITHVAR ? withVarRec(a, b) : applyRec(op, a, b);
+  }
+
+  Manager::CacheEntry &Manager::cacheSlot(Op op, int a, int b)
+  {
+    auto index = static_cast< unsigned >(a) * 12582917u + static_cast< unsigned >(b) * 4256249u + op;
+    return cache_[index % cache_.size()];
+  }
+
+  int Manager::applyRec(Op op, int a, int b)
+  {
+    switch (op)
+    {
+      case UNION:
+        if (a == EMPTY_ID || a == b)
+          return b;
+        if (b == EMPTY_ID)
+          return a;
+        if (a > b)
+          std::swap(a, b);
+        break;
+      case INTERSECT:
+        if (a == EMPTY_ID || b == EMPTY_ID)
+          return EMPTY_ID;
+        if (a == b)
+          return a;
+        if (a > b)
+          std::swap(a, b);
+        break;
+      case DIFF:
+        if (a == EMPTY_ID || a == b)
+          return EMPTY_ID;
+        if (b == EMPTY_ID)
+          return a;
+        break;
+      case WITHVAR:
+        assert(false);
+    }
+
+    auto &slot = cacheSlot(op, a, b);
+    if (slot.op == op && slot.a == a && slot.b == b)
+      return slot.res;
+
+    auto [va, aLo, aHi, aNext] = nodes_[a];
+    auto [vb, bLo, bHi, bNext] = nodes_[b];
+    int res;
+    if (va < vb)
+    {
+      // Sets with va are only in a.
+      int lo = applyRec(op, aLo, b);
+      res = op == INTERSECT ? lo : make(va, lo, aHi);
+    }
+    else if (va > vb)
+    {
+      int lo = applyRec(op, a, bLo);
+      res = op == UNION ? make(vb, lo, bHi) : lo;
+    }
+    else
+    {
+      int lo = applyRec(op, aLo, bLo);
+      int hi = applyRec(op, aHi, bHi);
+      res = make(va, lo, hi);
+    }
+    slot = {op, a, b, res};
+    return res;
+  }
+
+  int Manager::withVarRec(int f, int var)
+  {
+    auto [fv, lo, hi, next] = nodes_[f];
+    if (fv > var)
+      return EMPTY_ID;
+    if (fv == var)
+      return make(var, EMPTY_ID, hi);
+
+    auto &slot = cacheSlot(WITHVAR, f, var);
+    if (slot.op == WITHVAR && slot.a == f && slot.b == var)
+      return slot.res;
+    int resLo = withVarRec(lo, var);
+    int resHi = withVarRec(hi, var);
+    int res = make(fv, resLo, resHi);
+    slot = {WITHVAR, f, var, res};
+    return res;
+  }
+
+  int Manager::make(int var, int lo, int hi)
+  {
+    if (hi == EMPTY_ID)
+      return lo;
+
+    auto hash = [this](int var, int lo, int hi) {
+      auto h = (static_cast< unsigned >(var) * 2654435761u) ^ (static_cast< unsigned >(lo) * 40503u) ^ (static_cast< unsigned >(hi) * 16777619u);
+      return h & (buckets_.size() - 1);
+    };
+    auto bucket = hash(var, lo, hi);
+    for (int id = buckets_[bucket]; id >= 0; id = nodes_[id].next)
+      if (nodes_[id].var == var && nodes_[id].lo == lo && nodes_[id].hi == hi)
+        return id;
+
+    auto id = static_cast< int >(nodes_.size());
+    nodes_.push_back({var, lo, hi, buckets_[bucket]});
+    buckets_[bucket] = id;
+    if (nodes_.size() > buckets_.size())
+    {
+      buckets_.assign(buckets_.size() * 2, -1);
+      for (int n = BASE_ID + 1; n < static_cast< int >(nodes_.size()); ++n)
+      {
+        auto b = hash(nodes_[n].var, nodes_[n].lo, nodes_[n].hi);
+        nodes_[n].next = buckets_[b];
+        buckets_[b] = n;
+      }
+    }
+    return id;
+  }
+
+  int Manager::nodeCount(const Zdd &f) const
+  {
+    std::unordered_set< int > seen;
+    std::function< void(int) > visit = [&](int id) {
+      if (id <= BASE_ID || !seen.insert(id).second)
+        return;
+      visit(nodes_[id].lo);
+      visit(nodes_[id].hi);
+    };
+    visit(f.id());
+    return static_cast< int >(seen.size());
+  }
+
+  double Manager::satCount(const Zdd &f) const
+  {
+    std::unordered_map< int, double > memo;
+    std::function< double(int) > count = [&](int id) -> double {
+      if (id <= BASE_ID)
+        return id;
+      if (auto it = memo.find(id); it != memo.end())
+        return it->second;
+      double res = count(nodes_[id].lo) + count(nodes_[id].hi);
+      memo[id] = res;
+      return res;
+    };
+    return count(f.id());
+  }
+
+  std::vector< int > Manager::anySet(const Zdd &f) const
+  {
+    assert(f.id() != EMPTY_ID);
+    // The high child of a node is never empty, so it always leads to a set.
+    std::vector< int > vars;
+    for (int id = f.id(); id != BASE_ID; id = nodes_[id].hi)
+      vars.push_back(nodes_[id].var);
+    return vars;
+  }
+}
@@ -0,0 +1,125 @@
+#ifndef ZDD_HPP
+#define ZDD_HPP
+
+#include <mutex>
+#include <vector>
+
+// Zero-suppressed decision diagrams over families of sets of variables.
+// A node whose high child is the empty family is left out, so variables
+// that are absent from most sets cost nothing. Variables are tested in
+// index order. Nodes live as long as their manager, there is no garbage
+// collection.
+namespace zdd
+{
+  class Manager;
+
+  // Handle of a family, cheap to copy. Operators lock the manager, so
+  // handles can be combined from several threads.
+  class Zdd
+  {
+  public:
+    Zdd() = default;
+
+    Zdd operator&(const Zdd &rhs) const; // intersection
+    Zdd operator|(const Zdd &rhs) const; // union
+    Zdd operator-(const Zdd &rhs) const; // difference
+    Zdd &operator&=(const Zdd &rhs);
+    Zdd &operator|=(const Zdd &rhs);
+    Zdd &operator-=(const Zdd &rhs);
+
+    bool operator==(const Zdd &rhs) const = default;
+
+    int id() const { return id_; }
+
+  private:
+    friend class Manager;
+
+    Zdd(Manager *manager, int id) : manager_(manager), id_(id) {}
+
+    Manager *manager_ = nullptr;
+    int id_ = 0;
+  };
+
+  class Manager
+  {
+  public:
+    explicit Manager(int varNum, int cacheSize = 1 << 18);
+
+    Manager(const Manager &) = delete;
+    Manager &operator=(const Manager &) = delete;
+
+    int varNum() const { return varNum_; }
+
+    // The family with no sets.
+    Zdd empty() { return {this, EMPTY_ID}; }
+
+    // The family with only the empty set.
+    Zdd base() { return {this, BASE_ID}; }
+
+    // Sets of lo, and sets of hi with var added. var must come before the
+    // variables of lo and hi.
+    Zdd node(int var, const Zdd &lo, const Zdd &hi);
+
+    // Sets of f that contain var.
+    Zdd withVar(const Zdd &f, int var);
+
+    // Nodes reachable from f, terminals excluded.
+    int nodeCount(const Zdd &f) const;
+
+    // Nodes built so far, terminals included.
+    int allocated() const { return static_cast< int >(nodes_.size()); }
+
+    // Number of sets in f.
+    double satCount(const Zdd &f) const;
+
+    // Variables of one set of f, in increasing order; f must not be empty.
+    std::vector< int > anySet(const Zdd &f) const;
+
+  private:
+    friend class Zdd;
+
+    static constexpr int EMPTY_ID = 0;
+    static constexpr int BASE_ID = 1;
+
+    enum Op
+    {
+      UNION,
+      INTERSECT,
+      DIFF,
+      WITHVAR
+    };
+
+    struct Node
+    {
+      int var; // varNum() for the terminals
+      int lo;
+      int hi;
+      int next; // next node in the same unique table chain
+    };
+
+    struct CacheEntry
+    {
+      int op = -1;
+      int a = 0;
+      int b = 0;
+      int res = 0;
+    };
+
+    Zdd wrap(int id) { return {this, id}; }
+
+    int apply(Op op, int a, int b);
+    int applyRec(Op op, int a, int b);
+    int withVarRec(int f, int var);
+    int make(int var, int lo, int hi);
+
+    CacheEntry &cacheSlot(Op op, int a, int b);
+
+    int varNum_;
+    std::vector< Node > nodes_;
+    std::vector< int > buckets_;
+    std::vector< CacheEntry > cache_;
+    std::mutex mut_;
+  };
+}
+
+#endif
@@ -0,0 +1,52 @@
+#include "ZDDHelper.hpp"
+#include <ranges>
+
+namespace bddHelper
+{
+  ZDDHelper::ZDDHelper(zdd::Manager &manager) :
+    manager_(manager)
+  {
+    assert(manager.varNum() == nTotalVars);
+    // Built from the last object and property up. Within a property the
+    // node of value v holds the sets with v on its high edge and those with
+    // a later value on its low edge; the last value has no low sets.
+    domain_ = manager.base();
+    for (auto group : std::views::iota(0, nObjs * nProps) | std::views::reverse)
+    {
+      auto oneOf = manager.empty();
+      for (auto valNum : std::views::iota(0, nVals) | std::views::reverse)
+        oneOf = manager.node(group * nVals + valNum, oneOf, domain_);
+      domain_ = oneOf;
+    }
+
+    values_ = vect< vect< vect< zdd::Zdd > > >(nObjs);
+    for (auto objNum : std::views::iota(0, nObjs))
+    {
+      values_[objNum] = vect< vect< zdd::Zdd > >(nProps);
+      for (auto propNum : std::views::iota(0, nProps))
+        for (auto valNum : std::views::iota(0, nVals))
+          values_[objNum][propNum].push_back(manager.withVar(domain_, var(objNum, propNum, valNum)));
+    }
+  }
+
+  zdd::Zdd ZDDHelper::differ(Object obj1, Object obj2, Property prop) const
+  {
+    auto objNum1 = toNum(obj1);
+    auto objNum2 = toNum(obj2);
+    auto propNum = toNum(prop);
+    auto same = manager_.empty();
+    for (auto valNum : std::views::iota(0, nVals))
+      same |= manager_.withVar(values_[objNum1][propNum][valNum], var(objNum2, propNum, valNum));
+    return domain_ - same;
+  }
+
+  std::optional< std::vector< std::vector< int > > > ZDDHelper::anySolution(const zdd::Zdd &f) const
+  {
+    if (f == manager_.empty())
+      return std::nullopt;
+    auto solution = vect< vect< int > >(nObjs, vect< int >(nProps));
+    for (auto v : manager_.anySet(f))
+      solution[v / nVals / nProps][v / nVals % nProps] = v % nVals;
+    return solution;
+  }
+}
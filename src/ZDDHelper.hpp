@@ -0,0 +1,62 @@
+#ifndef ZDD_HELPER_HPP
+#define ZDD_HELPER_HPP
+
+#include <optional>
+#include <vector>
+#include "BDDHelper.hpp"
+#include "ZDD.hpp"
+
+namespace bddHelper
+{
+  // BDDHelper for the ZDD backend: one-hot encoding with a variable per
+  // object, property and value. Formulas are families of sets of true
+  // variables inside domain(), where every object has exactly one value
+  // per property, so "true" is the domain and not every set.
+  class ZDDHelper
+  {
+  public:
+    template < class T > using vect = std::vector< T >;
+
+    static constexpr int nObjs = BDDHelper::nObjs;
+    static constexpr int nProps = BDDHelper::nProps;
+    static constexpr int nVals = BDDHelper::nVals;
+    static constexpr int nTotalVars = nObjs * nProps * nVals;
+
+    static int var(int objNum, int propNum, int valNum) { return (objNum * nProps + propNum) * nVals + valNum; }
+
+    explicit ZDDHelper(zdd::Manager &manager);
+
+    // Same as BDDHelper::getObjectVal
+    template < class V_t >
+    const zdd::Zdd &getObjectVal(Object obj, V_t value) const;
+
+    // obj1 and obj2 have different values of prop.
+    zdd::Zdd differ(Object obj1, Object obj2, Property prop) const;
+
+    zdd::Zdd falseFormula() const { return manager_.empty(); }
+
+    zdd::Zdd trueFormula() const { return domain_; }
+
+    // Value of every property of every object in one solution of f.
+    std::optional< vect< vect< int > > > anySolution(const zdd::Zdd &f) const;
+
+    zdd::Manager &manager() const { return manager_; }
+
+  private:
+    zdd::Manager &manager_;
+    zdd::Zdd domain_;
+    vect< vect< vect< zdd::Zdd > > > values_;
+  };
+
+  template < class V_t >
+  inline const zdd::Zdd &ZDDHelper::getObjectVal(Object obj, V_t value) const
+  {
+    static_assert(traits_::IsValueType_v< V_t >, "Value must be one of properties type");
+    auto objNum = toNum(obj);
+    auto propNum = toNum(traits_::PropertyFromValueEnum_v< V_t >);
+    auto valNum = toNum(value);
+    return values_[objNum][propNum][valNum];
+  }
+}
+
+#endif
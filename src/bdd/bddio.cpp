@@ -0,0 +1,402 @@
+/*************************************************************************
+  FILE:  bddio.cpp
+  DESCR: File I/O routines for BDD package
+*************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_map>
+#include "kernel.h"
+
+static void bdd_printset_rec(FILE *, int, int *);
+static void bdd_fprintdot_rec(FILE*, BDD);
+static int  bdd_save_rec(FILE*, int);
+
+static bddfilehandler filehandler;
+
+
+bddfilehandler bdd_file_hook(bddfilehandler handler)
+{
+   bddfilehandler old = filehandler;
+   filehandler = handler;
+   return old;
+}
+
+
+/*************************************************************************
+  Table printing
+*************************************************************************/
+
+void bdd_printall(void)
+{
+   bdd_fprintall(stdout);
+}
+
+
+void bdd_fprintall(FILE *ofile)
+{
+   BDD_EXCLUSIVE;
+   int n;
+
+   for (n=1 ; n<bddnodesize ; n++)
+   {
+      BddNode *node = &bddnodes[n];
+
+      if (LOWp(node) != -1)
+      {
+         fprintf(ofile, "[%5d - %2d] ", EDGE(n), node->refcou);
+         if (filehandler)
+            filehandler(ofile, bddlevel2var[LEVELp(node)]);
+         else
+            fprintf(ofile, "%3d", bddlevel2var[LEVELp(node)]);
+
+         fprintf(ofile, ": %3d", LOWp(node));
+         fprintf(ofile, " %3d", HIGHp(node));
+         fprintf(ofile, "\n");
+      }
+   }
+}
+
+
+void bdd_printtable(BDD r)
+{
+   bdd_fprinttable(stdout, r);
+}
+
+
+static void bdd_fprinttable_rec(FILE *ofile, BDD r)
+{
+   BddNode *node;
+
+   if (r < 2)
+      return;
+
+   node = &bddnodes[NODE(r)];
+   if (LEVELp(node) & MARKON)
+      return;
+
+   LEVELp(node) |= MARKON;
+
+   fprintf(ofile, "[%5d] ", REGULAR(r));
+   if (filehandler)
+      filehandler(ofile, bddlevel2var[LEVELp(node) & MARKHIDE]);
+   else
+      fprintf(ofile, "%3d", bddlevel2var[LEVELp(node) & MARKHIDE]);
+   fprintf(ofile, ": %3d %3d\n", LOWp(node), HIGHp(node));
+
+   bdd_fprinttable_rec(ofile, LOWp(node));
+   bdd_fprinttable_rec(ofile, HIGHp(node));
+}
+
+
+void bdd_fprinttable(FILE *ofile, BDD r)
+{
+   BDD_EXCLUSIVE;
+   fprintf(ofile, "ROOT: %d\n", r);
+   if (r < 2)
+      return;
+
+   bdd_fprinttable_rec(ofile, r);
+   bdd_unmark(r);
+}
+
+
+/*************************************************************************
+  Set printing
+*************************************************************************/
+
+void bdd_printset(BDD r)
+{
+   bdd_fprintset(stdout, r);
+}
+
+
+void bdd_fprintset(FILE *ofile, BDD r)
+{
+   BDD_EXCLUSIVE;
+   int *set;
+
+   if (r < 2)
+   {
+      fprintf(ofile, "%s", r == 0 ? "F" : "T");
+      return;
+   }
+
+   if ((set=(int *)malloc(sizeof(int)*bddvarnum)) == NULL)
+   {
+      bdd_error(BDD_MEMORY);
+      return;
+   }
+
+   memset(set, 0, sizeof(int) * bddvarnum);
+   bdd_printset_rec(ofile, r, set);
+   free(set);
+}
+
+
+static void bdd_printset_rec(FILE *ofile, int r, int *set)
+{
+   int n;
+   int first;
+
+   if (r == 0)
+      return;
+   else
+   if (r == 1)
+   {
+      fprintf(ofile, "<");
+      first = 1;
+
+      for (n=0 ; n<bddvarnum ; n++)
+      {
+         if (set[n] > 0)
+         {
+            if (!first)
+               fprintf(ofile, ", ");
+            first = 0;
+            if (filehandler)
+               filehandler(ofile, bddlevel2var[n]);
+            else
+               fprintf(ofile, "%d", bddlevel2var[n]);
+            fprintf(ofile, ":%d", (set[n]==2 ? 1 : 0));
+         }
+      }
+
+      fprintf(ofile, ">");
+   }
+   else
+   {
+      set[LEVEL(r)] = 1;
+      bdd_printset_rec(ofile, LOW(r), set);
+
+      set[LEVEL(r)] = 2;
+      bdd_printset_rec(ofile, HIGH(r), set);
+
+      set[LEVEL(r)] = 0;
+   }
+}
+
+
+/*************************************************************************
+  Graphviz output
+*************************************************************************/
+
+void bdd_printdot(BDD r)
+{
+   bdd_fprintdot(stdout, r);
+}
+
+
+int bdd_fnprintdot(char *fname, BDD r)
+{
+   FILE *ofile = fopen(fname, "w");
+   if (ofile == NULL)
+      return bdd_error(BDD_FILE);
+   bdd_fprintdot(ofile, r);
+   fclose(ofile);
+   return 0;
+}
+
+
+   /* Complemented edges are drawn with a hollow dot at their head. The
+      single terminal is false, so true is a complemented edge to it */
+static const char *dotedge(BDD e)
+{
+   return ISCOMPL(e) ? ", arrowhead=odot" : "";
+}
+
+
+void bdd_fprintdot(FILE* ofile, BDD r)
+{
+   BDD_EXCLUSIVE;
+   fprintf(ofile, "digraph G {\n");
+   fprintf(ofile, "0 [shape=box, label=\"0\", style=filled, shape=box, height=0.3, width=0.3];\n");
+   fprintf(ofile, "root [shape=plaintext];\n");
+   fprintf(ofile, "root -> %d [style=filled%s];\n", NODE(r), dotedge(r));
+
+   bdd_fprintdot_rec(ofile, r);
+
+   fprintf(ofile, "}\n");
+
+   bdd_unmark(r);
+}
+
+
+static void bdd_fprintdot_rec(FILE* ofile, BDD r)
+{
+   if (ISCONST(r) || MARKED(r))
+      return;
+
+   fprintf(ofile, "%d [label=\"", NODE(r));
+   if (filehandler)
+      filehandler(ofile, bddlevel2var[LEVEL(r)]);
+   else
+      fprintf(ofile, "%d", bddlevel2var[LEVEL(r)]);
+   fprintf(ofile, "\"];\n");
+
+   fprintf(ofile, "%d -> %d [style=dotted%s];\n",
+           NODE(r), NODE(bddnodes[NODE(r)].low), dotedge(bddnodes[NODE(r)].low));
+   fprintf(ofile, "%d -> %d [style=filled%s];\n",
+           NODE(r), NODE(bddnodes[NODE(r)].high), dotedge(bddnodes[NODE(r)].high));
+
+   SETMARK(r);
+
+   bdd_fprintdot_rec(ofile, bddnodes[NODE(r)].low);
+   bdd_fprintdot_rec(ofile, bddnodes[NODE(r)].high);
+}
+
+
+/*************************************************************************
+  Saving and loading
+*************************************************************************/
+
+int bdd_fnsave(char *fname, BDD r)
+{
+   FILE *ofile;
+   int ok;
+
+   if ((ofile=fopen(fname,"w")) == NULL)
+      return bdd_error(BDD_FILE);
+
+   ok = bdd_save(ofile, r);
+   fclose(ofile);
+   return ok;
+}
+
+
+int bdd_save(FILE *ofile, BDD r)
+{
+   BDD_EXCLUSIVE;
+   int err, n=0;
+
+   if (r < 2)
+   {
+      fprintf(ofile, "0 0 %d\n", r);
+      return 0;
+   }
+
+   bdd_markcount(r, &n);
+   bdd_unmark(r);
+   fprintf(ofile, "%d %d %d\n", n, bddvarnum, r);
+
+   for (n=0 ; n<bddvarnum ; n++)
+      fprintf(ofile, "%d ", bddvar2level[n]);
+   fprintf(ofile, "\n");
+
+   err = bdd_save_rec(ofile, r);
+   bdd_unmark(r);
+
+   return err;
+}
+
+
+static int bdd_save_rec(FILE *ofile, int root)
+{
+   BddNode *node = &bddnodes[NODE(root)];
+   int err;
+
+   if (root < 2)
+      return 0;
+
+   if (LEVELp(node) & MARKON)
+      return 0;
+   LEVELp(node) |= MARKON;
+
+   if ((err=bdd_save_rec(ofile, LOWp(node))) < 0)
+      return err;
+   if ((err=bdd_save_rec(ofile, HIGHp(node))) < 0)
+      return err;
+
+   fprintf(ofile, "%d %d %d %d\n",
+           REGULAR(root), bddlevel2var[LEVELp(node) & MARKHIDE],
+           LOWp(node), HIGHp(node));
+
+   return 0;
+}
+
+
+int bdd_fnload(char *fname, BDD *root)
+{
+   FILE *ifile;
+   int ok;
+
+   if ((ifile=fopen(fname,"r")) == NULL)
+      return bdd_error(BDD_FILE);
+
+   ok = bdd_load(ifile, root);
+   fclose(ifile);
+   return ok;
+}
+
+
+int bdd_load(FILE *ifile, BDD *root)
+{
+   BDD_EXCLUSIVE;
+   std::unordered_map< int, BDD > loaded;
+   int lh_nodenum, vnum, lh_root;
+   int n, level;
+   BDD last = 0;
+
+      /* The header holds the root edge, so a complemented root or the
+         constants true / false need no node lines of their own */
+   if (fscanf(ifile, "%d %d %d", &lh_nodenum, &vnum, &lh_root) != 3)
+      return bdd_error(BDD_FORMAT);
+
+   if (lh_nodenum==0  &&  vnum==0)
+   {
+      if (lh_root < 0  ||  lh_root > 1)
+         return bdd_error(BDD_FORMAT);
+      *root = lh_root;
+      return 0;
+   }
+
+   if (vnum > bddvarnum)
+      bdd_setvarnum(vnum);
+
+      /* The stored order must match ours since nodes refer to levels */
+   for (n=0 ; n<vnum ; n++)
+   {
+      if (fscanf(ifile, "%d", &level) != 1)
+         return bdd_error(BDD_FORMAT);
+      if (level != bddvar2level[n])
+         return bdd_error(BDD_FORMAT);
+   }
+
+      /* Stored nodes are keyed by their regular edge */
+   loaded[0] = 0;
+
+   for (n=0 ; n<lh_nodenum ; n++)
+   {
+      int key, var, low, high;
+
+      if (fscanf(ifile,"%d %d %d %d", &key, &var, &low, &high) != 4)
+         break;
+
+      auto lowit = loaded.find(REGULAR(low));
+      auto highit = loaded.find(REGULAR(high));
+      if (lowit == loaded.end()  ||  highit == loaded.end()  ||
+          var < 0  ||  var >= bddvarnum)
+         break;
+
+      last = bdd_addref( bdd_ite(bdd_ithvar(var),
+                                 highit->second ^ ISCOMPL(high),
+                                 lowit->second ^ ISCOMPL(low)) );
+      loaded[key] = last;
+   }
+
+   for (auto &entry : loaded)
+      if (entry.second != last)
+         bdd_delref(entry.second);
+
+   if (n < lh_nodenum  ||  loaded.find(REGULAR(lh_root)) == loaded.end())
+   {
+      bdd_delref(last);
+      return bdd_error(BDD_FORMAT);
+   }
+
+   *root = bdd_keepres(bdd_delref(last) ^ ISCOMPL(lh_root));
+   return 0;
+}
+
+
+/* EOF */
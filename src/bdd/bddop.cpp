@@ -0,0 +1,1929 @@
+/*************************************************************************
+  FILE:  bddop.cpp
+  DESCR: BDD operators (apply, ite, quantification, replacement and
+         satisfiability queries)
+*************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <type_traits>
+#include "kernel.h"
+#include "cache.h"
+
+   /* Hash value modifiers to distinguish between entries in misccache */
+#define CACHEID_CONSTRAIN   0x0
+#define CACHEID_RESTRICT    0x1
+#define CACHEID_SATCOU      0x2
+#define CACHEID_SATCOULN    0x3
+#define CACHEID_PATHCOU     0x4
+
+   /* Hash value modifiers for replace/compose */
+#define CACHEID_REPLACE      0x0
+#define CACHEID_COMPOSE      0x1
+#define CACHEID_VECCOMPOSE   0x2
+
+   /* Hash value modifiers for quantification */
+#define CACHEID_EXIST        0x0
+#define CACHEID_FORALL       0x1
+#define CACHEID_UNIQUE       0x2
+#define CACHEID_APPEX        0x3
+#define CACHEID_APPAL        0x4
+#define CACHEID_APPUN        0x5
+
+   /* Hash functions for the operator caches */
+#define APPLYHASH(l,r,op)     (TRIPLE(l,r,op))
+#define ITEHASH(f,g,h)        (TRIPLE(f,g,h))
+#define RESTRHASH(r,var)      (PAIR(r,var))
+#define CONSTRAINHASH(f,c)    (PAIR(f,c))
+#define QUANTHASH(r)          (r)
+#define REPLACEHASH(r)        (r)
+#define VECCOMPOSEHASH(f)     (f)
+#define COMPOSEHASH(f,g)      (PAIR(f,g))
+#define SATCOUHASH(r)         (r)
+#define PATHCOUHASH(r)        (r)
+#define APPEXHASH(l,r,op)     (PAIR(l,r))
+
+   /* Quantifier kinds folded into the appex cache id */
+#define APPKIND_EXIST  0
+#define APPKIND_ALL    1
+#define APPKIND_UNI    2
+
+#ifndef M_LN2
+#define M_LN2 0.69314718055994530942
+#endif
+
+#define log1p(a) (log(1.0+a))
+
+
+/*=== Operator results: entry = (left<<1) | right ======================*/
+
+static int oprres[][4] =
+{ {0,0,0,1},  /* and                       ( & )         */
+  {0,1,1,0},  /* xor                       ( ^ )         */
+  {0,1,1,1},  /* or                        ( | )         */
+  {1,1,1,0},  /* nand                                    */
+  {1,0,0,0},  /* nor                                     */
+  {1,1,0,1},  /* implication               ( >> )        */
+  {1,0,0,1},  /* bi-implication                          */
+  {0,0,1,0},  /* difference /greater than  ( - ) ( > )   */
+  {0,1,0,0},  /* less than                 ( < )         */
+  {1,0,1,1},  /* inverse implication       ( << )        */
+  {1,1,0,0}   /* not                       ( ! )         */
+};
+
+
+   /* Apply and ite are instantiated twice. With 'mt' set they use the
+      thread-safe cache and node table access of concurrent mode */
+#define CACHE_LOOKUP(c,h,a,b,d)   (mt ? BddCache_lookupmt(c,h,a,b,d) : BddCache_lookup(c,h,a,b,d))
+#define CACHE_INSERT(c,h,a,b,d,r) (mt ? BddCache_insertmt(c,h,a,b,d,r) : BddCache_insert(c,h,a,b,d,r))
+#define MAKENODE(l,lo,hi)         (mt ? bdd_makenode_concurrent(l,lo,hi) : bdd_makenode(l,lo,hi))
+
+
+/*=== Operator state ===================================================*/
+
+static thread_local int applyop;    /* Current operator for apply */
+static int appexop;                 /* Current operator for appex */
+static int appexid;                 /* Current cache id for appex */
+static int quantid;                 /* Current cache id for quantifications */
+static int *quantvarset;            /* Current variable set for quant. */
+static int quantvarsetID;           /* Current id used in quantvarset */
+static int quantlast;               /* Current last variable to be quant. */
+static int replaceid;               /* Current cache id for replace */
+static int *replacepair;            /* Current replace pair */
+static int replacelast;             /* Current last var. level to replace */
+static int composelevel;            /* Current variable used for compose */
+static int miscid;                  /* Current cache id for other results */
+static int *varprofile;             /* Current variable profile */
+static int supportID;               /* Current ID (true value) for support */
+static int supportMax;              /* Max. used level in support calc. */
+static int *supportSet;             /* The found support set */
+static int supportSize;             /* Allocated size of supportSet */
+static int satPolarity;             /* Polarity of bdd_satoneset */
+static BddCache applycache;         /* Cache for apply results */
+static BddCache itecache;           /* Cache for ITE results */
+static BddCache quantcache;         /* Cache for exist/forall results */
+static BddCache appexcache;         /* Cache for appex/appall results */
+static BddCache replacecache;       /* Cache for replace results */
+static BddCache misccache;          /* Cache for other results */
+static int cacheratio;
+static bddallsathandler allsatHandler;
+static signed char *allsatProfile;
+
+   /* Used to check whether a quantified variable is in the current set */
+#define INVARSET(a) (quantvarset[a] == quantvarsetID)
+#define INSVARSET(a) (abs(quantvarset[a]) == quantvarsetID)
+
+template < int mt > static int apply_rec(int, int);
+template < int mt > static int and_rec(int, int);
+template < int mt > static int xor_rec(int, int);
+template < int mt > static int ite_rec(int, int, int);
+static int    simplify_rec(int, int);
+static int    quant_rec(int);
+static int    appquant_rec(int, int);
+static int    restrict_rec(int);
+static int    constrain_rec(int, int);
+static int    replace_rec(int);
+static int    bdd_correctify(int, int, int);
+static int    compose_rec(int, int);
+static int    veccompose_rec(int);
+static void   support_rec(int, int*);
+static int    satone_rec(int);
+static int    satoneset_rec(int, int);
+static int    fullsatone_rec(int);
+static void   allsat_rec(int r);
+static double satcount_rec(int);
+static double satcountln_rec(int);
+static void   varprofile_rec(int);
+static double pathcount_rec(int);
+static int    varset2vartable(int);
+static int    varset2svartable(int);
+
+
+/*************************************************************************
+  Setup and shutdown
+*************************************************************************/
+
+int bdd_operator_init(int cachesize)
+{
+   if (BddCache_init(&applycache,cachesize) < 0)
+      return bdd_error(BDD_MEMORY);
+
+   if (BddCache_init(&itecache,cachesize) < 0)
+      return bdd_error(BDD_MEMORY);
+
+   if (BddCache_init(&quantcache,cachesize) < 0)
+      return bdd_error(BDD_MEMORY);
+
+   if (BddCache_init(&appexcache,cachesize) < 0)
+      return bdd_error(BDD_MEMORY);
+
+   if (BddCache_init(&replacecache,cachesize) < 0)
+      return bdd_error(BDD_MEMORY);
+
+   if (BddCache_init(&misccache,cachesize) < 0)
+      return bdd_error(BDD_MEMORY);
+
+   quantvarsetID = 0;
+   quantvarset = NULL;
+   cacheratio = 0;
+   supportSet = NULL;
+   supportSize = 0;
+
+   return 0;
+}
+
+
+void bdd_operator_done(void)
+{
+   free(quantvarset);
+   quantvarset = NULL;
+
+   BddCache_done(&applycache);
+   BddCache_done(&itecache);
+   BddCache_done(&quantcache);
+   BddCache_done(&appexcache);
+   BddCache_done(&replacecache);
+   BddCache_done(&misccache);
+
+   free(supportSet);
+   supportSet = NULL;
+   supportSize = 0;
+}
+
+
+void bdd_operator_reset(void)
+{
+   BddCache_reset(&applycache);
+   BddCache_reset(&itecache);
+   BddCache_reset(&quantcache);
+   BddCache_reset(&appexcache);
+   BddCache_reset(&replacecache);
+   BddCache_reset(&misccache);
+}
+
+
+void bdd_operator_varresize(void)
+{
+   free(quantvarset);
+
+   if ((quantvarset=NEW(int,bddvarnum)) == NULL)
+      bdd_error(BDD_MEMORY);
+
+   memset(quantvarset, 0, sizeof(int)*bddvarnum);
+   quantvarsetID = 0;
+}
+
+
+void bdd_operator_noderesize(void)
+{
+   if (cacheratio > 0)
+   {
+      int newcachesize = bddnodesize / cacheratio;
+
+      BddCache_resize(&applycache, newcachesize);
+      BddCache_resize(&itecache, newcachesize);
+      BddCache_resize(&quantcache, newcachesize);
+      BddCache_resize(&appexcache, newcachesize);
+      BddCache_resize(&replacecache, newcachesize);
+      BddCache_resize(&misccache, newcachesize);
+   }
+}
+
+
+static void checkresize(void)
+{
+   if (bddresized)
+      bdd_operator_noderesize();
+   bddresized = 0;
+}
+
+
+   /* Runs one of the operators that may be called concurrently. In
+      concurrent mode the operator holds the kernel lock shared, and when
+      the free list runs dry it is abandoned, the nodes are collected
+      with the lock held exclusively and the operator starts over. The
+      caches remember most of the abandoned work. Automatic reordering
+      runs between operators, never inside one */
+template < class Op > static BDD run_shared(Op op)
+{
+   if (!bddconcurrent  ||  bddinexclusive)
+   {
+      BDD res;
+
+      INITREF;
+      res = op(std::integral_constant<int,0>());
+      checkresize();
+
+      if (bddreorderpending.load(std::memory_order_relaxed))
+      {
+         PUSHREF(res);
+         bdd_reorder_auto();
+      }
+
+      return bdd_keepres(res);
+   }
+
+   for (;;)
+   {
+      int gbcnum = 0;
+      BDD res;
+
+      {
+         std::shared_lock<std::shared_mutex> lock(bddkernellock);
+
+         try
+         {
+            INITREF;
+            res = bdd_keepres(op(std::integral_constant<int,1>()));
+         }
+         catch (BddNodesExhausted &e)
+         {
+            gbcnum = e.gbcnum;
+            res = -1;
+         }
+      }
+
+         /* The result is kept alive as lastres meanwhile */
+      if (res >= 0)
+      {
+         if (bddreorderpending.load(std::memory_order_relaxed))
+            bdd_reorder_auto();
+         return res;
+      }
+
+      if (bdd_gbc_concurrent(gbcnum) < 0)
+         return BDDZERO;
+   }
+}
+
+
+int bdd_setcacheratio(int r)
+{
+   int old = cacheratio;
+
+   if (r <= 0)
+      return bdd_error(BDD_RANGE);
+   if (bddnodesize == 0)
+      return old;
+
+   cacheratio = r;
+   bdd_operator_noderesize();
+   return old;
+}
+
+
+/*************************************************************************
+  Cube building
+*************************************************************************/
+
+BDD bdd_buildcube(int value, int width, BDD *variables)
+{
+   BDD result = BDDONE;
+   int z;
+
+   for (z=0 ; z<width ; z++, value>>=1)
+   {
+      BDD tmp;
+      BDD v;
+
+      if (value & 0x1)
+         v = bdd_addref( variables[width-z-1] );
+      else
+         v = bdd_addref( bdd_not(variables[width-z-1]) );
+
+      bdd_addref(result);
+      tmp = bdd_apply(result,v,bddop_and);
+      bdd_delref(result);
+      bdd_delref(v);
+
+      result = tmp;
+   }
+
+   return result;
+}
+
+
+BDD bdd_ibuildcube(int value, int width, int *variables)
+{
+   BDD result = BDDONE;
+   int z;
+
+   for (z=0 ; z<width ; z++, value>>=1)
+   {
+      BDD tmp;
+      BDD v;
+
+      if (value & 0x1)
+         v = bdd_ithvar(variables[width-z-1]);
+      else
+         v = bdd_nithvar(variables[width-z-1]);
+
+      bdd_addref(result);
+      tmp = bdd_apply(result,v,bddop_and);
+      bdd_delref(result);
+
+      result = tmp;
+   }
+
+   return result;
+}
+
+
+/*************************************************************************
+  Negation
+*************************************************************************/
+
+   /* With complement edges negation only flips the tag bit, so it needs
+      neither new nodes nor a cache entry */
+BDD bdd_not(BDD r)
+{
+   return run_shared([=](auto) -> BDD
+   {
+      CHECKa(r, BDDZERO);
+      return NOT(r);
+   });
+}
+
+
+/*************************************************************************
+  Binary operators
+*************************************************************************/
+
+BDD bdd_apply(BDD l, BDD r, int op)
+{
+   if (op<0 || op>bddop_invimp)
+   {
+      bdd_error(BDD_OP);
+      return BDDZERO;
+   }
+
+   return run_shared([=](auto mt) -> BDD
+   {
+      CHECKa(l, BDDZERO);
+      CHECKa(r, BDDZERO);
+
+      applyop = op;
+      SETOPSTAT(op == bddop_and ? bddstat_and :
+                op == bddop_or  ? bddstat_or  :
+                op == bddop_xor ? bddstat_xor : bddstat_apply);
+      return apply_rec<mt>(l, r);
+   });
+}
+
+
+   /* Every binary operator is a conjunction or an exclusive or with some
+      of its arguments and its result negated. Negation is free, so only
+      and_rec and xor_rec recurse and fill the apply cache, and e.g.
+      a|b reuses the entries computed for !a&!b */
+template < int mt >
+static BDD apply_rec(BDD l, BDD r)
+{
+   switch (applyop)
+   {
+    case bddop_and:
+       return and_rec<mt>(l, r);
+    case bddop_xor:
+       return xor_rec<mt>(l, r);
+    case bddop_or:
+       return NOT(and_rec<mt>(NOT(l), NOT(r)));
+    case bddop_nand:
+       return NOT(and_rec<mt>(l, r));
+    case bddop_nor:
+       return and_rec<mt>(NOT(l), NOT(r));
+    case bddop_imp:
+       return NOT(and_rec<mt>(l, NOT(r)));
+    case bddop_biimp:
+       return NOT(xor_rec<mt>(l, r));
+    case bddop_diff:
+       return and_rec<mt>(l, NOT(r));
+    case bddop_less:
+       return and_rec<mt>(NOT(l), r);
+    case bddop_invimp:
+       return NOT(and_rec<mt>(NOT(l), r));
+   }
+
+   return BDDZERO;
+}
+
+
+template < int mt >
+static BDD and_rec(BDD l, BDD r)
+{
+   BddCacheData *entry;
+   BDD res;
+
+   if (l == r)
+      return l;
+   if (ISZERO(l)  ||  ISZERO(r)  ||  l == NOT(r))
+      return BDDZERO;
+   if (ISONE(l))
+      return r;
+   if (ISONE(r))
+      return l;
+
+      /* Commutative - store each pair in one order only */
+   if (l > r)
+   {
+      BDD tmp = l;
+      l = r;
+      r = tmp;
+   }
+
+   entry = CACHE_LOOKUP(&applycache, APPLYHASH(l,r,bddop_and), l, r, bddop_and);
+   if (entry != NULL)
+      return entry->res;
+
+   if (LEVEL(l) == LEVEL(r))
+   {
+      PUSHREF( and_rec<mt>(LOW(l), LOW(r)) );
+      PUSHREF( and_rec<mt>(HIGH(l), HIGH(r)) );
+      res = MAKENODE(LEVEL(l), READREF(2), READREF(1));
+   }
+   else if (LEVEL(l) < LEVEL(r))
+   {
+      PUSHREF( and_rec<mt>(LOW(l), r) );
+      PUSHREF( and_rec<mt>(HIGH(l), r) );
+      res = MAKENODE(LEVEL(l), READREF(2), READREF(1));
+   }
+   else
+   {
+      PUSHREF( and_rec<mt>(l, LOW(r)) );
+      PUSHREF( and_rec<mt>(l, HIGH(r)) );
+      res = MAKENODE(LEVEL(r), READREF(2), READREF(1));
+   }
+
+   POPREF(2);
+
+   CACHE_INSERT(&applycache, APPLYHASH(l,r,bddop_and), l, r, bddop_and, res);
+
+   return res;
+}
+
+
+template < int mt >
+static BDD xor_rec(BDD l, BDD r)
+{
+   BddCacheData *entry;
+   BDD res;
+   int neg;
+
+   if (l == r)
+      return BDDZERO;
+   if (l == NOT(r))
+      return BDDONE;
+   if (ISZERO(l))
+      return r;
+   if (ISZERO(r))
+      return l;
+   if (ISONE(l))
+      return NOT(r);
+   if (ISONE(r))
+      return NOT(l);
+
+      /* !a^b == a^!b == !(a^b), so only regular pairs are cached */
+   neg = ISCOMPL(l) ^ ISCOMPL(r);
+   l = REGULAR(l);
+   r = REGULAR(r);
+   if (l > r)
+   {
+      BDD tmp = l;
+      l = r;
+      r = tmp;
+   }
+
+   entry = CACHE_LOOKUP(&applycache, APPLYHASH(l,r,bddop_xor), l, r, bddop_xor);
+   if (entry != NULL)
+      return entry->res ^ neg;
+
+   if (LEVEL(l) == LEVEL(r))
+   {
+      PUSHREF( xor_rec<mt>(LOW(l), LOW(r)) );
+      PUSHREF( xor_rec<mt>(HIGH(l), HIGH(r)) );
+      res = MAKENODE(LEVEL(l), READREF(2), READREF(1));
+   }
+   else if (LEVEL(l) < LEVEL(r))
+   {
+      PUSHREF( xor_rec<mt>(LOW(l), r) );
+      PUSHREF( xor_rec<mt>(HIGH(l), r) );
+      res = MAKENODE(LEVEL(l), READREF(2), READREF(1));
+   }
+   else
+   {
+      PUSHREF( xor_rec<mt>(l, LOW(r)) );
+      PUSHREF( xor_rec<mt>(l, HIGH(r)) );
+      res = MAKENODE(LEVEL(r), READREF(2), READREF(1));
+   }
+
+   POPREF(2);
+
+   CACHE_INSERT(&applycache, APPLYHASH(l,r,bddop_xor), l, r, bddop_xor, res);
+
+   return res ^ neg;
+}
+
+
+BDD bdd_and(BDD l, BDD r)
+{
+   return bdd_apply(l,r,bddop_and);
+}
+
+
+BDD bdd_or(BDD l, BDD r)
+{
+   return bdd_apply(l,r,bddop_or);
+}
+
+
+BDD bdd_xor(BDD l, BDD r)
+{
+   return bdd_apply(l,r,bddop_xor);
+}
+
+
+BDD bdd_imp(BDD l, BDD r)
+{
+   return bdd_apply(l,r,bddop_imp);
+}
+
+
+BDD bdd_biimp(BDD l, BDD r)
+{
+   return bdd_apply(l,r,bddop_biimp);
+}
+
+
+/*************************************************************************
+  If-then-else
+*************************************************************************/
+
+BDD bdd_ite(BDD f, BDD g, BDD h)
+{
+   return run_shared([=](auto mt) -> BDD
+   {
+      CHECKa(f, BDDZERO);
+      CHECKa(g, BDDZERO);
+      CHECKa(h, BDDZERO);
+
+      SETOPSTAT(bddstat_ite);
+      return ite_rec<mt>(f,g,h);
+   });
+}
+
+
+template < int mt >
+static BDD ite_rec(BDD f, BDD g, BDD h)
+{
+   BddCacheData *entry;
+   unsigned int top;
+   BDD res;
+   int neg;
+
+   if (ISONE(f))
+      return g;
+   if (ISZERO(f))
+      return h;
+
+      /* ite(f,f,h) == ite(f,1,h) and ite(f,g,!f) == ite(f,g,1) etc. */
+   if (g == f)
+      g = BDDONE;
+   else if (g == NOT(f))
+      g = BDDZERO;
+   if (h == f)
+      h = BDDZERO;
+   else if (h == NOT(f))
+      h = BDDONE;
+
+   if (g == h)
+      return g;
+   if (ISONE(g) && ISZERO(h))
+      return f;
+   if (ISZERO(g) && ISONE(h))
+      return NOT(f);
+
+      /* A constant branch turns ite into a conjunction */
+   if (ISONE(g))
+      return NOT(and_rec<mt>(NOT(f), NOT(h)));
+   if (ISZERO(g))
+      return and_rec<mt>(NOT(f), h);
+   if (ISONE(h))
+      return NOT(and_rec<mt>(f, NOT(g)));
+   if (ISZERO(h))
+      return and_rec<mt>(f, g);
+
+      /* Normalize to a regular condition and then-branch:
+         ite(!f,g,h) == ite(f,h,g) and ite(f,!g,!h) == !ite(f,g,h) */
+   if (ISCOMPL(f))
+   {
+      BDD tmp = g;
+      f = NOT(f);
+      g = h;
+      h = tmp;
+   }
+
+   neg = ISCOMPL(g);
+   g ^= neg;
+   h ^= neg;
+
+   entry = CACHE_LOOKUP(&itecache, ITEHASH(f,g,h), f, g, h);
+   if (entry != NULL)
+      return entry->res ^ neg;
+
+   top = MIN(LEVEL(f), MIN(LEVEL(g), LEVEL(h)));
+
+   PUSHREF( ite_rec<mt>(LEVEL(f) == top ? LOW(f) : f,
+                    LEVEL(g) == top ? LOW(g) : g,
+                    LEVEL(h) == top ? LOW(h) : h) );
+   PUSHREF( ite_rec<mt>(LEVEL(f) == top ? HIGH(f) : f,
+                    LEVEL(g) == top ? HIGH(g) : g,
+                    LEVEL(h) == top ? HIGH(h) : h) );
+   res = MAKENODE(top, READREF(2), READREF(1));
+   POPREF(2);
+
+   CACHE_INSERT(&itecache, ITEHASH(f,g,h), f, g, h, res);
+
+   return res ^ neg;
+}
+
+
+/*************************************************************************
+  Restriction and generalized cofactors
+*************************************************************************/
+
+BDD bdd_restrict(BDD r, BDD var)
+{
+   BDD_EXCLUSIVE;
+   BDD res;
+
+   CHECKa(r,BDDZERO);
+   CHECKa(var,BDDZERO);
+
+   if (var < 2)  /* Empty set */
+      return r;
+
+   if (varset2svartable(var) < 0)
+      return BDDZERO;
+
+   INITREF;
+   miscid = (var << 3) | CACHEID_RESTRICT;
+   SETOPSTAT(bddstat_cofactor);
+   res = restrict_rec(r);
+   checkresize();
+
+   return bdd_keepres(res);
+}
+
+
+static int restrict_rec(int r)
+{
+   BddCacheData *entry;
+   int res, neg;
+
+   if (ISCONST(r)  ||  (int)LEVEL(r) > quantlast)
+      return r;
+
+      /* Restriction commutes with negation */
+   neg = ISCOMPL(r);
+   r = REGULAR(r);
+
+   entry = BddCache_lookup1(&misccache, RESTRHASH(r,miscid), r, miscid);
+   if (entry != NULL)
+      return entry->res ^ neg;
+
+   if (INSVARSET(LEVEL(r)))
+   {
+      if (quantvarset[LEVEL(r)] > 0)
+         res = restrict_rec(HIGH(r));
+      else
+         res = restrict_rec(LOW(r));
+   }
+   else
+   {
+      PUSHREF( restrict_rec(LOW(r)) );
+      PUSHREF( restrict_rec(HIGH(r)) );
+      res = bdd_makenode(LEVEL(r), READREF(2), READREF(1));
+      POPREF(2);
+   }
+
+   BddCache_insert1(&misccache, RESTRHASH(r,miscid), r, miscid, res);
+
+   return res ^ neg;
+}
+
+
+BDD bdd_constrain(BDD f, BDD c)
+{
+   BDD_EXCLUSIVE;
+   BDD res;
+
+   CHECKa(f,BDDZERO);
+   CHECKa(c,BDDZERO);
+
+   INITREF;
+   miscid = CACHEID_CONSTRAIN;
+   SETOPSTAT(bddstat_cofactor);
+   res = constrain_rec(f, c);
+   checkresize();
+
+   return bdd_keepres(res);
+}
+
+
+static BDD constrain_rec(BDD f, BDD c)
+{
+   BddCacheData *entry;
+   BDD res;
+
+   if (ISONE(c))
+      return f;
+   if (ISCONST(f))
+      return f;
+   if (c == f)
+      return BDDONE;
+   if (ISZERO(c))
+      return BDDZERO;
+
+   entry = BddCache_lookup(&misccache, CONSTRAINHASH(f,c), f, c, miscid);
+   if (entry != NULL)
+      return entry->res;
+
+   if (LEVEL(f) == LEVEL(c))
+   {
+      if (ISZERO(LOW(c)))
+         res = constrain_rec(HIGH(f), HIGH(c));
+      else if (ISZERO(HIGH(c)))
+         res = constrain_rec(LOW(f), LOW(c));
+      else
+      {
+         PUSHREF( constrain_rec(LOW(f), LOW(c)) );
+         PUSHREF( constrain_rec(HIGH(f), HIGH(c)) );
+         res = bdd_makenode(LEVEL(f), READREF(2), READREF(1));
+         POPREF(2);
+      }
+   }
+   else if (LEVEL(f) < LEVEL(c))
+   {
+      PUSHREF( constrain_rec(LOW(f), c) );
+      PUSHREF( constrain_rec(HIGH(f), c) );
+      res = bdd_makenode(LEVEL(f), READREF(2), READREF(1));
+      POPREF(2);
+   }
+   else
+   {
+      if (ISZERO(LOW(c)))
+         res = constrain_rec(f, HIGH(c));
+      else if (ISZERO(HIGH(c)))
+         res = constrain_rec(f, LOW(c));
+      else
+      {
+         PUSHREF( constrain_rec(f, LOW(c)) );
+         PUSHREF( constrain_rec(f, HIGH(c)) );
+         res = bdd_makenode(LEVEL(c), READREF(2), READREF(1));
+         POPREF(2);
+      }
+   }
+
+   BddCache_insert(&misccache, CONSTRAINHASH(f,c), f, c, miscid, res);
+
+   return res;
+}
+
+
+BDD bdd_simplify(BDD f, BDD d)
+{
+   BDD_EXCLUSIVE;
+   BDD res;
+
+   CHECKa(f,BDDZERO);
+   CHECKa(d,BDDZERO);
+
+   INITREF;
+   applyop = bddop_or;
+   SETOPSTAT(bddstat_cofactor);
+   res = simplify_rec(f, d);
+   checkresize();
+
+   return bdd_keepres(res);
+}
+
+
+static BDD simplify_rec(BDD f, BDD d)
+{
+   BddCacheData *entry;
+   BDD res;
+
+   if (ISONE(d)  ||  ISCONST(f))
+      return f;
+   if (d == f)
+      return BDDONE;
+   if (ISZERO(d))
+      return BDDZERO;
+
+   entry = BddCache_lookup(&applycache, APPLYHASH(f,d,bddop_simplify), f, d, bddop_simplify);
+   if (entry != NULL)
+      return entry->res;
+
+   if (LEVEL(f) == LEVEL(d))
+   {
+      if (ISZERO(LOW(d)))
+         res = simplify_rec(HIGH(f), HIGH(d));
+      else if (ISZERO(HIGH(d)))
+         res = simplify_rec(LOW(f), LOW(d));
+      else
+      {
+         PUSHREF( simplify_rec(LOW(f), LOW(d)) );
+         PUSHREF( simplify_rec(HIGH(f), HIGH(d)) );
+         res = bdd_makenode(LEVEL(f), READREF(2), READREF(1));
+         POPREF(2);
+      }
+   }
+   else if (LEVEL(f) < LEVEL(d))
+   {
+      PUSHREF( simplify_rec(LOW(f), d) );
+      PUSHREF( simplify_rec(HIGH(f), d) );
+      res = bdd_makenode(LEVEL(f), READREF(2), READREF(1));
+      POPREF(2);
+   }
+   else /* LEVEL(d) < LEVEL(f) */
+   {
+      PUSHREF( apply_rec<0>(LOW(d), HIGH(d)) ); /* Exist quant */
+      res = simplify_rec(f, READREF(1));
+      POPREF(1);
+   }
+
+   BddCache_insert(&applycache, APPLYHASH(f,d,bddop_simplify), f, d, bddop_simplify, res);
+
+   return res;
+}
+
+
+/*************************************************************************
+  Quantification
+*************************************************************************/
+
+static BDD quantify(BDD r, BDD var, int op, int cacheid)
+{
+   BDD_EXCLUSIVE;
+   BDD res;
+
+   CHECKa(r, BDDZERO);
+   CHECKa(var, BDDZERO);
+
+   if (var < 2)  /* Empty set */
+      return r;
+
+   if (varset2vartable(var) < 0)
+      return BDDZERO;
+
+   INITREF;
+   quantid = (var << 3) | cacheid;
+   applyop = op;
+   SETOPSTAT(bddstat_exist);
+
+   res = quant_rec(r);
+   checkresize();
+
+   return bdd_keepres(res);
+}
+
+
+BDD bdd_exist(BDD r, BDD var)
+{
+   return quantify(r, var, bddop_or, CACHEID_EXIST);
+}
+
+
+BDD bdd_forall(BDD r, BDD var)
+{
+   return quantify(r, var, bddop_and, CACHEID_FORALL);
+}
+
+
+BDD bdd_unique(BDD r, BDD var)
+{
+   return quantify(r, var, bddop_xor, CACHEID_UNIQUE);
+}
+
+
+static int quant_rec(int r)
+{
+   BddCacheData *entry;
+   int res;
+
+   if (r < 2  ||  (int)LEVEL(r) > quantlast)
+      return r;
+
+   entry = BddCache_lookup1(&quantcache, QUANTHASH(r), r, quantid);
+   if (entry != NULL)
+      return entry->res;
+
+   PUSHREF( quant_rec(LOW(r)) );
+   PUSHREF( quant_rec(HIGH(r)) );
+
+   if (INVARSET(LEVEL(r)))
+      res = apply_rec<0>(READREF(2), READREF(1));
+   else
+      res = bdd_makenode(LEVEL(r), READREF(2), READREF(1));
+
+   POPREF(2);
+
+   BddCache_insert1(&quantcache, QUANTHASH(r), r, quantid, res);
+
+   return res;
+}
+
+
+static BDD appquantify(BDD l, BDD r, int opr, BDD var, int quantop,
+                       int kind, int cacheid)
+{
+   BDD_EXCLUSIVE;
+   BDD res;
+
+   CHECKa(l, BDDZERO);
+   CHECKa(r, BDDZERO);
+   CHECKa(var, BDDZERO);
+
+   if (opr<0 || opr>bddop_invimp)
+   {
+      bdd_error(BDD_OP);
+      return BDDZERO;
+   }
+
+   if (var < 2)  /* Empty set */
+      return bdd_apply(l,r,opr);
+
+   if (varset2vartable(var) < 0)
+      return BDDZERO;
+
+   INITREF;
+   applyop = quantop;
+   appexop = opr;
+   appexid = (var << 6) | (appexop << 2) | kind;
+   quantid = (appexid << 3) | cacheid;
+   SETOPSTAT(bddstat_appex);
+
+   res = appquant_rec(l, r);
+   checkresize();
+
+   return bdd_keepres(res);
+}
+
+
+BDD bdd_appex(BDD l, BDD r, int opr, BDD var)
+{
+   return appquantify(l, r, opr, var, bddop_or, APPKIND_EXIST, CACHEID_APPEX);
+}
+
+
+BDD bdd_appall(BDD l, BDD r, int opr, BDD var)
+{
+   return appquantify(l, r, opr, var, bddop_and, APPKIND_ALL, CACHEID_APPAL);
+}
+
+
+BDD bdd_appuni(BDD l, BDD r, int opr, BDD var)
+{
+   return appquantify(l, r, opr, var, bddop_xor, APPKIND_UNI, CACHEID_APPUN);
+}
+
+
+static int appquant_rec(int l, int r)
+{
+   BddCacheData *entry;
+   int res;
+
+   switch (appexop)
+   {
+    case bddop_and:
+       if (l == 0  ||  r == 0)
+          return 0;
+       if (l == r)
+          return quant_rec(l);
+       if (l == 1)
+          return quant_rec(r);
+       if (r == 1)
+          return quant_rec(l);
+       break;
+    case bddop_or:
+       if (l == 1  ||  r == 1)
+          return 1;
+       if (l == r)
+          return quant_rec(l);
+       if (l == 0)
+          return quant_rec(r);
+       if (r == 0)
+          return quant_rec(l);
+       break;
+    case bddop_xor:
+       if (l == r)
+          return 0;
+       if (l == 0)
+          return quant_rec(r);
+       if (r == 0)
+          return quant_rec(l);
+       break;
+    case bddop_nand:
+       if (l == 0  ||  r == 0)
+          return 1;
+       break;
+    case bddop_nor:
+       if (l == 1  ||  r == 1)
+          return 0;
+       break;
+   }
+
+   if (ISCONST(l)  &&  ISCONST(r))
+      return oprres[appexop][(l<<1) | r];
+
+   if ((int)LEVEL(l) > quantlast  &&  (int)LEVEL(r) > quantlast)
+   {
+      int oldop = applyop;
+      applyop = appexop;
+      res = apply_rec<0>(l,r);
+      applyop = oldop;
+      return res;
+   }
+
+   entry = BddCache_lookup(&appexcache, APPEXHASH(l,r,appexop), l, r, appexid);
+   if (entry != NULL)
+      return entry->res;
+
+   if (LEVEL(l) == LEVEL(r))
+   {
+      PUSHREF( appquant_rec(LOW(l), LOW(r)) );
+      PUSHREF( appquant_rec(HIGH(l), HIGH(r)) );
+      if (INVARSET(LEVEL(l)))
+         res = apply_rec<0>(READREF(2), READREF(1));
+      else
+         res = bdd_makenode(LEVEL(l), READREF(2), READREF(1));
+   }
+   else if (LEVEL(l) < LEVEL(r))
+   {
+      PUSHREF( appquant_rec(LOW(l), r) );
+      PUSHREF( appquant_rec(HIGH(l), r) );
+      if (INVARSET(LEVEL(l)))
+         res = apply_rec<0>(READREF(2), READREF(1));
+      else
+         res = bdd_makenode(LEVEL(l), READREF(2), READREF(1));
+   }
+   else
+   {
+      PUSHREF( appquant_rec(l, LOW(r)) );
+      PUSHREF( appquant_rec(l, HIGH(r)) );
+      if (INVARSET(LEVEL(r)))
+         res = apply_rec<0>(READREF(2), READREF(1));
+      else
+         res = bdd_makenode(LEVEL(r), READREF(2), READREF(1));
+   }
+
+   POPREF(2);
+
+   BddCache_insert(&appexcache, APPEXHASH(l,r,appexop), l, r, appexid, res);
+
+   return res;
+}
+
+
+/*************************************************************************
+  Variable replacement and composition
+*************************************************************************/
+
+BDD bdd_replace(BDD r, bddPair *pair)
+{
+   BDD_EXCLUSIVE;
+   BDD res;
+
+   CHECKa(r, BDDZERO);
+
+   INITREF;
+   replacepair = pair->result;
+   replacelast = pair->last;
+   replaceid = (pair->id << 2) | CACHEID_REPLACE;
+   SETOPSTAT(bddstat_replace);
+
+   res = replace_rec(r);
+   checkresize();
+
+   return bdd_keepres(res);
+}
+
+
+static BDD replace_rec(BDD r)
+{
+   BddCacheData *entry;
+   BDD res;
+   int neg;
+
+   if (ISCONST(r)  ||  (int)LEVEL(r) > replacelast)
+      return r;
+
+      /* Renaming commutes with negation */
+   neg = ISCOMPL(r);
+   r = REGULAR(r);
+
+   entry = BddCache_lookup1(&replacecache, REPLACEHASH(r), r, replaceid);
+   if (entry != NULL)
+      return entry->res ^ neg;
+
+   PUSHREF( replace_rec(LOW(r)) );
+   PUSHREF( replace_rec(HIGH(r)) );
+
+   res = bdd_correctify(LEVEL(replacepair[LEVEL(r)]), READREF(2), READREF(1));
+   POPREF(2);
+
+   BddCache_insert1(&replacecache, REPLACEHASH(r), r, replaceid, res);
+
+   return res ^ neg;
+}
+
+
+static BDD bdd_correctify(int level, BDD l, BDD r)
+{
+   BDD res;
+
+   if (level < (int)LEVEL(l)  &&  level < (int)LEVEL(r))
+      return bdd_makenode(level, l, r);
+
+   if (level == (int)LEVEL(l)  ||  level == (int)LEVEL(r))
+   {
+      bdd_error(BDD_REPLACE);
+      return 0;
+   }
+
+   if (LEVEL(l) == LEVEL(r))
+   {
+      PUSHREF( bdd_correctify(level, LOW(l), LOW(r)) );
+      PUSHREF( bdd_correctify(level, HIGH(l), HIGH(r)) );
+      res = bdd_makenode(LEVEL(l), READREF(2), READREF(1));
+   }
+   else if (LEVEL(l) < LEVEL(r))
+   {
+      PUSHREF( bdd_correctify(level, LOW(l), r) );
+      PUSHREF( bdd_correctify(level, HIGH(l), r) );
+      res = bdd_makenode(LEVEL(l), READREF(2), READREF(1));
+   }
+   else
+   {
+      PUSHREF( bdd_correctify(level, l, LOW(r)) );
+      PUSHREF( bdd_correctify(level, l, HIGH(r)) );
+      res = bdd_makenode(LEVEL(r), READREF(2), READREF(1));
+   }
+
+   POPREF(2);
+   return res;
+}
+
+
+BDD bdd_compose(BDD f, BDD g, int var)
+{
+   BDD_EXCLUSIVE;
+   BDD res;
+
+   CHECKa(f, BDDZERO);
+   CHECKa(g, BDDZERO);
+   if (var < 0 || var >= bddvarnum)
+   {
+      bdd_error(BDD_VAR);
+      return BDDZERO;
+   }
+
+   INITREF;
+   composelevel = bddvar2level[var];
+   replaceid = (composelevel << 2) | CACHEID_COMPOSE;
+   SETOPSTAT(bddstat_replace);
+
+   res = compose_rec(f, g);
+   checkresize();
+
+   return bdd_keepres(res);
+}
+
+
+static BDD compose_rec(BDD f, BDD g)
+{
+   BddCacheData *entry;
+   BDD res;
+
+   if ((int)LEVEL(f) > composelevel)
+      return f;
+
+   entry = BddCache_lookup(&replacecache, COMPOSEHASH(f,g), f, g, replaceid);
+   if (entry != NULL)
+      return entry->res;
+
+   if ((int)LEVEL(f) < composelevel)
+   {
+      if (LEVEL(f) == LEVEL(g))
+      {
+         PUSHREF( compose_rec(LOW(f), LOW(g)) );
+         PUSHREF( compose_rec(HIGH(f), HIGH(g)) );
+         res = bdd_makenode(LEVEL(f), READREF(2), READREF(1));
+      }
+      else if (LEVEL(f) < LEVEL(g))
+      {
+         PUSHREF( compose_rec(LOW(f), g) );
+         PUSHREF( compose_rec(HIGH(f), g) );
+         res = bdd_makenode(LEVEL(f), READREF(2), READREF(1));
+      }
+      else
+      {
+         PUSHREF( compose_rec(f, LOW(g)) );
+         PUSHREF( compose_rec(f, HIGH(g)) );
+         res = bdd_makenode(LEVEL(g), READREF(2), READREF(1));
+      }
+      POPREF(2);
+   }
+   else /* LEVEL(f) == composelevel */
+   {
+      res = ite_rec<0>(g, HIGH(f), LOW(f));
+   }
+
+   BddCache_insert(&replacecache, COMPOSEHASH(f,g), f, g, replaceid, res);
+
+   return res;
+}
+
+
+BDD bdd_veccompose(BDD f, bddPair *pair)
+{
+   BDD_EXCLUSIVE;
+   BDD res;
+
+   CHECKa(f, BDDZERO);
+
+   INITREF;
+   replacepair = pair->result;
+   replacelast = pair->last;
+   replaceid = (pair->id << 2) | CACHEID_VECCOMPOSE;
+   SETOPSTAT(bddstat_replace);
+
+   res = veccompose_rec(f);
+   checkresize();
+
+   return bdd_keepres(res);
+}
+
+
+static BDD veccompose_rec(BDD f)
+{
+   BddCacheData *entry;
+   BDD res;
+
+   if ((int)LEVEL(f) > replacelast)
+      return f;
+
+   entry = BddCache_lookup1(&replacecache, VECCOMPOSEHASH(f), f, replaceid);
+   if (entry != NULL)
+      return entry->res;
+
+   PUSHREF( veccompose_rec(LOW(f)) );
+   PUSHREF( veccompose_rec(HIGH(f)) );
+   res = ite_rec<0>(replacepair[LEVEL(f)], READREF(1), READREF(2));
+   POPREF(2);
+
+   BddCache_insert1(&replacecache, VECCOMPOSEHASH(f), f, replaceid, res);
+
+   return res;
+}
+
+
+/*************************************************************************
+  Support
+*************************************************************************/
+
+BDD bdd_support(BDD r)
+{
+   BDD_EXCLUSIVE;
+   int n;
+   int res=1;
+
+   CHECKa(r, BDDZERO);
+
+   if (r < 2)
+      return BDDONE;
+
+      /* On-demand allocation of support set */
+   if (supportSize < bddvarnum)
+   {
+      free(supportSet);
+      if ((supportSet=NEW(int,bddvarnum)) == NULL)
+      {
+         bdd_error(BDD_MEMORY);
+         return BDDZERO;
+      }
+      memset(supportSet, 0, bddvarnum*sizeof(int));
+      supportSize = bddvarnum;
+      supportID = 0;
+   }
+
+      /* Update global variable used to speed up bdd_support()
+       * - instead of always memsetting support to zero, we use
+       *   a change of ID to signal non-supported variables */
+   if (supportID == 0x0FFFFFFF)
+   {
+      memset(supportSet, 0, bddvarnum*sizeof(int));
+      supportID = 0;
+   }
+   ++supportID;
+   supportMax = LEVEL(r);
+
+   INITREF;
+   support_rec(r, supportSet);
+   bdd_unmark(r);
+
+   for (n=supportMax ; n>=(int)LEVEL(r) ; --n)
+      if (supportSet[n] == supportID)
+      {
+         BDD tmp;
+         bdd_addref(res);
+         tmp = bdd_makenode(n, 0, res);
+         bdd_delref(res);
+         res = tmp;
+      }
+
+   return bdd_keepres(res);
+}
+
+
+static void support_rec(int r, int* support)
+{
+   BddNode *node;
+
+   if (r < 2)
+      return;
+
+   node = &bddnodes[NODE(r)];
+   if (LEVELp(node) & MARKON  ||  LOWp(node) == -1)
+      return;
+
+   support[LEVELp(node)] = supportID;
+
+   if ((int)LEVELp(node) > supportMax)
+      supportMax = LEVELp(node);
+
+   LEVELp(node) |= MARKON;
+
+   support_rec(LOWp(node), support);
+   support_rec(HIGHp(node), support);
+}
+
+
+/*************************************************************************
+  Satisfying assignments
+*************************************************************************/
+
+BDD bdd_satone(BDD r)
+{
+   BDD_EXCLUSIVE;
+   BDD res;
+
+   CHECKa(r, BDDZERO);
+   if (r < 2)
+      return r;
+
+   INITREF;
+   res = satone_rec(r);
+
+   return bdd_keepres(res);
+}
+
+
+static BDD satone_rec(BDD r)
+{
+   if (ISCONST(r))
+      return r;
+
+   if (ISZERO(LOW(r)))
+   {
+      BDD res = satone_rec(HIGH(r));
+      return PUSHREF( bdd_makenode(LEVEL(r), BDDZERO, res) );
+   }
+   else
+   {
+      BDD res = satone_rec(LOW(r));
+      return PUSHREF( bdd_makenode(LEVEL(r), res, BDDZERO) );
+   }
+}
+
+
+BDD bdd_satoneset(BDD r, BDD var, BDD pol)
+{
+   BDD_EXCLUSIVE;
+   BDD res;
+
+   CHECKa(r, BDDZERO);
+   if (ISZERO(r))
+      return r;
+   if (!ISCONST(pol))
+   {
+      bdd_error(BDD_ILLBDD);
+      return BDDZERO;
+   }
+
+   INITREF;
+   satPolarity = pol;
+   res = satoneset_rec(r, var);
+
+   return bdd_keepres(res);
+}
+
+
+static BDD satoneset_rec(BDD r, BDD var)
+{
+   if (ISCONST(r)  &&  ISCONST(var))
+      return r;
+
+   if (LEVEL(r) < LEVEL(var))
+   {
+      if (ISZERO(LOW(r)))
+      {
+         BDD res = satoneset_rec(HIGH(r), var);
+         return PUSHREF( bdd_makenode(LEVEL(r), BDDZERO, res) );
+      }
+      else
+      {
+         BDD res = satoneset_rec(LOW(r), var);
+         return PUSHREF( bdd_makenode(LEVEL(r), res, BDDZERO) );
+      }
+   }
+   else if (LEVEL(var) < LEVEL(r))
+   {
+      BDD res = satoneset_rec(r, HIGH(var));
+      if (satPolarity == BDDONE)
+         return PUSHREF( bdd_makenode(LEVEL(var), BDDZERO, res) );
+      else
+         return PUSHREF( bdd_makenode(LEVEL(var), res, BDDZERO) );
+   }
+   else /* LEVEL(r) == LEVEL(var) */
+   {
+      if (ISZERO(LOW(r)))
+      {
+         BDD res = satoneset_rec(HIGH(r), HIGH(var));
+         return PUSHREF( bdd_makenode(LEVEL(r), BDDZERO, res) );
+      }
+      else
+      {
+         BDD res = satoneset_rec(LOW(r), HIGH(var));
+         return PUSHREF( bdd_makenode(LEVEL(r), res, BDDZERO) );
+      }
+   }
+}
+
+
+BDD bdd_fullsatone(BDD r)
+{
+   BDD_EXCLUSIVE;
+   BDD res;
+   int v;
+
+   CHECKa(r, BDDZERO);
+   if (r == 0)
+      return 0;
+
+   INITREF;
+   res = fullsatone_rec(r);
+
+   for (v=LEVEL(r)-1 ; v>=0 ; v--)
+      res = PUSHREF( bdd_makenode(v, res, 0) );
+
+   return bdd_keepres(res);
+}
+
+
+static int fullsatone_rec(int r)
+{
+   if (r < 2)
+      return r;
+
+   if (LOW(r) != 0)
+   {
+      int res = fullsatone_rec(LOW(r));
+      int v;
+
+      for (v=LEVEL(LOW(r))-1 ; v>(int)LEVEL(r) ; v--)
+         res = PUSHREF( bdd_makenode(v, res, 0) );
+
+      return PUSHREF( bdd_makenode(LEVEL(r), res, 0) );
+   }
+   else
+   {
+      int res = fullsatone_rec(HIGH(r));
+      int v;
+
+      for (v=LEVEL(HIGH(r))-1 ; v>(int)LEVEL(r) ; v--)
+         res = PUSHREF( bdd_makenode(v, res, 0) );
+
+      return PUSHREF( bdd_makenode(LEVEL(r), 0, res) );
+   }
+}
+
+
+void bdd_allsat(BDD r, bddallsathandler handler)
+{
+   BDD_EXCLUSIVE;
+   int v;
+
+   CHECKn(r);
+
+   if ((allsatProfile=NEW(signed char,bddvarnum)) == NULL)
+   {
+      bdd_error(BDD_MEMORY);
+      return;
+   }
+
+   for (v=LEVEL(r)-1 ; v>=0 ; --v)
+      allsatProfile[bddlevel2var[v]] = -1;
+
+   allsatHandler = handler;
+   INITREF;
+
+   allsat_rec(r);
+
+   free(allsatProfile);
+}
+
+
+static void allsat_rec(BDD r)
+{
+   if (ISONE(r))
+   {
+      allsatHandler((char*)allsatProfile, bddvarnum);
+      return;
+   }
+
+   if (ISZERO(r))
+      return;
+
+   if (!ISZERO(LOW(r)))
+   {
+      int v;
+
+      allsatProfile[bddlevel2var[LEVEL(r)]] = 0;
+
+      for (v=LEVEL(LOW(r))-1 ; v>(int)LEVEL(r) ; --v)
+         allsatProfile[bddlevel2var[v]] = -1;
+
+      allsat_rec(LOW(r));
+   }
+
+   if (!ISZERO(HIGH(r)))
+   {
+      int v;
+
+      allsatProfile[bddlevel2var[LEVEL(r)]] = 1;
+
+      for (v=LEVEL(HIGH(r))-1 ; v>(int)LEVEL(r) ; --v)
+         allsatProfile[bddlevel2var[v]] = -1;
+
+      allsat_rec(HIGH(r));
+   }
+}
+
+
+/*************************************************************************
+  Counting
+*************************************************************************/
+
+double bdd_satcount(BDD r)
+{
+   BDD_EXCLUSIVE;
+   double size=1;
+
+   CHECKa(r, 0.0);
+
+   miscid = CACHEID_SATCOU;
+   SETOPSTAT(bddstat_satcount);
+   size = pow(2.0, (double)LEVEL(r));
+
+   return size * satcount_rec(r);
+}
+
+
+double bdd_satcountset(BDD r, BDD varset)
+{
+   BDD_EXCLUSIVE;
+   double unused = bddvarnum;
+   BDD n;
+
+   if (ISCONST(varset)  ||  ISZERO(r)) /* empty set */
+      return 0.0;
+
+   for (n=varset ; !ISCONST(n) ; n=HIGH(n))
+      unused--;
+
+   unused = bdd_satcount(r) / pow(2.0,unused);
+
+   return unused >= 1.0 ? unused : 1.0;
+}
+
+
+static double satcount_rec(int root)
+{
+   BddCacheData *entry;
+   double size, s;
+
+   if (root < 2)
+      return root;
+
+      /* The count of !f is the complement of the count of f among the
+         2^(varnum-level) assignments below its top level */
+   if (ISCOMPL(root))
+      return pow(2.0, (double)(bddvarnum - LEVEL(root))) - satcount_rec(NOT(root));
+
+   entry = BddCache_lookup1(&misccache, SATCOUHASH(root), root, miscid);
+   if (entry != NULL)
+      return entry->dres;
+
+   size = 0;
+   s = pow(2.0, (double)(LEVEL(LOW(root)) - LEVEL(root) - 1));
+   size += s * satcount_rec(LOW(root));
+
+   s = pow(2.0, (double)(LEVEL(HIGH(root)) - LEVEL(root) - 1));
+   size += s * satcount_rec(HIGH(root));
+
+   BddCache_insertd(&misccache, SATCOUHASH(root), root, miscid, size);
+
+   return size;
+}
+
+
+double bdd_satcountln(BDD r)
+{
+   BDD_EXCLUSIVE;
+   double size;
+
+   CHECKa(r, 0.0);
+
+   miscid = CACHEID_SATCOULN;
+   SETOPSTAT(bddstat_satcount);
+   size = satcountln_rec(r);
+
+   if (size >= 0.0)
+      size += LEVEL(r);
+
+   return size;
+}
+
+
+double bdd_satcountlnset(BDD r, BDD varset)
+{
+   BDD_EXCLUSIVE;
+   double unused = bddvarnum;
+   BDD n;
+
+   if (ISCONST(varset)) /* empty set */
+      return 0.0;
+
+   for (n=varset ; !ISCONST(n) ; n=HIGH(n))
+      unused--;
+
+   unused = bdd_satcountln(r) - unused;
+
+   return unused >= 0.0 ? unused : 0.0;
+}
+
+
+static double satcountln_rec(int root)
+{
+   BddCacheData *entry;
+   double size, s1,s2;
+
+   if (root == 0)
+      return -1.0;
+   if (root == 1)
+      return 0.0;
+
+   entry = BddCache_lookup1(&misccache, SATCOUHASH(root), root, miscid);
+   if (entry != NULL)
+      return entry->dres;
+
+   s1 = satcountln_rec(LOW(root));
+   if (s1 >= 0.0)
+      s1 += LEVEL(LOW(root)) - LEVEL(root) - 1;
+
+   s2 = satcountln_rec(HIGH(root));
+   if (s2 >= 0.0)
+      s2 += LEVEL(HIGH(root)) - LEVEL(root) - 1;
+
+   if (s1 < 0.0)
+      size = s2;
+   else if (s2 < 0.0)
+      size = s1;
+   else if (s1 < s2)
+      size = s2 + log1p(pow(2.0,s1-s2)) / M_LN2;
+   else
+      size = s1 + log1p(pow(2.0,s2-s1)) / M_LN2;
+
+   BddCache_insertd(&misccache, SATCOUHASH(root), root, miscid, size);
+
+   return size;
+}
+
+
+int bdd_nodecount(BDD r)
+{
+   BDD_EXCLUSIVE;
+   int num=0;
+
+   CHECK(r);
+
+   bdd_markcount(r, &num);
+   bdd_unmark(r);
+
+   return num;
+}
+
+
+int bdd_anodecount(BDD *r, int num)
+{
+   BDD_EXCLUSIVE;
+   int n;
+   int cou=0;
+
+   for (n=0 ; n<num ; n++)
+      bdd_markcount(r[n], &cou);
+
+   for (n=0 ; n<num ; n++)
+      bdd_unmark(r[n]);
+
+   return cou;
+}
+
+
+int *bdd_varprofile(BDD r)
+{
+   BDD_EXCLUSIVE;
+   CHECKa(r, NULL);
+
+   if ((varprofile=NEW(int,bddvarnum)) == NULL)
+   {
+      bdd_error(BDD_MEMORY);
+      return NULL;
+   }
+
+   memset(varprofile, 0, sizeof(int)*bddvarnum);
+   varprofile_rec(r);
+   bdd_unmark(r);
+
+   return varprofile;
+}
+
+
+static void varprofile_rec(int r)
+{
+   BddNode *node;
+
+   if (r < 2)
+      return;
+
+   node = &bddnodes[NODE(r)];
+   if (LEVELp(node) & MARKON)
+      return;
+
+   varprofile[bddlevel2var[LEVELp(node)]]++;
+   LEVELp(node) |= MARKON;
+
+   varprofile_rec(LOWp(node));
+   varprofile_rec(HIGHp(node));
+}
+
+
+double bdd_pathcount(BDD r)
+{
+   BDD_EXCLUSIVE;
+   CHECKa(r, 0.0);
+
+   miscid = CACHEID_PATHCOU;
+   SETOPSTAT(bddstat_satcount);
+
+   return pathcount_rec(r);
+}
+
+
+static double pathcount_rec(BDD r)
+{
+   BddCacheData *entry;
+   double size;
+
+   if (ISZERO(r))
+      return 0.0;
+   if (ISONE(r))
+      return 1.0;
+
+   entry = BddCache_lookup1(&misccache, PATHCOUHASH(r), r, miscid);
+   if (entry != NULL)
+      return entry->dres;
+
+   size = pathcount_rec(LOW(r)) + pathcount_rec(HIGH(r));
+
+   BddCache_insertd(&misccache, PATHCOUHASH(r), r, miscid, size);
+
+   return size;
+}
+
+
+/*************************************************************************
+  Variable set tables
+*************************************************************************/
+
+static int varset2vartable(BDD r)
+{
+   BDD n;
+
+   if (r < 2)
+      return bdd_error(BDD_VARSET);
+
+   quantvarsetID++;
+
+   if (quantvarsetID == INT_MAX)
+   {
+      memset(quantvarset, 0, sizeof(int)*bddvarnum);
+      quantvarsetID = 1;
+   }
+
+   for (n=r ; n > 1 ; n=HIGH(n))
+   {
+      quantvarset[LEVEL(n)] = quantvarsetID;
+      quantlast = LEVEL(n);
+   }
+
+   return 0;
+}
+
+
+static int varset2svartable(BDD r)
+{
+   BDD n;
+
+   if (r < 2)
+      return bdd_error(BDD_VARSET);
+
+   quantvarsetID++;
+
+   if (quantvarsetID == INT_MAX/2)
+   {
+      memset(quantvarset, 0, sizeof(int)*bddvarnum);
+      quantvarsetID = 1;
+   }
+
+   for (n=r ; !ISCONST(n) ; )
+   {
+      quantlast = LEVEL(n);
+
+      if (ISZERO(LOW(n)))
+      {
+         quantvarset[LEVEL(n)] = quantvarsetID;
+         n = HIGH(n);
+      }
+      else
+      {
+         quantvarset[LEVEL(n)] = -quantvarsetID;
+         n = LOW(n);
+      }
+   }
+
+   return 0;
+}
+
+
+/* EOF */
@@ -0,0 +1,854 @@
+/*************************************************************************
+  FILE:  bvec.cpp
+  DESCR: Boolean vector arithmetics using BDDs
+*************************************************************************/
+
+#include <stdlib.h>
+#include "kernel.h"
+#include "bvec.h"
+
+   /* The kernel calls the C entry points, not the C++ overloads that
+      the hacks at the end of bvec.h rename them to */
+#undef bvec_var
+#undef bvec_varfdd
+#undef bvec_varvec
+#undef bvec_true
+#undef bvec_false
+#undef bvec_con
+
+#define DEFAULT(v) { v.bitnum=0; v.bitvec=NULL; }
+
+
+   /* Whether val can be written with bitnum bits */
+static int bvec_fits(int bitnum, int val)
+{
+   return bitnum >= 31  ||  val < (1 << bitnum);
+}
+
+
+static BVEC bvec_build(int bitnum, int isTrue)
+{
+   BVEC vec;
+   int n;
+
+   if (bitnum <= 0)
+   {
+      DEFAULT(vec);
+      return vec;
+   }
+
+   if ((vec.bitvec=NEW(BDD,bitnum)) == NULL)
+   {
+      bdd_error(BDD_MEMORY);
+      DEFAULT(vec);
+      return vec;
+   }
+   vec.bitnum = bitnum;
+
+   for (n=0 ; n<bitnum ; n++)
+      vec.bitvec[n] = isTrue ? BDDONE : BDDZERO;
+
+   return vec;
+}
+
+
+/*************************************************************************
+  Construction
+*************************************************************************/
+
+BVEC bvec_copy(BVEC src)
+{
+   BVEC dst;
+   int n;
+
+   if (src.bitnum == 0)
+   {
+      DEFAULT(dst);
+      return dst;
+   }
+
+   dst = bvec_build(src.bitnum,0);
+
+   for (n=0 ; n<dst.bitnum ; n++)
+      dst.bitvec[n] = bdd_addref(src.bitvec[n]);
+
+   return dst;
+}
+
+
+BVEC bvec_true(int bitnum)
+{
+   return bvec_build(bitnum, 1);
+}
+
+
+BVEC bvec_false(int bitnum)
+{
+   return bvec_build(bitnum, 0);
+}
+
+
+   /* The constant val, least significant bit first */
+BVEC bvec_con(int bitnum, int val)
+{
+   BVEC v = bvec_build(bitnum,0);
+   int n;
+
+   for (n=0 ; n<v.bitnum ; n++)
+   {
+      v.bitvec[n] = (val & 0x1) ? BDDONE : BDDZERO;
+      val >>= 1;
+   }
+
+   return v;
+}
+
+
+   /* Bit n is the variable offset+n*step. The variables are never freed,
+      so the bits need no references */
+BVEC bvec_var(int bitnum, int offset, int step)
+{
+   BVEC v = bvec_build(bitnum,0);
+   int n;
+
+   for (n=0 ; n<v.bitnum ; n++)
+      v.bitvec[n] = bdd_ithvar(offset+n*step);
+
+   return v;
+}
+
+
+BVEC bvec_varfdd(int var)
+{
+   BVEC v;
+   int *bddvar = fdd_vars(var);
+   int varbitnum = fdd_varnum(var);
+   int n;
+
+   if (bddvar == NULL)
+   {
+      DEFAULT(v);
+      return v;
+   }
+
+   v = bvec_build(varbitnum,0);
+
+   for (n=0 ; n<v.bitnum ; n++)
+      v.bitvec[n] = bdd_ithvar(bddvar[n]);
+
+   return v;
+}
+
+
+BVEC bvec_varvec(int bitnum, int *var)
+{
+   BVEC v = bvec_build(bitnum,0);
+   int n;
+
+   for (n=0 ; n<v.bitnum ; n++)
+      v.bitvec[n] = bdd_ithvar(var[n]);
+
+   return v;
+}
+
+
+   /* v cut or padded with false to bitnum bits */
+BVEC bvec_coerce(int bitnum, BVEC v)
+{
+   BVEC res = bvec_build(bitnum,0);
+   int minnum = MIN(res.bitnum, v.bitnum);
+   int n;
+
+   for (n=0 ; n<minnum ; n++)
+      res.bitvec[n] = bdd_addref(v.bitvec[n]);
+
+   return res;
+}
+
+
+int bvec_isconst(BVEC e)
+{
+   int n;
+
+   for (n=0 ; n<e.bitnum ; n++)
+      if (!ISCONST(e.bitvec[n]))
+         return 0;
+
+   return 1;
+}
+
+
+   /* The value of a constant vector, 0 if it is not constant */
+int bvec_val(BVEC e)
+{
+   int n, val=0;
+
+   for (n=e.bitnum-1 ; n>=0 ; n--)
+      if (ISONE(e.bitvec[n]))
+         val = (val << 1) | 1;
+      else if (ISZERO(e.bitvec[n]))
+         val = val << 1;
+      else
+         return 0;
+
+   return val;
+}
+
+
+void bvec_free(BVEC v)
+{
+   int n;
+
+   for (n=0 ; n<v.bitnum ; n++)
+      bdd_delref(v.bitvec[n]);
+   free(v.bitvec);
+}
+
+
+BVEC bvec_addref(BVEC v)
+{
+   int n;
+
+   for (n=0 ; n<v.bitnum ; n++)
+      bdd_addref(v.bitvec[n]);
+
+   return v;
+}
+
+
+BVEC bvec_delref(BVEC v)
+{
+   int n;
+
+   for (n=0 ; n<v.bitnum ; n++)
+      bdd_delref(v.bitvec[n]);
+
+   return v;
+}
+
+
+/*************************************************************************
+  Bitwise operations
+*************************************************************************/
+
+BVEC bvec_map1(BVEC a, BDD (*fun)(BDD))
+{
+   BVEC res = bvec_build(a.bitnum,0);
+   int n;
+
+   for (n=0 ; n<res.bitnum ; n++)
+      res.bitvec[n] = bdd_addref(fun(a.bitvec[n]));
+
+   return res;
+}
+
+
+BVEC bvec_map2(BVEC a, BVEC b, BDD (*fun)(BDD,BDD))
+{
+   BVEC res;
+   int n;
+
+   if (a.bitnum != b.bitnum)
+   {
+      bdd_error(BVEC_SIZE);
+      DEFAULT(res);
+      return res;
+   }
+
+   res = bvec_build(a.bitnum,0);
+   for (n=0 ; n<res.bitnum ; n++)
+      res.bitvec[n] = bdd_addref(fun(a.bitvec[n], b.bitvec[n]));
+
+   return res;
+}
+
+
+BVEC bvec_map3(BVEC a, BVEC b, BVEC c, BDD (*fun)(BDD,BDD,BDD))
+{
+   BVEC res;
+   int n;
+
+   if (a.bitnum != b.bitnum  ||  b.bitnum != c.bitnum)
+   {
+      bdd_error(BVEC_SIZE);
+      DEFAULT(res);
+      return res;
+   }
+
+   res = bvec_build(a.bitnum,0);
+   for (n=0 ; n<res.bitnum ; n++)
+      res.bitvec[n] = bdd_addref(fun(a.bitvec[n], b.bitvec[n], c.bitvec[n]));
+
+   return res;
+}
+
+
+/*************************************************************************
+  Arithmetics
+*************************************************************************/
+
+   /* Ripple carry adder, the carry out of the top bit is dropped */
+BVEC bvec_add(BVEC l, BVEC r)
+{
+   BVEC res;
+   BDD c = BDDZERO;
+   int n;
+
+   if (l.bitnum == 0  ||  r.bitnum == 0)
+   {
+      DEFAULT(res);
+      return res;
+   }
+
+   if (l.bitnum != r.bitnum)
+   {
+      bdd_error(BVEC_SIZE);
+      DEFAULT(res);
+      return res;
+   }
+
+   res = bvec_build(l.bitnum,0);
+
+   for (n=0 ; n<res.bitnum ; n++)
+   {
+      BDD tmp1, tmp2, tmp3;
+
+         /* bitvec[n] = l[n] ^ r[n] ^ c; */
+      tmp1 = bdd_addref( bdd_apply(l.bitvec[n], r.bitvec[n], bddop_xor) );
+      tmp2 = bdd_addref( bdd_apply(tmp1, c, bddop_xor) );
+      bdd_delref(tmp1);
+      res.bitvec[n] = tmp2;
+
+         /* c = (l[n] & r[n]) | (c & (l[n] | r[n])); */
+      tmp1 = bdd_addref( bdd_apply(l.bitvec[n], r.bitvec[n], bddop_or) );
+      tmp2 = bdd_addref( bdd_apply(c, tmp1, bddop_and) );
+      bdd_delref(tmp1);
+
+      tmp1 = bdd_addref( bdd_apply(l.bitvec[n], r.bitvec[n], bddop_and) );
+      tmp3 = bdd_addref( bdd_apply(tmp1, tmp2, bddop_or) );
+      bdd_delref(tmp1);
+      bdd_delref(tmp2);
+
+      bdd_delref(c);
+      c = tmp3;
+   }
+
+   bdd_delref(c);
+   return res;
+}
+
+
+   /* l - r modulo 2^bitnum */
+BVEC bvec_sub(BVEC l, BVEC r)
+{
+   BVEC res;
+   BDD c = BDDZERO;
+   int n;
+
+   if (l.bitnum == 0  ||  r.bitnum == 0)
+   {
+      DEFAULT(res);
+      return res;
+   }
+
+   if (l.bitnum != r.bitnum)
+   {
+      bdd_error(BVEC_SIZE);
+      DEFAULT(res);
+      return res;
+   }
+
+   res = bvec_build(l.bitnum,0);
+
+   for (n=0 ; n<res.bitnum ; n++)
+   {
+      BDD tmp1, tmp2, tmp3;
+
+         /* bitvec[n] = l[n] ^ r[n] ^ c; */
+      tmp1 = bdd_addref( bdd_apply(l.bitvec[n], r.bitvec[n], bddop_xor) );
+      tmp2 = bdd_addref( bdd_apply(tmp1, c, bddop_xor) );
+      bdd_delref(tmp1);
+      res.bitvec[n] = tmp2;
+
+         /* c = (l[n] & r[n] & c) | (!l[n] & (r[n] | c)); */
+      tmp1 = bdd_addref( bdd_apply(r.bitvec[n], c, bddop_or) );
+      tmp2 = bdd_addref( bdd_apply(l.bitvec[n], tmp1, bddop_less) );
+      bdd_delref(tmp1);
+
+      tmp1 = bdd_addref( bdd_apply(l.bitvec[n], r.bitvec[n], bddop_and) );
+      tmp3 = bdd_addref( bdd_apply(tmp1, c, bddop_and) );
+      bdd_delref(tmp1);
+
+      tmp1 = bdd_addref( bdd_apply(tmp3, tmp2, bddop_or) );
+      bdd_delref(tmp2);
+      bdd_delref(tmp3);
+
+      bdd_delref(c);
+      c = tmp1;
+   }
+
+   bdd_delref(c);
+   return res;
+}
+
+
+   /* e*c modulo 2^bitnum, by shifting and adding */
+BVEC bvec_mulfixed(BVEC e, int c)
+{
+   BVEC res, next, rest;
+   int n;
+
+   if (e.bitnum == 0)
+   {
+      DEFAULT(res);
+      return res;
+   }
+
+   if (c == 0)
+      return bvec_build(e.bitnum,0);
+
+   if ((next=bvec_build(e.bitnum,0)).bitnum == 0)
+      return next;
+
+      /* next is e shifted one bit left. It only borrows the bits of e,
+         so it takes no references and is freed without bvec_free */
+   for (n=1 ; n<e.bitnum ; n++)
+      next.bitvec[n] = e.bitvec[n-1];
+
+      /* Negative factors work modulo 2^bitnum like the others */
+   rest = bvec_mulfixed(next, (int)((unsigned int)c >> 1));
+
+   if (c & 0x1)
+   {
+      res = bvec_add(e, rest);
+      bvec_free(rest);
+   }
+   else
+      res = rest;
+
+   free(next.bitvec);
+   return res;
+}
+
+
+   /* The full product, with left.bitnum+right.bitnum bits */
+BVEC bvec_mul(BVEC left, BVEC right)
+{
+   int n, m;
+   int bitnum = left.bitnum + right.bitnum;
+   BVEC res, leftshift;
+
+   if (left.bitnum == 0  ||  right.bitnum == 0)
+   {
+      DEFAULT(res);
+      return res;
+   }
+
+   res = bvec_build(bitnum,0);
+   leftshift = bvec_coerce(bitnum, left);
+
+   for (n=0 ; n<right.bitnum ; n++)
+   {
+      BVEC added = bvec_add(res, leftshift);
+
+      for (m=0 ; m<bitnum ; m++)
+      {
+         BDD tmpres = bdd_addref( bdd_ite(right.bitvec[n], added.bitvec[m],
+                                          res.bitvec[m]) );
+         bdd_delref(res.bitvec[m]);
+         res.bitvec[m] = tmpres;
+      }
+
+         /* Shift leftshift one bit left */
+      bdd_delref(leftshift.bitvec[bitnum-1]);
+      for (m=bitnum-1 ; m>=1 ; m--)
+         leftshift.bitvec[m] = leftshift.bitvec[m-1];
+      leftshift.bitvec[0] = BDDZERO;
+
+      bvec_free(added);
+   }
+
+   bvec_free(leftshift);
+   return res;
+}
+
+
+   /* Restoring division: the divisor is shifted to every bit position
+      from the top down and subtracted where it fits. The work is done
+      with twice the bits so the shifted divisor never overflows */
+int bvec_div(BVEC left, BVEC right, BVEC *result, BVEC *remainder)
+{
+   int n, m;
+   int bitnum = left.bitnum + right.bitnum;
+   BVEC rem, div, res;
+
+   if (left.bitnum == 0  ||  right.bitnum == 0  ||  left.bitnum != right.bitnum)
+      return bdd_error(BVEC_SIZE);
+
+   rem = bvec_coerce(bitnum, left);
+   div = bvec_coerce(bitnum, right);
+   res = bvec_build(left.bitnum,0);
+
+   for (n=left.bitnum-1 ; n>=0 ; n--)
+   {
+      BVEC shifted = bvec_shlfixed(div, n, BDDZERO);
+      BDD fits = bdd_addref( bvec_lte(shifted, rem) );
+      BVEC diff = bvec_sub(rem, shifted);
+
+      for (m=0 ; m<bitnum ; m++)
+      {
+         BDD tmp = bdd_addref( bdd_ite(fits, diff.bitvec[m], rem.bitvec[m]) );
+         bdd_delref(rem.bitvec[m]);
+         rem.bitvec[m] = tmp;
+      }
+
+      res.bitvec[n] = fits;
+
+      bvec_free(diff);
+      bvec_free(shifted);
+   }
+
+   *result = res;
+   *remainder = bvec_coerce(left.bitnum, rem);
+
+   bvec_free(rem);
+   bvec_free(div);
+   return 0;
+}
+
+
+int bvec_divfixed(BVEC e, int c, BVEC *res, BVEC *rem)
+{
+   BVEC divisor;
+   int err;
+
+   if (c <= 0)
+      return bdd_error(BVEC_DIVZERO);
+   if (!bvec_fits(e.bitnum, c))
+      return bdd_error(BVEC_SIZE);
+
+   divisor = bvec_con(e.bitnum, c);
+   err = bvec_div(e, divisor, res, rem);
+   bvec_free(divisor);
+
+   return err;
+}
+
+
+/*************************************************************************
+  Selection and shifts
+*************************************************************************/
+
+BVEC bvec_ite(BDD a, BVEC b, BVEC c)
+{
+   BVEC res;
+   int n;
+
+   if (b.bitnum != c.bitnum)
+   {
+      bdd_error(BVEC_SIZE);
+      DEFAULT(res);
+      return res;
+   }
+
+   res = bvec_build(b.bitnum,0);
+
+   for (n=0 ; n<res.bitnum ; n++)
+      res.bitvec[n] = bdd_addref( bdd_ite(a, b.bitvec[n], c.bitvec[n]) );
+
+   return res;
+}
+
+
+   /* e shifted pos bits towards the top, with c shifted in */
+BVEC bvec_shlfixed(BVEC e, int pos, BDD c)
+{
+   BVEC res;
+   int n, minnum;
+
+   if (pos < 0)
+   {
+      bdd_error(BVEC_SHIFT);
+      DEFAULT(res);
+      return res;
+   }
+
+   if (e.bitnum == 0)
+   {
+      DEFAULT(res);
+      return res;
+   }
+
+   minnum = MIN(e.bitnum, pos);
+   res = bvec_build(e.bitnum,0);
+
+   for (n=0 ; n<minnum ; n++)
+      res.bitvec[n] = bdd_addref(c);
+
+   for (n=minnum ; n<res.bitnum ; n++)
+      res.bitvec[n] = bdd_addref(e.bitvec[n-pos]);
+
+   return res;
+}
+
+
+   /* l shifted by the value of r, with c shifted in. Every shift that r
+      can take is selected by r == n */
+BVEC bvec_shl(BVEC l, BVEC r, BDD c)
+{
+   BVEC res, val;
+   BDD tmp1, tmp2, rEquN;
+   int n, m;
+
+   if (l.bitnum == 0  ||  r.bitnum == 0)
+   {
+      DEFAULT(res);
+      return res;
+   }
+
+   res = bvec_build(l.bitnum,0);
+
+   for (n=0 ; n<=l.bitnum  &&  bvec_fits(r.bitnum, n) ; n++)
+   {
+      val = bvec_con(r.bitnum, n);
+      rEquN = bdd_addref( bvec_equ(r, val) );
+
+      for (m=0 ; m<l.bitnum ; m++)
+      {
+            /* The m'th new bit is the (m-n)'th old one */
+         if (m-n >= 0)
+            tmp1 = bdd_addref( bdd_and(rEquN, l.bitvec[m-n]) );
+         else
+            tmp1 = bdd_addref( bdd_and(rEquN, c) );
+         tmp2 = bdd_addref( bdd_or(res.bitvec[m], tmp1) );
+         bdd_delref(tmp1);
+
+         bdd_delref(res.bitvec[m]);
+         res.bitvec[m] = tmp2;
+      }
+
+      bdd_delref(rEquN);
+      bvec_free(val);
+   }
+
+      /* Shifts past the top leave only c */
+   if (bvec_fits(r.bitnum, l.bitnum))
+   {
+      val = bvec_con(r.bitnum, l.bitnum);
+      rEquN = bdd_addref( bvec_gth(r, val) );
+      tmp1 = bdd_addref( bdd_and(rEquN, c) );
+
+      for (m=0 ; m<l.bitnum ; m++)
+      {
+         tmp2 = bdd_addref( bdd_or(res.bitvec[m], tmp1) );
+         bdd_delref(res.bitvec[m]);
+         res.bitvec[m] = tmp2;
+      }
+
+      bdd_delref(tmp1);
+      bdd_delref(rEquN);
+      bvec_free(val);
+   }
+
+   return res;
+}
+
+
+   /* e shifted pos bits towards the bottom, with c shifted in */
+BVEC bvec_shrfixed(BVEC e, int pos, BDD c)
+{
+   BVEC res;
+   int n, maxnum;
+
+   if (pos < 0)
+   {
+      bdd_error(BVEC_SHIFT);
+      DEFAULT(res);
+      return res;
+   }
+
+   if (e.bitnum == 0)
+   {
+      DEFAULT(res);
+      return res;
+   }
+
+   maxnum = MAX(0, e.bitnum-pos);
+   res = bvec_build(e.bitnum,0);
+
+   for (n=maxnum ; n<res.bitnum ; n++)
+      res.bitvec[n] = bdd_addref(c);
+
+   for (n=0 ; n<maxnum ; n++)
+      res.bitvec[n] = bdd_addref(e.bitvec[n+pos]);
+
+   return res;
+}
+
+
+BVEC bvec_shr(BVEC l, BVEC r, BDD c)
+{
+   BVEC res, val;
+   BDD tmp1, tmp2, rEquN;
+   int n, m;
+
+   if (l.bitnum == 0  ||  r.bitnum == 0)
+   {
+      DEFAULT(res);
+      return res;
+   }
+
+   res = bvec_build(l.bitnum,0);
+
+   for (n=0 ; n<=l.bitnum  &&  bvec_fits(r.bitnum, n) ; n++)
+   {
+      val = bvec_con(r.bitnum, n);
+      rEquN = bdd_addref( bvec_equ(r, val) );
+
+      for (m=0 ; m<l.bitnum ; m++)
+      {
+            /* The m'th new bit is the (m+n)'th old one */
+         if (m+n < l.bitnum)
+            tmp1 = bdd_addref( bdd_and(rEquN, l.bitvec[m+n]) );
+         else
+            tmp1 = bdd_addref( bdd_and(rEquN, c) );
+         tmp2 = bdd_addref( bdd_or(res.bitvec[m], tmp1) );
+         bdd_delref(tmp1);
+
+         bdd_delref(res.bitvec[m]);
+         res.bitvec[m] = tmp2;
+      }
+
+      bdd_delref(rEquN);
+      bvec_free(val);
+   }
+
+      /* Shifts past the bottom leave only c */
+   if (bvec_fits(r.bitnum, l.bitnum))
+   {
+      val = bvec_con(r.bitnum, l.bitnum);
+      rEquN = bdd_addref( bvec_gth(r, val) );
+      tmp1 = bdd_addref( bdd_and(rEquN, c) );
+
+      for (m=0 ; m<l.bitnum ; m++)
+      {
+         tmp2 = bdd_addref( bdd_or(res.bitvec[m], tmp1) );
+         bdd_delref(res.bitvec[m]);
+         res.bitvec[m] = tmp2;
+      }
+
+      bdd_delref(tmp1);
+      bdd_delref(rEquN);
+      bvec_free(val);
+   }
+
+   return res;
+}
+
+
+/*************************************************************************
+  Comparisons, unsigned
+*************************************************************************/
+
+   /* l < r if it holds for the bits from the bottom up to n, where p is
+      the result so far: the bit of l is below that of r, or they are
+      equal and p holds. inclusive gives l <= r */
+static BDD bvec_lessrec(BVEC l, BVEC r, int inclusive)
+{
+   BDD p = inclusive ? BDDONE : BDDZERO;
+   int n;
+
+   if (l.bitnum == 0  ||  r.bitnum == 0)
+      return BDDZERO;
+
+   if (l.bitnum != r.bitnum)
+   {
+      bdd_error(BVEC_SIZE);
+      return BDDZERO;
+   }
+
+   for (n=0 ; n<l.bitnum ; n++)
+   {
+         /* p = (!l[n] & r[n]) | (l[n] <=> r[n]) & p; */
+      BDD tmp1 = bdd_addref( bdd_apply(l.bitvec[n], r.bitvec[n], bddop_less) );
+      BDD tmp2 = bdd_addref( bdd_apply(l.bitvec[n], r.bitvec[n], bddop_biimp) );
+      BDD tmp3 = bdd_addref( bdd_apply(tmp2, p, bddop_and) );
+      BDD tmp4 = bdd_addref( bdd_apply(tmp1, tmp3, bddop_or) );
+
+      bdd_delref(tmp1);
+      bdd_delref(tmp2);
+      bdd_delref(tmp3);
+      bdd_delref(p);
+      p = tmp4;
+   }
+
+   return bdd_delref(p);
+}
+
+
+BDD bvec_lth(BVEC l, BVEC r)
+{
+   return bvec_lessrec(l, r, 0);
+}
+
+
+BDD bvec_lte(BVEC l, BVEC r)
+{
+   return bvec_lessrec(l, r, 1);
+}
+
+
+   /* Complement edges make the negations free */
+BDD bvec_gth(BVEC l, BVEC r)
+{
+   if (l.bitnum == 0  ||  r.bitnum == 0)
+      return BDDZERO;
+   return bdd_not(bvec_lte(l, r));
+}
+
+
+BDD bvec_gte(BVEC l, BVEC r)
+{
+   if (l.bitnum == 0  ||  r.bitnum == 0)
+      return BDDZERO;
+   return bdd_not(bvec_lth(l, r));
+}
+
+
+BDD bvec_equ(BVEC l, BVEC r)
+{
+   BDD p = BDDONE;
+   int n;
+
+   if (l.bitnum == 0  ||  r.bitnum == 0)
+      return BDDZERO;
+
+   if (l.bitnum != r.bitnum)
+   {
+      bdd_error(BVEC_SIZE);
+      return BDDZERO;
+   }
+
+   for (n=0 ; n<l.bitnum ; n++)
+   {
+      BDD tmp1 = bdd_addref( bdd_apply(l.bitvec[n], r.bitvec[n], bddop_biimp) );
+      BDD tmp2 = bdd_addref( bdd_apply(tmp1, p, bddop_and) );
+
+      bdd_delref(tmp1);
+      bdd_delref(p);
+      p = tmp2;
+   }
+
+   return bdd_delref(p);
+}
+
+
+BDD bvec_neq(BVEC l, BVEC r)
+{
+   if (l.bitnum == 0  ||  r.bitnum == 0)
+      return BDDZERO;
+   return bdd_not(bvec_equ(l, r));
+}
+
+
+/* EOF */
@@ -0,0 +1,110 @@
+/*************************************************************************
+  FILE:  cache.cpp
+  DESCR: Cache class for caching apply/exist etc. results
+*************************************************************************/
+
+#include <stdlib.h>
+#include <atomic>
+#include "kernel.h"
+#include "cache.h"
+
+
+int BddCache_init(BddCache *cache, int size)
+{
+   int sets, bits;
+
+      /* At least two sets so the index shift stays below 32 */
+   for (sets=2, bits=1 ; sets*BDDCACHE_WAYS < size ; sets<<=1, bits++)
+      ;
+
+   size = sets*BDDCACHE_WAYS;
+   cache->table = (BddCacheData*)aligned_alloc(sizeof(BddCacheData)*BDDCACHE_WAYS,
+                                               sizeof(BddCacheData)*size);
+   cache->locks = (unsigned char*)calloc(sets, 1);
+   if (cache->table == NULL  ||  cache->locks == NULL)
+   {
+      BddCache_done(cache);
+      return bdd_error(BDD_MEMORY);
+   }
+
+   cache->tablesize = size;
+   cache->shift = 32 - bits;
+   BddCache_reset(cache);
+
+   return 0;
+}
+
+
+void BddCache_done(BddCache *cache)
+{
+   free(cache->table);
+   free(cache->locks);
+   cache->table = NULL;
+   cache->locks = NULL;
+   cache->tablesize = 0;
+}
+
+
+int BddCache_resize(BddCache *cache, int newsize)
+{
+   BddCache_done(cache);
+
+   return BddCache_init(cache, newsize);
+}
+
+
+void BddCache_reset(BddCache *cache)
+{
+   for (int n=0 ; n<cache->tablesize ; n++)
+      cache->table[n].a = -1;
+}
+
+
+
+   /* Concurrent mode. A set is only touched while its try-lock is held,
+      and a thread that finds the lock taken does without the cache for
+      that step instead of waiting: a lookup counts as a miss and an
+      insertion is dropped. A hit is copied to storage private to the
+      thread */
+BddCacheData *BddCache_lookupmt(BddCache *cache, unsigned int hash,
+                                int a, int b, int c)
+{
+   static thread_local BddCacheData found;
+   BddCacheData *set = BddCache_set(cache, hash);
+   std::atomic_ref<unsigned char> lock(cache->locks[(set-cache->table)/BDDCACHE_WAYS]);
+
+   if (lock.exchange(1, std::memory_order_acquire) == 0)
+   {
+      for (int n=0 ; n<BDDCACHE_WAYS ; n++)
+         if (set[n].a == a  &&  set[n].b == b  &&  set[n].c == c)
+         {
+            found = *BddCache_hit(set, n);
+            lock.store(0, std::memory_order_release);
+            return &found;
+         }
+
+      lock.store(0, std::memory_order_release);
+   }
+
+   bddopstat->miss++;
+   return NULL;
+}
+
+
+void BddCache_storemt(BddCache *cache, unsigned int hash, const BddCacheData *data)
+{
+   BddCacheData *set = BddCache_set(cache, hash);
+   std::atomic_ref<unsigned char> lock(cache->locks[(set-cache->table)/BDDCACHE_WAYS]);
+
+   if (lock.exchange(1, std::memory_order_acquire) != 0)
+      return;
+
+   if (set[BDDCACHE_WAYS-1].a != -1)
+      bddopstat->evict++;
+   set[BDDCACHE_WAYS-1] = *data;
+
+   lock.store(0, std::memory_order_release);
+}
+
+
+/* EOF */
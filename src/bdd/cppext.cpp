@@ -0,0 +1,390 @@
+/*************************************************************************
+  FILE:  cppext.cpp
+  DESCR: C++ extension of the BDD package
+*************************************************************************/
+
+#include <string.h>
+#include <iomanip>
+#include "kernel.h"
+#include "bvec.h"
+
+/* Formatting objects for iostreams */
+#define IOFORMAT_SET    0
+#define IOFORMAT_TABLE  1
+#define IOFORMAT_DOT    2
+#define IOFORMAT_ALL    3
+
+int bdd_ioformat::curformat = IOFORMAT_SET;
+bdd_ioformat bddset(IOFORMAT_SET);
+bdd_ioformat bddtable(IOFORMAT_TABLE);
+bdd_ioformat bdddot(IOFORMAT_DOT);
+bdd_ioformat bddall(IOFORMAT_ALL);
+
+/* Constant true and false extension */
+const bdd bddtruepp = bdd_true();
+const bdd bddfalsepp = bdd_false();
+
+/* Reference count calls saved by moves, see bdd_stats */
+thread_local constinit std::atomic<long unsigned int> bddrefsaved(0);
+
+/* Internal prototypes */
+static void bdd_printset_rec(std::ostream&, int, int*);
+static void bdd_printdot_rec(std::ostream&, int);
+
+static bddstrmhandler strmhandler_bdd;
+
+
+/*************************************************************************
+  Setup and shutdown
+*************************************************************************/
+
+bddstrmhandler bdd_strm_hook(bddstrmhandler handler)
+{
+   bddstrmhandler old = strmhandler_bdd;
+   strmhandler_bdd = handler;
+   return old;
+}
+
+
+/*************************************************************************
+  BDD C++ functions
+*************************************************************************/
+
+bdd bdd_buildcube(int val, int width, const bdd *variables)
+{
+   BDD *var = NEW(BDD,width);
+   BDD res;
+   int n;
+
+   if (var == NULL)
+   {
+      bdd_error(BDD_MEMORY);
+      return bdd_false();
+   }
+
+   for (n=0 ; n<width ; n++)
+      var[n] = variables[n].root;
+
+   res = bdd_buildcube(val, width, var);
+
+   free(var);
+
+   return res;
+}
+
+
+int bdd_setbddpairs(bddPair *pair, int *oldvar, const bdd *newvar, int size)
+{
+   if (pair == NULL)
+      return 0;
+
+   for (int n=0,e=0 ; n<size ; n++)
+      if ((e=bdd_setbddpair(pair, oldvar[n], newvar[n].root)) < 0)
+         return e;
+
+   return 0;
+}
+
+
+int bdd_anodecountpp(const bdd *r, int num)
+{
+   BDD *cpr = NEW(BDD,num);
+   int cou;
+   int n;
+
+   if (cpr == NULL)
+      return bdd_error(BDD_MEMORY);
+
+   for (n=0 ; n<num ; n++)
+      cpr[n] = r[n].root;
+
+   cou = bdd_anodecount(cpr,num);
+
+   free(cpr);
+
+   return cou;
+}
+
+
+/*************************************************************************
+  BDD class functions
+*************************************************************************/
+
+bdd &bdd::operator=(const bdd &r)
+{
+   if (root != r.root)
+   {
+      bdd_delref(root);
+      root = r.root;
+      bdd_addref(root);
+   }
+   return *this;
+}
+
+
+bdd &bdd::operator=(int r)
+{
+   if (root != r)
+   {
+      bdd_delref(root);
+      root = r;
+      bdd_addref(root);
+   }
+   return *this;
+}
+
+
+/*************************************************************************
+  C++ iostream operators
+*************************************************************************/
+
+std::ostream &operator<<(std::ostream &o, const bdd &r)
+{
+   BDD_EXCLUSIVE;
+
+   if (bdd_ioformat::curformat == IOFORMAT_SET)
+   {
+      if (r.root < 2)
+      {
+         o << (r.root == 0 ? "F" : "T");
+         return o;
+      }
+
+      int *set = new int[bddvarnum];
+      memset(set, 0, sizeof(int) * bddvarnum);
+      bdd_printset_rec(o, r.root, set);
+      delete[] set;
+   }
+   else
+   if (bdd_ioformat::curformat == IOFORMAT_TABLE)
+   {
+      o << "ROOT: " << r.root << "\n";
+      if (r.root < 2)
+         return o;
+
+      bdd_mark(r.root);
+
+      for (int n=1 ; n<bddnodesize ; n++)
+      {
+         BddNode *node = &bddnodes[n];
+
+         if (LEVELp(node) & MARKON)
+         {
+            LEVELp(node) &= MARKOFF;
+
+            o << "[" << std::setw(5) << EDGE(n) << "] ";
+            if (strmhandler_bdd)
+               strmhandler_bdd(o,bddlevel2var[LEVELp(node)]);
+            else
+               o << std::setw(3) << bddlevel2var[LEVELp(node)];
+            o << " :";
+            o << " " << std::setw(3) << LOWp(node);
+            o << " " << std::setw(3) << HIGHp(node);
+            o << "\n";
+         }
+      }
+   }
+   else
+   if (bdd_ioformat::curformat == IOFORMAT_DOT)
+   {
+      o << "digraph G {\n";
+      o << "0 [shape=box, label=\"0\", style=filled, shape=box, height=0.3, width=0.3];\n";
+      o << "root [shape=plaintext];\n";
+      o << "root -> " << NODE(r.root) << "[style=filled"
+        << (ISCOMPL(r.root) ? ", arrowhead=odot" : "") << "];\n";
+
+      bdd_printdot_rec(o, r.root);
+
+      o << "}\n";
+
+      bdd_unmark(r.root);
+   }
+   else
+   if (bdd_ioformat::curformat == IOFORMAT_ALL)
+   {
+      for (int n=1 ; n<bddnodesize ; n++)
+      {
+         BddNode *node = &bddnodes[n];
+
+         if (LOWp(node) != -1)
+         {
+            o << "[" << std::setw(5) << EDGE(n) << "-" << std::setw(2)
+              << node->refcou << "] ";
+            if (strmhandler_bdd)
+               strmhandler_bdd(o,bddlevel2var[LEVELp(node)]);
+            else
+               o << std::setw(3) << bddlevel2var[LEVELp(node)];
+            o << ": " << std::setw(3) << LOWp(node)
+              << " " << std::setw(3) << HIGHp(node) << "\n";
+         }
+      }
+   }
+
+   return o;
+}
+
+
+static void bdd_printset_rec(std::ostream& o, int r, int* set)
+{
+   int n;
+   int first;
+
+   if (r == 0)
+      return;
+   else
+   if (r == 1)
+   {
+      o << "<";
+      first = 1;
+
+      for (n=0 ; n<bddvarnum ; n++)
+      {
+         if (set[n] > 0)
+         {
+            if (!first)
+               o << ", ";
+            first = 0;
+            if (strmhandler_bdd)
+               strmhandler_bdd(o,bddlevel2var[n]);
+            else
+               o << bddlevel2var[n];
+            o << ":" << (set[n]==2 ? 1 : 0);
+         }
+      }
+
+      o << ">";
+   }
+   else
+   {
+      set[LEVEL(r)] = 1;
+      bdd_printset_rec(o, LOW(r), set);
+
+      set[LEVEL(r)] = 2;
+      bdd_printset_rec(o, HIGH(r), set);
+
+      set[LEVEL(r)] = 0;
+   }
+}
+
+
+static void bdd_printdot_rec(std::ostream& o, int r)
+{
+   if (ISCONST(r) || MARKED(r))
+      return;
+
+   BddNode *node = &bddnodes[NODE(r)];
+
+   o << NODE(r) << "[label=\"";
+   if (strmhandler_bdd)
+      strmhandler_bdd(o,bddlevel2var[LEVEL(r)]);
+   else
+      o << bddlevel2var[LEVEL(r)];
+   o << "\"];\n";
+   o << NODE(r) << " -> " << NODE(LOWp(node)) << "[style=dotted"
+     << (ISCOMPL(LOWp(node)) ? ", arrowhead=odot" : "") << "];\n";
+   o << NODE(r) << " -> " << NODE(HIGHp(node)) << "[style=filled];\n";
+
+   SETMARK(r);
+
+   bdd_printdot_rec(o, LOWp(node));
+   bdd_printdot_rec(o, HIGHp(node));
+}
+
+
+/*************************************************************************
+  BVEC C++ functions
+*************************************************************************/
+
+void bvec::set(int bitnum, const bdd &b)
+{
+   bdd_delref(roots.bitvec[bitnum]);
+   roots.bitvec[bitnum] = b.root;
+   bdd_addref(roots.bitvec[bitnum]);
+}
+
+
+bvec bvec::operator=(const bvec &src)
+{
+   if (&src != this)
+   {
+      bvec_free(roots);
+      roots = bvec_copy(src.roots);
+   }
+   return *this;
+}
+
+
+bvec bvec_map1(const bvec &a, bdd (*fun)(const bdd &))
+{
+   bvec res = bvec_false(a.bitnum());
+   int n;
+
+   for (n=0 ; n<a.bitnum() ; n++)
+      res.set(n, fun(a[n]));
+
+   return res;
+}
+
+
+bvec bvec_map2(const bvec &a, const bvec &b,
+               bdd (*fun)(const bdd &, const bdd &))
+{
+   bvec res;
+   int n;
+
+   if (a.bitnum() != b.bitnum())
+   {
+      bdd_error(BVEC_SIZE);
+      return res;
+   }
+
+   res = bvec_false(a.bitnum());
+   for (n=0 ; n<a.bitnum() ; n++)
+      res.set(n, fun(a[n], b[n]));
+
+   return res;
+}
+
+
+bvec bvec_map3(const bvec &a, const bvec &b, const bvec &c,
+               bdd (*fun)(const bdd &, const bdd &, const bdd &))
+{
+   bvec res;
+   int n;
+
+   if (a.bitnum() != b.bitnum()  ||  b.bitnum() != c.bitnum())
+   {
+      bdd_error(BVEC_SIZE);
+      return res;
+   }
+
+   res = bvec_false(a.bitnum());
+   for (n=0 ; n<a.bitnum() ; n++)
+      res.set(n, fun(a[n], b[n], c[n]));
+
+   return res;
+}
+
+
+std::ostream &operator<<(std::ostream &o, const bvec &v)
+{
+   for (int i=0 ; i<v.bitnum() ; ++i)
+      o << "B" << i << ":\n" << v[i] << "\n";
+
+   return o;
+}
+
+
+std::ostream &operator<<(std::ostream &o, const bdd_ioformat &f)
+{
+   if (f.format == IOFORMAT_SET  ||  f.format == IOFORMAT_TABLE  ||
+       f.format == IOFORMAT_DOT  ||  f.format == IOFORMAT_ALL)
+      bdd_ioformat::curformat = f.format;
+   else
+      bdd_error(BDD_FORMAT);
+
+   return o;
+}
+
+
+/* EOF */
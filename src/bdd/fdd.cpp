@@ -0,0 +1,807 @@
+/*************************************************************************
+  FILE:  fdd.cpp
+  DESCR: Finite domain extensions to BDD package
+*************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "kernel.h"
+#include "fdd.h"
+
+   /* The kernel calls the C entry points, not the C++ overloads that
+      the hacks at the end of fdd.h rename them to */
+#undef fdd_ithvar
+#undef fdd_ithset
+#undef fdd_domain
+#undef fdd_equals
+#undef fdd_makeset
+
+
+typedef struct s_Domain
+{
+   int realsize;   /* The specified domain (0...N-1) */
+   int binsize;    /* The number of BDD variables representing the domain */
+   int *ivar;      /* Variable indices, least significant bit first */
+   BDD var;        /* BDD variable set */
+} Domain;
+
+
+static void Domain_allocate(Domain*, int);
+static void Domain_done(Domain*);
+static void fdd_printset_rec(FILE *, int, int *);
+
+static int     firstbddvar;       /* First BDD variable of the next domain */
+static int     fdvaralloc;        /* Number of allocated domains */
+static int     fdvarnum;          /* Number of defined domains */
+static Domain *domain;            /* Table of domains */
+
+static bddfilehandler filehandler;
+
+
+/*************************************************************************
+  Domain definition
+*************************************************************************/
+
+void bdd_fdd_init(void)
+{
+   domain = NULL;
+   fdvarnum = fdvaralloc = 0;
+   firstbddvar = 0;
+}
+
+
+void bdd_fdd_done(void)
+{
+   int n;
+
+   if (domain != NULL)
+   {
+      for (n=0 ; n<fdvarnum ; n++)
+         Domain_done(&domain[n]);
+      free(domain);
+   }
+
+   domain = NULL;
+   fdvarnum = fdvaralloc = 0;
+   firstbddvar = 0;
+}
+
+
+   /* Makes room for num more domains in the table */
+static int fdd_growtable(int num)
+{
+   Domain *newdomain;
+   int newalloc;
+
+   if (fdvarnum + num <= fdvaralloc)
+      return 0;
+
+   newalloc = fdvaralloc + MAX(num, fdvaralloc);
+   if ((newdomain=(Domain*)realloc(domain, sizeof(Domain)*newalloc)) == NULL)
+      return bdd_error(BDD_MEMORY);
+
+   domain = newdomain;
+   fdvaralloc = newalloc;
+   return 0;
+}
+
+
+   /* Defines num new domains with the sizes in dom. The bits of the new
+      domains are interleaved: bit 0 of every domain comes first, then
+      bit 1 and so on. The variables are taken from the first one not
+      used by an earlier domain on, bdd_setvarnum is called if needed */
+int fdd_extdomain(int *dom, int num)
+{
+   int offset = fdvarnum;
+   int binoffset;
+   int extravars = 0;
+   int n, bn, more, err;
+
+   if (!bddrunning)
+      return bdd_error(BDD_RUNNING);
+
+   for (n=0 ; n<num ; n++)
+      if (dom[n] <= 0  ||  dom[n] > INT_MAX/2)
+         return bdd_error(BDD_RANGE);
+
+   if ((err=fdd_growtable(num)) < 0)
+      return err;
+
+      /* Create bdd variable tables */
+   for (n=0 ; n<num ; n++)
+   {
+      Domain_allocate(&domain[n+fdvarnum], dom[n]);
+      if (domain[n+fdvarnum].ivar == NULL)
+      {
+         while (--n >= 0)
+            free(domain[n+fdvarnum].ivar);
+         return bdd_error(BDD_MEMORY);
+      }
+      extravars += domain[n+fdvarnum].binsize;
+   }
+
+   binoffset = firstbddvar;
+   if (firstbddvar + extravars > bddvarnum)
+   {
+      if ((err=bdd_setvarnum(firstbddvar + extravars)) < 0)
+      {
+         for (n=0 ; n<num ; n++)
+            free(domain[n+fdvarnum].ivar);
+         return err;
+      }
+   }
+
+      /* Set correct variable sequence (interleaved) */
+   for (bn=0,more=1 ; more ; bn++)
+   {
+      more = 0;
+
+      for (n=0 ; n<num ; n++)
+         if (bn < domain[n+fdvarnum].binsize)
+         {
+            more = 1;
+            domain[n+fdvarnum].ivar[bn] = binoffset++;
+         }
+   }
+
+   for (n=0 ; n<num ; n++)
+   {
+      domain[n+fdvarnum].var = bdd_makeset(domain[n+fdvarnum].ivar,
+                                           domain[n+fdvarnum].binsize);
+      bdd_addref(domain[n+fdvarnum].var);
+   }
+
+   fdvarnum += num;
+   firstbddvar += extravars;
+
+   return offset;
+}
+
+
+   /* Defines a domain that is the product of v1 and v2, reusing their
+      variables with those of v1 as the least significant bits */
+int fdd_overlapdomain(int v1, int v2)
+{
+   Domain *d;
+   int n, err;
+
+   if (!bddrunning)
+      return bdd_error(BDD_RUNNING);
+
+   if (v1 < 0  ||  v1 >= fdvarnum  ||  v2 < 0  ||  v2 >= fdvarnum)
+      return bdd_error(BDD_VAR);
+
+   if ((err=fdd_growtable(1)) < 0)
+      return err;
+
+   d = &domain[fdvarnum];
+   d->realsize = domain[v1].realsize * domain[v2].realsize;
+   d->binsize = domain[v1].binsize + domain[v2].binsize;
+   if ((d->ivar=NEW(int,d->binsize)) == NULL)
+      return bdd_error(BDD_MEMORY);
+
+   for (n=0 ; n<domain[v1].binsize ; n++)
+      d->ivar[n] = domain[v1].ivar[n];
+   for (n=0 ; n<domain[v2].binsize ; n++)
+      d->ivar[domain[v1].binsize+n] = domain[v2].ivar[n];
+
+   d->var = bdd_makeset(d->ivar, d->binsize);
+   bdd_addref(d->var);
+
+   return fdvarnum++;
+}
+
+
+void fdd_clearall(void)
+{
+   bdd_fdd_done();
+   bdd_fdd_init();
+}
+
+
+/*************************************************************************
+  Domain information
+*************************************************************************/
+
+int fdd_domainnum(void)
+{
+   if (!bddrunning)
+      return bdd_error(BDD_RUNNING);
+
+   return fdvarnum;
+}
+
+
+int fdd_domainsize(int v)
+{
+   if (!bddrunning)
+      return bdd_error(BDD_RUNNING);
+
+   if (v < 0  ||  v >= fdvarnum)
+      return bdd_error(BDD_VAR);
+   return domain[v].realsize;
+}
+
+
+int fdd_varnum(int v)
+{
+   if (!bddrunning)
+      return bdd_error(BDD_RUNNING);
+
+   if (v >= fdvarnum  ||  v < 0)
+      return bdd_error(BDD_VAR);
+   return domain[v].binsize;
+}
+
+
+   /* The variables of domain v, least significant bit first. The array
+      belongs to the domain and must not be freed */
+int *fdd_vars(int v)
+{
+   if (!bddrunning)
+   {
+      bdd_error(BDD_RUNNING);
+      return NULL;
+   }
+
+   if (v >= fdvarnum  ||  v < 0)
+   {
+      bdd_error(BDD_VAR);
+      return NULL;
+   }
+
+   return domain[v].ivar;
+}
+
+
+/*************************************************************************
+  Domain building
+*************************************************************************/
+
+   /* Conjunction of the bits of val, one cube per value */
+BDD fdd_ithvar(int var, int val)
+{
+   int n;
+   int v=1, tmp;
+
+   if (!bddrunning)
+   {
+      bdd_error(BDD_RUNNING);
+      return BDDZERO;
+   }
+
+   if (var < 0  ||  var >= fdvarnum)
+   {
+      bdd_error(BDD_VAR);
+      return BDDZERO;
+   }
+
+   if (val < 0  ||  val >= domain[var].realsize)
+   {
+      bdd_error(BDD_RANGE);
+      return BDDZERO;
+   }
+
+   for (n=0 ; n<domain[var].binsize ; n++)
+   {
+      bdd_addref(v);
+
+      if (val & 0x1)
+         tmp = bdd_apply(bdd_ithvar(domain[var].ivar[n]), v, bddop_and);
+      else
+         tmp = bdd_apply(bdd_nithvar(domain[var].ivar[n]), v, bddop_and);
+
+      bdd_delref(v);
+      v = tmp;
+      val >>= 1;
+   }
+
+   return v;
+}
+
+
+int fdd_scanvar(BDD r, int var)
+{
+   int *allvar;
+   int res;
+
+   CHECK(r);
+   if (r == BDDZERO)
+      return -1;
+   if (var < 0  ||  var >= fdvarnum)
+      return bdd_error(BDD_VAR);
+
+   if ((allvar=fdd_scanallvar(r)) == NULL)
+      return -1;
+   res = allvar[var];
+   free(allvar);
+
+   return res;
+}
+
+
+   /* The value of every domain in one satisfying assignment of r, the
+      one found by always taking the low branch when it is not false.
+      The array is allocated with malloc and indexed by domain */
+int *fdd_scanallvar(BDD r)
+{
+   BDD_EXCLUSIVE;
+   int n;
+   char *store;
+   int *res;
+   BDD p = r;
+
+   CHECKa(r,NULL);
+   if (r == BDDZERO)
+      return NULL;
+
+   if ((store=NEW(char,bddvarnum)) == NULL)
+   {
+      bdd_error(BDD_MEMORY);
+      return NULL;
+   }
+   memset(store, 0, bddvarnum);
+
+      /* LOW and HIGH follow the complement bits, so p always denotes the
+         function of the path taken so far */
+   while (!ISCONST(p))
+   {
+      if (!ISZERO(LOW(p)))
+      {
+         store[bddlevel2var[LEVEL(p)]] = 0;
+         p = LOW(p);
+      }
+      else
+      {
+         store[bddlevel2var[LEVEL(p)]] = 1;
+         p = HIGH(p);
+      }
+   }
+
+   if ((res=NEW(int,fdvarnum)) == NULL)
+   {
+      free(store);
+      bdd_error(BDD_MEMORY);
+      return NULL;
+   }
+
+   for (n=0 ; n<fdvarnum ; n++)
+   {
+      int m;
+      int val=0;
+
+      for (m=domain[n].binsize-1 ; m>=0 ; m--)
+         val = val*2 + store[domain[n].ivar[m]];
+
+      res[n] = val;
+   }
+
+   free(store);
+
+   return res;
+}
+
+
+BDD fdd_ithset(int var)
+{
+   if (!bddrunning)
+   {
+      bdd_error(BDD_RUNNING);
+      return BDDZERO;
+   }
+
+   if (var < 0  ||  var >= fdvarnum)
+   {
+      bdd_error(BDD_VAR);
+      return BDDZERO;
+   }
+
+   return domain[var].var;
+}
+
+
+   /* The values of domain var that lie in 0...size-1. Encodes V<=X-1,
+      where V is the bits of var and X the size, from the least
+      significant bit up */
+BDD fdd_domain(int var)
+{
+   int n,val;
+   Domain *dom;
+   BDD d, tmp;
+
+   if (!bddrunning)
+   {
+      bdd_error(BDD_RUNNING);
+      return BDDZERO;
+   }
+
+   if (var < 0  ||  var >= fdvarnum)
+   {
+      bdd_error(BDD_VAR);
+      return BDDZERO;
+   }
+
+   dom = &domain[var];
+   val = dom->realsize-1;
+   d = BDDONE;
+
+   for (n=0 ; n<dom->binsize ; n++)
+   {
+      bdd_addref(d);
+
+      if (val & 0x1)
+         tmp = bdd_apply(bdd_nithvar(dom->ivar[n]), d, bddop_or);
+      else
+         tmp = bdd_apply(bdd_nithvar(dom->ivar[n]), d, bddop_and);
+
+      bdd_delref(d);
+      d = tmp;
+      val >>= 1;
+   }
+
+   return d;
+}
+
+
+   /* left == right, the domains must have the same size */
+BDD fdd_equals(int left, int right)
+{
+   BDD e = BDDONE, tmp1, tmp2;
+   int n;
+
+   if (!bddrunning)
+   {
+      bdd_error(BDD_RUNNING);
+      return BDDZERO;
+   }
+
+   if (left < 0  ||  left >= fdvarnum  ||  right < 0  ||  right >= fdvarnum)
+   {
+      bdd_error(BDD_VAR);
+      return BDDZERO;
+   }
+   if (domain[left].realsize != domain[right].realsize)
+   {
+      bdd_error(BDD_RANGE);
+      return BDDZERO;
+   }
+
+   for (n=0 ; n<domain[left].binsize ; n++)
+   {
+      tmp1 = bdd_addref( bdd_apply(bdd_ithvar(domain[left].ivar[n]),
+                                   bdd_ithvar(domain[right].ivar[n]),
+                                   bddop_biimp) );
+
+      tmp2 = bdd_addref( bdd_apply(e, tmp1, bddop_and) );
+      bdd_delref(tmp1);
+      bdd_delref(e);
+      e = tmp2;
+   }
+
+   bdd_delref(e);
+   return e;
+}
+
+
+/*************************************************************************
+  File IO
+*************************************************************************/
+
+bddfilehandler fdd_file_hook(bddfilehandler handler)
+{
+   bddfilehandler old = filehandler;
+   filehandler = handler;
+   return old;
+}
+
+
+void fdd_printset(BDD r)
+{
+   CHECKn(r);
+   fdd_fprintset(stdout, r);
+}
+
+
+void fdd_fprintset(FILE *ofile, BDD r)
+{
+   BDD_EXCLUSIVE;
+   int *set;
+
+   if (!bddrunning)
+   {
+      bdd_error(BDD_RUNNING);
+      return;
+   }
+
+   if (r == BDDZERO)
+   {
+      fprintf(ofile, "F");
+      return;
+   }
+   if (r == BDDONE)
+   {
+      fprintf(ofile, "T");
+      return;
+   }
+
+   if ((set=(int *)malloc(sizeof(int)*bddvarnum)) == NULL)
+   {
+      bdd_error(BDD_MEMORY);
+      return;
+   }
+
+   memset(set, 0, sizeof(int) * bddvarnum);
+   fdd_printset_rec(ofile, r, set);
+   free(set);
+}
+
+
+   /* set[v] is 0 if v is not on the path, 1 if it is false and 2 if it
+      is true. Every domain with a variable on the path is printed with
+      the values that agree with it */
+static void fdd_printset_rec(FILE *ofile, int r, int *set)
+{
+   int n,m,i;
+   int used = 0;
+   int *var;
+   int ok, first;
+
+   if (r == BDDZERO)
+      return;
+   else
+   if (r == BDDONE)
+   {
+      fprintf(ofile, "<");
+      first=1;
+
+      for (n=0 ; n<fdvarnum ; n++)
+      {
+         int firstval=1;
+         used = 0;
+
+         for (m=0 ; m<domain[n].binsize ; m++)
+            if (set[domain[n].ivar[m]] != 0)
+               used = 1;
+
+         if (used)
+         {
+            if (!first)
+               fprintf(ofile, ", ");
+            first = 0;
+            if (filehandler)
+               filehandler(ofile, n);
+            else
+               fprintf(ofile, "%d", n);
+            fprintf(ofile, ":");
+
+            var = domain[n].ivar;
+
+            for (m=0 ; m<(1<<domain[n].binsize) ; m++)
+            {
+               ok=1;
+
+               for (i=0 ; i<domain[n].binsize && ok ; i++)
+                  if (set[var[i]] == 1  &&  ((m >> i) & 0x1) != 0)
+                     ok = 0;
+                  else
+                  if (set[var[i]] == 2  &&  ((m >> i) & 0x1) != 1)
+                     ok = 0;
+
+               if (ok)
+               {
+                  if (firstval)
+                     fprintf(ofile, "%d", m);
+                  else
+                     fprintf(ofile, "/%d", m);
+                  firstval = 0;
+               }
+            }
+         }
+      }
+
+      fprintf(ofile, ">");
+   }
+   else
+   {
+      set[bddlevel2var[LEVEL(r)]] = 1;
+      fdd_printset_rec(ofile, LOW(r), set);
+
+      set[bddlevel2var[LEVEL(r)]] = 2;
+      fdd_printset_rec(ofile, HIGH(r), set);
+
+      set[bddlevel2var[LEVEL(r)]] = 0;
+   }
+}
+
+
+/*************************************************************************
+  Domain sets
+*************************************************************************/
+
+   /* The domains with at least one variable in the variable set r */
+int fdd_scanset(BDD r, int **varset, int *varnum)
+{
+   int *fv, fn;
+   int num,n,m,i;
+
+   if (!bddrunning)
+      return bdd_error(BDD_RUNNING);
+
+   if ((n=bdd_scanset(r, &fv, &fn)) < 0)
+      return n;
+
+   for (n=0,num=0 ; n<fdvarnum ; n++)
+   {
+      int found=0;
+
+      for (m=0 ; m<domain[n].binsize && !found ; m++)
+         for (i=0 ; i<fn && !found ; i++)
+            if (domain[n].ivar[m] == fv[i])
+            {
+               num++;
+               found=1;
+            }
+   }
+
+   if ((*varset=(int*)malloc(sizeof(int)*MAX(num,1))) == NULL)
+   {
+      free(fv);
+      return bdd_error(BDD_MEMORY);
+   }
+
+   for (n=0,num=0 ; n<fdvarnum ; n++)
+   {
+      int found=0;
+
+      for (m=0 ; m<domain[n].binsize && !found ; m++)
+         for (i=0 ; i<fn && !found ; i++)
+            if (domain[n].ivar[m] == fv[i])
+            {
+               (*varset)[num++] = n;
+               found=1;
+            }
+   }
+
+   *varnum = num;
+   free(fv);
+
+   return 0;
+}
+
+
+   /* The variable set of all the bits of the given domains */
+BDD fdd_makeset(int *varset, int varnum)
+{
+   BDD res=BDDONE, tmp;
+   int n;
+
+   if (!bddrunning)
+   {
+      bdd_error(BDD_RUNNING);
+      return BDDZERO;
+   }
+
+   for (n=0 ; n<varnum ; n++)
+      if (varset[n] < 0  ||  varset[n] >= fdvarnum)
+      {
+         bdd_error(BDD_VAR);
+         return BDDZERO;
+      }
+
+   for (n=0 ; n<varnum ; n++)
+   {
+      bdd_addref(res);
+      tmp = bdd_apply(domain[varset[n]].var, res, bddop_and);
+      bdd_delref(res);
+      res = tmp;
+   }
+
+   return res;
+}
+
+
+   /* Adds a variable block for the bits of the domains first...last.
+      Domains defined in one call to fdd_extdomain are interleaved, so
+      their block keeps them together while reordering may move the
+      block as a whole, or their bits inside it unless fixed */
+int fdd_intaddvarblock(int first, int last, int fixed)
+{
+   BDD res = BDDONE, tmp;
+   int n, err;
+
+   if (!bddrunning)
+      return bdd_error(BDD_RUNNING);
+
+   if (first > last  ||  first < 0  ||  last >= fdvarnum)
+      return bdd_error(BDD_VARBLK);
+
+   for (n=first ; n<=last ; n++)
+   {
+      bdd_addref(res);
+      tmp = bdd_apply(domain[n].var, res, bddop_and);
+      bdd_delref(res);
+      res = tmp;
+   }
+
+   bdd_addref(res);
+   err = bdd_addvarblock(res, fixed);
+   bdd_delref(res);
+
+   return err;
+}
+
+
+/*************************************************************************
+  Pairs
+*************************************************************************/
+
+int fdd_setpair(bddPair *pair, int p1, int p2)
+{
+   int n,e;
+
+   if (!bddrunning)
+      return bdd_error(BDD_RUNNING);
+
+   if (p1<0 || p1>=fdvarnum || p2<0 || p2>=fdvarnum)
+      return bdd_error(BDD_VAR);
+
+   if (domain[p1].binsize != domain[p2].binsize)
+      return bdd_error(BDD_VARNUM);
+
+   for (n=0 ; n<domain[p1].binsize ; n++)
+      if ((e=bdd_setpair(pair, domain[p1].ivar[n], domain[p2].ivar[n])) < 0)
+         return e;
+
+   return 0;
+}
+
+
+int fdd_setpairs(bddPair *pair, int *p1, int *p2, int size)
+{
+   int n,e;
+
+   if (!bddrunning)
+      return bdd_error(BDD_RUNNING);
+
+   for (n=0 ; n<size ; n++)
+      if (p1[n]<0 || p1[n]>=fdvarnum || p2[n]<0 || p2[n]>=fdvarnum)
+         return bdd_error(BDD_VAR);
+
+   for (n=0 ; n<size ; n++)
+      if ((e=fdd_setpair(pair, p1[n], p2[n])) < 0)
+         return e;
+
+   return 0;
+}
+
+
+/*************************************************************************
+  Domain helpers
+*************************************************************************/
+
+static void Domain_allocate(Domain* d, int range)
+{
+   int calcsize = 2;
+
+   d->realsize = range;
+   d->binsize = 1;
+
+   while (calcsize < range)
+   {
+      d->binsize++;
+      calcsize <<= 1;
+   }
+
+   d->ivar = NEW(int,d->binsize);
+   d->var = BDDONE;
+}
+
+
+static void Domain_done(Domain* d)
+{
+   free(d->ivar);
+   bdd_delref(d->var);
+}
+
+
+/* EOF */
@@ -0,0 +1,103 @@
+/*************************************************************************
+  FILE:  imatrix.cpp
+  DESCR: Interaction matrix, one bit per pair of variables
+*************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "kernel.h"
+#include "imatrix.h"
+
+
+imatrix* imatrixNew(int size)
+{
+   imatrix *mtx = NEW(imatrix,1);
+   int n,m;
+
+   if (mtx == NULL)
+      return NULL;
+
+   if ((mtx->rows=NEW(char*,size)) == NULL)
+   {
+      free(mtx);
+      return NULL;
+   }
+
+   for (n=0 ; n<size ; n++)
+   {
+      if ((mtx->rows[n]=NEW(char,size/8+1)) == NULL)
+      {
+         for (m=0 ; m<n ; m++)
+            free(mtx->rows[m]);
+         free(mtx->rows);
+         free(mtx);
+         return NULL;
+      }
+
+      memset(mtx->rows[n], 0, size/8+1);
+   }
+
+   mtx->size = size;
+   return mtx;
+}
+
+
+void imatrixDelete(imatrix *mtx)
+{
+   int n;
+
+   if (mtx == NULL)
+      return;
+
+   for (n=0 ; n<mtx->size ; n++)
+      free(mtx->rows[n]);
+   free(mtx->rows);
+   free(mtx);
+}
+
+
+void imatrixFPrint(imatrix *mtx, FILE *ofile)
+{
+   int x,y;
+
+   fprintf(ofile, "    ");
+   for (x=0 ; x<mtx->size ; x++)
+      fprintf(ofile, "%c", x < 26 ? x+'a' : x-26+'A');
+   fprintf(ofile, "\n");
+
+   for (y=0 ; y<mtx->size ; y++)
+   {
+      fprintf(ofile, "%2d %c", y, y < 26 ? y+'a' : y-26+'A');
+      for (x=0 ; x<mtx->size ; x++)
+         fprintf(ofile, "%c", imatrixDepends(mtx,y,x) ? 'x' : ' ');
+      fprintf(ofile, "\n");
+   }
+}
+
+
+void imatrixPrint(imatrix *mtx)
+{
+   imatrixFPrint(mtx, stdout);
+}
+
+
+void imatrixSet(imatrix *mtx, int a, int b)
+{
+   mtx->rows[a][b/8] |= 1<<(b%8);
+}
+
+
+void imatrixClr(imatrix *mtx, int a, int b)
+{
+   mtx->rows[a][b/8] &= ~(1<<(b%8));
+}
+
+
+int imatrixDepends(imatrix *mtx, int a, int b)
+{
+   return mtx->rows[a][b/8] & (1<<(b%8));
+}
+
+
+/* EOF */
@@ -0,0 +1,1592 @@
+/*************************************************************************
+  FILE:  kernel.cpp
+  DESCR: Node table, unique hashing, reference counting and garbage
+         collection for the in-tree BDD engine
+*************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "kernel.h"
+#include "cache.h"
+#include "prime.h"
+
+/*************************************************************************
+  Various definitions and global variables
+*************************************************************************/
+
+#define VERSION 22
+
+   /* Minimal percentage of free nodes after a garbage collection before
+      the node table is grown */
+#define DEFAULTMINFREE 20
+
+   /* After a resize the old nodes are moved to the new unique table
+      this many times faster than the new nodes are used up */
+#define REHASHSPEED 32
+
+   /* Fewest nodes each thread gets in a parallel garbage collection */
+#define GBCMINPART 65536
+
+   /* Hash value of a node with the given level and children */
+#define NODEHASH(lvl,l,h) (TRIPLE(lvl,l,h) % bddnodesize)
+#define OLDHASH(lvl,l,h) (TRIPLE(lvl,l,h) % bddoldhashsize)
+
+   /* Number of locks striped over the unique table in concurrent mode,
+      and number of free nodes a thread takes from the free list at once */
+#define NODESTRIPES 1024
+#define NODECHUNK   256
+
+typedef struct alignas(64) s_BddSpinlock
+{
+   std::atomic_flag flag;
+} BddSpinlock;
+
+int          bddrunning;            /* Flag - package initialized */
+int          bdderrorcond;          /* Some error condition */
+int          bddnodesize;           /* Number of allocated nodes */
+int          bddmaxnodesize;        /* Maximum allowed number of nodes */
+int          bddmaxnodeincrease;    /* Max. # of nodes used to inc. table */
+BddNode*     bddnodes;              /* All of the bdd nodes */
+int          bddvarnum;             /* Number of defined BDD variables */
+int*         bddvar2level;          /* Variable -> level table */
+int*         bddlevel2var;          /* Level -> variable table */
+int          bddresized;            /* Flag indicating a resize of the nodetable */
+int*         bddhash;               /* First node in each unique table chain */
+int*         bddnext;               /* Next node in unique chain or free list */
+int          bddfreepos;            /* First free node */
+int          bddfreenum;            /* Number of free nodes */
+int          bddconcurrent;         /* Flag - concurrent apply enabled */
+int          bddgeneration=1;       /* Bumped when refstacks must regrow */
+std::shared_mutex bddkernellock;    /* Shared by apply, exclusive else */
+
+thread_local constinit int* bddrefstack = NULL;     /* Node reference stack */
+thread_local constinit int* bddrefstacktop = NULL;  /* - and its top */
+thread_local constinit int  bddrefstackgen = 0;     /* Generation of stack */
+thread_local constinit int  bddinexclusive = 0;     /* Holds kernel lock */
+thread_local constinit BddThread* bddthread = NULL; /* Context of thread */
+thread_local constinit bddOpCacheStat* bddopstat = NULL; /* Charged counters */
+
+static int*  bddoldhash;           /* Chains from before the last resize */
+static int*  bddoldnext;           /* - and their links */
+static int   bddoldhashsize;        /* - their number, 0 when all moved */
+static int   bddrehashpos;          /* First old node not moved yet */
+static int   bddrehashstep;         /* Old nodes moved per new node */
+static int   bddrefstackneed;       /* Size of the reference stacks */
+static BddThread* bddthreads;       /* Contexts of all threads ever seen */
+static std::mutex bddthreadlock;    /* Guards bddthreads */
+static std::mutex bddfreelock;      /* Guards the free list when concurrent */
+static BddSpinlock bddstripes[NODESTRIPES]; /* Guard the unique chains */
+static int*  bddvarset;             /* Set of defined BDD variables */
+static int   gbcollectnum;          /* Number of garbage collections */
+static int   cachesize;             /* Size of the operator caches */
+static long  gbcclock;              /* Clock ticks used in GBC */
+static int   minfreenodes=DEFAULTMINFREE;
+static int   gbcthreads=1;          /* Threads used by garbage collections */
+
+static bddinthandler  err_handler;
+static bddgbchandler  gbc_handler;
+static bdd2inthandler resize_handler;
+
+static void bdd_rehash_done(void);
+static void bdd_rehash_step(int);
+
+static const char *opstatnames[BDDSTAT_NUM] =
+{ "and", "or", "xor", "apply", "not", "ite", "exist", "appex",
+  "replace", "cofactor", "satcount" };
+
+static const char *errorstrings[BDD_ERRNUM] =
+{ "Out of memory", "Unknown variable", "Value out of range",
+  "Unknown BDD root dereferenced", "bdd_init() called twice",
+  "File operation failed", "Incorrect file format",
+  "Variables not in ascending order", "User called break",
+  "Mismatch in size of variable sets",
+  "Cannot allocate fewer nodes than already in use",
+  "Unknown operator", "Illegal variable set",
+  "Bad variable block operation",
+  "Trying to decrease the number of variables",
+  "Trying to replace with variables already in the bdd",
+  "Number of nodes reached user defined maximum",
+  "Unknown BDD - was not in node table",
+  "Bad size argument",
+  "Mismatch in bitvector size",
+  "Illegal shift-left/right parameter",
+  "Division by zero" };
+
+
+/*************************************************************************
+  Initialization and shutdown
+*************************************************************************/
+
+int bdd_init(int initnodesize, int cs)
+{
+   int n;
+
+   if (bddrunning)
+      return bdd_error(BDD_RUNNING);
+
+   bddnodesize = bdd_prime_gte(initnodesize);
+
+   bddnodes = (BddNode*)aligned_alloc(alignof(BddNode), sizeof(BddNode)*bddnodesize);
+   bddhash = NEW(int,bddnodesize);
+   bddnext = NEW(int,bddnodesize);
+   if (bddnodes == NULL  ||  bddhash == NULL  ||  bddnext == NULL)
+   {
+      bdd_done();
+      return bdd_error(BDD_MEMORY);
+   }
+
+   bddresized = 0;
+
+   for (n=0 ; n<bddnodesize ; n++)
+   {
+      bddnodes[n].refcou = 0;
+      bddnodes[n].low = -1;
+      bddhash[n] = 0;
+      bddnodes[n].level = 0;
+      bddnext[n] = n+1;
+   }
+   bddnext[bddnodesize-1] = 0;
+
+      /* Node 0 is the only terminal: edge 0 is false and edge 1 true */
+   bddnodes[0].refcou = MAXREF;
+   bddnodes[0].low = bddnodes[0].high = 0;
+
+   if ((n=bdd_operator_init(cs)) < 0)
+   {
+      bdd_done();
+      return n;
+   }
+
+   bddfreepos = 1;
+   bddfreenum = bddnodesize-1;
+   bddrunning = 1;
+   bddvarnum = 0;
+   gbcollectnum = 0;
+   gbcclock = 0;
+   cachesize = cs;
+   bddmaxnodesize = 0;
+   bddmaxnodeincrease = DEFAULTMAXNODEINC;
+   bdderrorcond = 0;
+   bddconcurrent = 0;
+   bddrefstackneed = 0;
+   bddgeneration++;
+
+   {
+      std::lock_guard<std::mutex> lock(bddthreadlock);
+      for (BddThread *t=bddthreads ; t!=NULL ; t=t->next)
+      {
+         memset(&t->stats, 0, sizeof(bddCacheStat));
+         t->produced = 0;
+         t->refcalls = t->refsaved = 0;
+         if (t->refsavedtls != NULL)
+            t->refsavedtls->store(0, std::memory_order_relaxed);
+         t->freepos = t->freenum = 0;
+         t->lastres = 0;
+      }
+   }
+   SETOPSTAT(bddstat_apply);
+
+   err_handler = bdd_default_errhandler;
+   gbc_handler = bdd_default_gbchandler;
+   resize_handler = NULL;
+
+   bdd_pairs_init();
+   bdd_reorder_init();
+   bdd_fdd_init();
+
+   return 0;
+}
+
+
+void bdd_done(void)
+{
+      /* The domains hold references, drop them while the nodes exist */
+   bdd_fdd_done();
+   bdd_operator_done();
+   bdd_pairs_done();
+   bdd_reorder_done();
+
+   free(bddnodes);
+   free(bddhash);
+   free(bddnext);
+   free(bddoldhash);
+   free(bddoldnext);
+   free(bddvarset);
+   free(bddvar2level);
+   free(bddlevel2var);
+
+   bddnodes = NULL;
+   bddhash = NULL;
+   bddnext = NULL;
+   bddoldhash = bddoldnext = NULL;
+   bddoldhashsize = bddrehashpos = 0;
+   bddvarset = NULL;
+   bddvar2level = NULL;
+   bddlevel2var = NULL;
+
+   bddrunning = 0;
+   bddnodesize = 0;
+   bddvarnum = 0;
+   bddconcurrent = 0;
+
+      /* Threads pick up new stacks through bddgeneration */
+   {
+      std::lock_guard<std::mutex> lock(bddthreadlock);
+      for (BddThread *t=bddthreads ; t!=NULL ; t=t->next)
+      {
+         free(t->refstack);
+         t->refstack = NULL;
+         t->refstacksize = 0;
+      }
+   }
+   bddrefstack = bddrefstacktop = NULL;
+   bddgeneration++;
+}
+
+
+   /* Folds the saved reference calls counted in thread local storage
+      into the context when the thread exits */
+class BddThreadExit
+{
+ public:
+   ~BddThreadExit(void)
+   {
+      std::lock_guard<std::mutex> lock(bddthreadlock);
+      bddthread->refsaved += bddrefsaved.load(std::memory_order_relaxed);
+      bddthread->refsavedtls = NULL;
+   }
+};
+
+
+   /* Creates the context of the calling thread on first use and makes
+      sure its reference stack can hold bddrefstackneed entries */
+BddThread *bdd_threadinit(void)
+{
+   BddThread *t = bddthread;
+
+   if (t == NULL)
+   {
+      if ((t=(BddThread*)calloc(1, sizeof(BddThread))) == NULL)
+      {
+         bdd_error(BDD_MEMORY);
+         abort();
+      }
+
+      std::lock_guard<std::mutex> lock(bddthreadlock);
+      t->refsavedtls = &bddrefsaved;
+      t->next = bddthreads;
+      bddthreads = t;
+      bddthread = t;
+
+      static thread_local BddThreadExit threadexit;
+      (void)threadexit;
+   }
+
+   if (t->refstacksize < bddrefstackneed)
+   {
+      int *stack = (int*)realloc(t->refstack, sizeof(int)*bddrefstackneed);
+      if (stack == NULL)
+      {
+         bdd_error(BDD_MEMORY);
+         abort();
+      }
+      t->refstack = stack;
+      t->refstacksize = bddrefstackneed;
+   }
+
+   bddrefstack = t->refstack;
+   bddrefstackgen = bddgeneration;
+   return t;
+}
+
+
+
+int bdd_setvarnum(int num)
+{
+   int bdv;
+   int oldbddvarnum = bddvarnum;
+
+   if (num < 1  ||  num > MAXVAR)
+      return bdd_error(BDD_RANGE);
+
+   if (num < bddvarnum)
+      return bdd_error(BDD_DECVNUM);
+   if (num == bddvarnum)
+      return 0;
+
+   if ((bddvarset=(int*)realloc(bddvarset,sizeof(int)*num*2)) == NULL)
+      return bdd_error(BDD_MEMORY);
+   if ((bddlevel2var=(int*)realloc(bddlevel2var,sizeof(int)*(num+1))) == NULL)
+      return bdd_error(BDD_MEMORY);
+   if ((bddvar2level=(int*)realloc(bddvar2level,sizeof(int)*(num+1))) == NULL)
+      return bdd_error(BDD_MEMORY);
+
+      /* Recursive operators push at most two results per level, and some
+         of them (appex, veccompose) run a second operator on top of that */
+   bddrefstackneed = num*4+4;
+   bddgeneration++;
+   INITREF;
+
+   for (bdv=bddvarnum ; bddvarnum < num ; bddvarnum++)
+   {
+      bddvarset[bddvarnum*2] = PUSHREF( bdd_makenode(bddvarnum, 0, 1) );
+      bddvarset[bddvarnum*2+1] = bdd_makenode(bddvarnum, 1, 0);
+      POPREF(1);
+
+      if (bdderrorcond)
+      {
+         bddvarnum = bdv;
+         return -bdderrorcond;
+      }
+
+         /* The variable and its negation are two edges to one node */
+      bddnodes[NODE(bddvarset[bddvarnum*2])].refcou = MAXREF;
+      bddlevel2var[bddvarnum] = bddvarnum;
+      bddvar2level[bddvarnum] = bddvarnum;
+   }
+
+   bddnodes[0].level = num;
+   bddvar2level[num] = num;
+   bddlevel2var[num] = num;
+
+   bdd_pairs_resize(oldbddvarnum, bddvarnum);
+   bdd_operator_varresize();
+
+   return 0;
+}
+
+
+int bdd_extvarnum(int num)
+{
+   int start = bddvarnum;
+
+   if (num < 0  ||  num > 0x3FFFFFFF)
+      return bdd_error(BDD_RANGE);
+
+   bdd_setvarnum(bddvarnum+num);
+   return start;
+}
+
+
+/*************************************************************************
+  Hooks and error handling
+*************************************************************************/
+
+bddinthandler bdd_error_hook(bddinthandler handler)
+{
+   bddinthandler tmp = err_handler;
+   err_handler = handler;
+   return tmp;
+}
+
+
+bddgbchandler bdd_gbc_hook(bddgbchandler handler)
+{
+   bddgbchandler tmp = gbc_handler;
+   gbc_handler = handler;
+   return tmp;
+}
+
+
+bdd2inthandler bdd_resize_hook(bdd2inthandler handler)
+{
+   bdd2inthandler tmp = resize_handler;
+   resize_handler = handler;
+   return tmp;
+}
+
+
+void bdd_default_errhandler(int e)
+{
+   fprintf(stderr, "BDD error: %s\n", bdd_errstring(e));
+   exit(1);
+}
+
+
+void bdd_default_gbchandler(int pre, bddGbcStat *s)
+{
+   if (!pre)
+   {
+      printf("Garbage collection #%d: %d nodes / %d free",
+             s->num, s->nodes, s->freenodes);
+      printf(" / %.1fs / %.1fs total\n",
+             (float)s->time/(float)(CLOCKS_PER_SEC),
+             (float)s->sumtime/(float)CLOCKS_PER_SEC);
+   }
+}
+
+
+const char *bdd_errstring(int e)
+{
+   e = abs(e);
+   if (e<1 || e>BDD_ERRNUM)
+      return NULL;
+   return errorstrings[e-1];
+}
+
+
+void bdd_clear_error(void)
+{
+   bdderrorcond = 0;
+}
+
+
+int bdd_error(int e)
+{
+   if (err_handler != NULL)
+      err_handler(e);
+
+   bdderrorcond = abs(e);
+   return e;
+}
+
+
+/*************************************************************************
+  Settings and statistics
+*************************************************************************/
+
+int bdd_isrunning(void)
+{
+   return bddrunning;
+}
+
+
+char *bdd_versionstr(void)
+{
+   static char str[] = "matlogic BDD engine 2.2";
+   return str;
+}
+
+
+int bdd_versionnum(void)
+{
+   return VERSION;
+}
+
+
+int bdd_setmaxnodenum(int size)
+{
+   if (size > bddnodesize  ||  size == 0)
+   {
+      int old = bddmaxnodesize;
+      bddmaxnodesize = size;
+      return old;
+   }
+
+   return bdd_error(BDD_NODES);
+}
+
+
+int bdd_setminfreenodes(int mf)
+{
+   int old = minfreenodes;
+
+   if (mf<0 || mf>100)
+      return bdd_error(BDD_RANGE);
+
+   minfreenodes = mf;
+   return old;
+}
+
+
+   /* Lets garbage collections of large tables mark and sweep the node
+      table in num threads at once */
+int bdd_setgbcthreads(int num)
+{
+   int old = gbcthreads;
+
+   if (num < 1)
+      return bdd_error(BDD_RANGE);
+
+   gbcthreads = num;
+   return old;
+}
+
+
+   /* Concurrent mode lets apply and ite be called from several threads
+      at once. It must only be switched while no operator is running */
+int bdd_setconcurrent(int on)
+{
+   int old = bddconcurrent;
+
+   if (old  &&  !on)
+   {
+         /* Hand the private chunks back to the free list and forget the
+            results that no longer need protection */
+      std::lock_guard<std::mutex> lock(bddthreadlock);
+      for (BddThread *t=bddthreads ; t!=NULL ; t=t->next)
+      {
+         while (t->freepos != 0)
+         {
+            int n = t->freepos;
+            t->freepos = bddnext[n];
+            bddnext[n] = bddfreepos;
+            bddfreepos = n;
+            bddfreenum++;
+         }
+         t->freenum = 0;
+         t->lastres = 0;
+      }
+   }
+
+      /* The concurrent unique table only knows the current chains */
+   if (on)
+      bdd_rehash_step(bddoldhashsize);
+
+   bddconcurrent = on ? 1 : 0;
+   return old;
+}
+
+
+   /* Whether operators may currently be called from several threads */
+int bdd_isconcurrent(void)
+{
+   return bddconcurrent;
+}
+
+
+int bdd_setmaxincrease(int size)
+{
+   int old = bddmaxnodeincrease;
+
+   if (size < 0)
+      return bdd_error(BDD_SIZE);
+
+   bddmaxnodeincrease = size;
+   return old;
+}
+
+
+int bdd_getnodenum(void)
+{
+   return bddnodesize - bddfreenum;
+}
+
+
+int bdd_getallocnum(void)
+{
+   return bddnodesize;
+}
+
+
+void bdd_stats(bddStat *s)
+{
+   std::lock_guard<std::mutex> lock(bddthreadlock);
+
+   s->produced = 0;
+   s->refcalls = s->refsaved = 0;
+   for (BddThread *t=bddthreads ; t!=NULL ; t=t->next)
+   {
+      s->produced += t->produced;
+      s->refcalls += t->refcalls;
+      s->refsaved += t->refsaved;
+      if (t->refsavedtls != NULL)
+         s->refsaved += t->refsavedtls->load(std::memory_order_relaxed);
+   }
+   s->nodenum = bddnodesize;
+   s->maxnodenum = bddmaxnodesize;
+   s->freenodes = bddfreenum;
+   s->minfreenodes = minfreenodes;
+   s->varnum = bddvarnum;
+   s->cachesize = cachesize;
+   s->gbcnum = gbcollectnum;
+}
+
+
+void bdd_cachestats(bddCacheStat *s)
+{
+   std::lock_guard<std::mutex> lock(bddthreadlock);
+
+   memset(s, 0, sizeof(bddCacheStat));
+   for (BddThread *t=bddthreads ; t!=NULL ; t=t->next)
+   {
+      s->uniqueAccess += t->stats.uniqueAccess;
+      s->uniqueChain += t->stats.uniqueChain;
+      s->uniqueHit += t->stats.uniqueHit;
+      s->uniqueMiss += t->stats.uniqueMiss;
+      s->swapCount += t->stats.swapCount;
+
+      for (int n=0 ; n<BDDSTAT_NUM ; n++)
+      {
+         s->op[n].hit += t->stats.op[n].hit;
+         s->op[n].miss += t->stats.op[n].miss;
+         s->op[n].evict += t->stats.op[n].evict;
+      }
+   }
+
+      /* The operator caches only keep the per operator counters */
+   for (int n=0 ; n<BDDSTAT_NUM ; n++)
+   {
+      s->opHit += s->op[n].hit;
+      s->opMiss += s->op[n].miss;
+   }
+}
+
+
+void bdd_fprintstat(FILE *ofile)
+{
+   bddCacheStat s;
+   bdd_cachestats(&s);
+
+   fprintf(ofile, "\nCache statistics\n");
+   fprintf(ofile, "----------------\n");
+
+   fprintf(ofile, "Unique Access:  %ld\n", s.uniqueAccess);
+   fprintf(ofile, "Unique Chain:   %ld\n", s.uniqueChain);
+   fprintf(ofile, "Unique Hit:     %ld\n", s.uniqueHit);
+   fprintf(ofile, "Unique Miss:    %ld\n", s.uniqueMiss);
+   fprintf(ofile, "=> Hit rate =   %.2f\n",
+           (s.uniqueHit+s.uniqueMiss > 0) ?
+           ((float)s.uniqueHit)/((float)s.uniqueHit+s.uniqueMiss) : 0);
+   fprintf(ofile, "Operator Hits:  %ld\n", s.opHit);
+   fprintf(ofile, "Operator Miss:  %ld\n", s.opMiss);
+   fprintf(ofile, "=> Hit rate =   %.2f\n",
+           (s.opHit+s.opMiss > 0) ?
+           ((float)s.opHit)/((float)s.opHit+s.opMiss) : 0);
+   fprintf(ofile, "Swap count =    %ld\n", s.swapCount);
+
+   fprintf(ofile, "\nOperator          Hits       Miss      Evict  Hit rate\n");
+   for (int n=0 ; n<BDDSTAT_NUM ; n++)
+   {
+      bddOpCacheStat *o = &s.op[n];
+      fprintf(ofile, "%-10s %10ld %10ld %10ld  %8.2f\n", opstatnames[n],
+              o->hit, o->miss, o->evict,
+              (o->hit+o->miss > 0) ? ((float)o->hit)/((float)o->hit+o->miss) : 0);
+   }
+}
+
+
+void bdd_printstat(void)
+{
+   bdd_fprintstat(stdout);
+}
+
+
+/*************************************************************************
+  BDD primitives
+*************************************************************************/
+
+int bdd_varnum(void)
+{
+   return bddvarnum;
+}
+
+
+BDD bdd_ithvar(int var)
+{
+   if (var < 0  ||  var >= bddvarnum)
+   {
+      bdd_error(BDD_VAR);
+      return BDDZERO;
+   }
+
+   return bddvarset[var*2];
+}
+
+
+BDD bdd_nithvar(int var)
+{
+   if (var < 0  ||  var >= bddvarnum)
+   {
+      bdd_error(BDD_VAR);
+      return BDDZERO;
+   }
+
+   return bddvarset[var*2+1];
+}
+
+
+int bdd_var(BDD root)
+{
+   BDD_EXCLUSIVE;
+
+   CHECK(root);
+   if (root < 2)
+      return bdd_error(BDD_ILLBDD);
+
+   return bddlevel2var[LEVEL(root)];
+}
+
+
+BDD bdd_low(BDD root)
+{
+   BDD_EXCLUSIVE;
+
+   CHECK(root);
+   if (root < 2)
+      return bdd_error(BDD_ILLBDD);
+
+   return LOW(root);
+}
+
+
+BDD bdd_high(BDD root)
+{
+   BDD_EXCLUSIVE;
+
+   CHECK(root);
+   if (root < 2)
+      return bdd_error(BDD_ILLBDD);
+
+   return HIGH(root);
+}
+
+
+int bdd_varlevel(int var)
+{
+   if (var < 0  ||  var >= bddvarnum)
+      return bdd_error(BDD_VAR);
+
+   return bddvar2level[var];
+}
+
+
+int bdd_var2level(int var)
+{
+   if (var < 0  ||  var >= bddvarnum)
+      return bdd_error(BDD_VAR);
+
+   return bddvar2level[var];
+}
+
+
+int bdd_level2var(int level)
+{
+   if (level < 0  ||  level >= bddvarnum)
+      return bdd_error(BDD_VAR);
+
+   return bddlevel2var[level];
+}
+
+
+/*************************************************************************
+  Garbage collection and node referencing
+*************************************************************************/
+
+   /* Free nodes found by one part of a parallel sweep, in index order */
+typedef struct s_BddFreePart
+{
+   int first;
+   int last;
+   int num;
+} BddFreePart;
+
+
+   /* Marks like bdd_mark, but may run in several threads at once */
+static void bdd_mark_shared(int i)
+{
+   while (i >= 2)
+   {
+      BddNode *node = &bddnodes[NODE(i)];
+
+      if (LOWp(node) == -1)
+         return;
+      if (std::atomic_ref<unsigned int>(node->level).fetch_or(MARKON, std::memory_order_relaxed) & MARKON)
+         return;
+
+      bdd_mark_shared(LOWp(node));
+      i = HIGHp(node);
+   }
+}
+
+
+   /* Calls fn(p, first, end) for each of num equal parts [first,end) of
+      the node table, all but the first in a thread of their own */
+template <class F>
+static void bdd_gbc_parts(int num, F fn)
+{
+   std::vector<std::thread> workers;
+   int p;
+
+   workers.reserve(num-1);
+   for (p=1 ; p<num ; p++)
+      workers.emplace_back(fn, p, (int)((long)bddnodesize*p/num),
+                           (int)((long)bddnodesize*(p+1)/num));
+   fn(0, 0, (int)((long)bddnodesize/num));
+
+   for (std::thread &w : workers)
+      w.join();
+}
+
+
+   /* The mark and sweep phases of bdd_gbc split over num threads. The
+      roots on the reference stacks must already be marked. Marks are set
+      atomically, chains are pushed onto with an atomic exchange, and each
+      thread builds the free list of its own part, which are joined at
+      the end in the same order a serial sweep would give */
+static void bdd_gbc_parallel(int num)
+{
+   std::vector<BddFreePart> parts(num);
+   int last = 0, p;
+
+   bdd_gbc_parts(num, [](int, int first, int end)
+   {
+      for (int n=first ; n<end ; n++)
+      {
+         if (bddnodes[n].refcou > 0)
+            bdd_mark_shared(EDGE(n));
+         bddhash[n] = 0;
+      }
+   });
+
+   bdd_gbc_parts(num, [&parts](int p, int first, int end)
+   {
+      BddFreePart part = { 0, 0, 0 };
+
+      for (int n=end-1 ; n>=first  &&  n>=1 ; n--)
+      {
+         BddNode *node = &bddnodes[n];
+
+         if ((LEVELp(node) & MARKON)  &&  LOWp(node) != -1)
+         {
+            unsigned int hash;
+
+            UNMARKp(node);
+            hash = NODEHASH(LEVELp(node), LOWp(node), HIGHp(node));
+            bddnext[n] = std::atomic_ref<int>(bddhash[hash]).exchange(n, std::memory_order_relaxed);
+         }
+         else
+         {
+            LOWp(node) = -1;
+            if (part.last == 0)
+               part.last = n;
+            bddnext[n] = part.first;
+            part.first = n;
+            part.num++;
+         }
+      }
+
+      parts[p] = part;
+   });
+
+   bddfreepos = 0;
+   bddfreenum = 0;
+
+   for (p=0 ; p<num ; p++)
+   {
+      if (parts[p].num == 0)
+         continue;
+
+      if (last == 0)
+         bddfreepos = parts[p].first;
+      else
+         bddnext[last] = parts[p].first;
+      last = parts[p].last;
+      bddfreenum += parts[p].num;
+   }
+}
+
+
+void bdd_gbc(void)
+{
+   int *r;
+   int n;
+   long c2, c1 = clock();
+
+   if (gbc_handler != NULL)
+   {
+      bddGbcStat s;
+      s.nodes = bddnodesize;
+      s.freenodes = bddfreenum;
+      s.time = 0;
+      s.sumtime = gbcclock;
+      s.num = gbcollectnum;
+      gbc_handler(1, &s);
+   }
+
+   for (r=bddrefstack ; r<bddrefstacktop ; r++)
+      bdd_mark(*r);
+
+      /* Results other threads have not referenced yet. Their private
+         chunks are rebuilt from scratch below */
+   {
+      std::lock_guard<std::mutex> lock(bddthreadlock);
+      for (BddThread *t=bddthreads ; t!=NULL ; t=t->next)
+      {
+         bdd_mark(t->lastres);
+         t->freepos = t->freenum = 0;
+      }
+   }
+
+      /* All live nodes are rehashed below, so chains not moved since the
+         last resize can simply be forgotten */
+   bdd_rehash_done();
+
+   n = bddnodesize / GBCMINPART;
+   if (gbcthreads > 1  &&  n > 1)
+      bdd_gbc_parallel(gbcthreads < n ? gbcthreads : n);
+   else
+   {
+      for (n=0 ; n<bddnodesize ; n++)
+      {
+         if (bddnodes[n].refcou > 0)
+            bdd_mark(EDGE(n));
+         bddhash[n] = 0;
+      }
+
+      bddfreepos = 0;
+      bddfreenum = 0;
+
+      for (n=bddnodesize-1 ; n>=1 ; n--)
+      {
+         BddNode *node = &bddnodes[n];
+
+         if ((LEVELp(node) & MARKON)  &&  LOWp(node) != -1)
+         {
+            unsigned int hash;
+
+            UNMARKp(node);
+            hash = NODEHASH(LEVELp(node), LOWp(node), HIGHp(node));
+            bddnext[n] = bddhash[hash];
+            bddhash[hash] = n;
+         }
+         else
+         {
+            LOWp(node) = -1;
+            bddnext[n] = bddfreepos;
+            bddfreepos = n;
+            bddfreenum++;
+         }
+      }
+   }
+
+   bdd_operator_reset();
+
+      /* The operator running now is finished first, see run_shared */
+   if (bdd_reorder_ready())
+      bddreorderpending = 1;
+
+   c2 = clock();
+   gbcclock += c2-c1;
+   gbcollectnum++;
+
+   if (gbc_handler != NULL)
+   {
+      bddGbcStat s;
+      s.nodes = bddnodesize;
+      s.freenodes = bddfreenum;
+      s.time = c2-c1;
+      s.sumtime = gbcclock;
+      s.num = gbcollectnum;
+      gbc_handler(0, &s);
+   }
+}
+
+
+   /* Rebuilds the unique table from scratch. Used when reordering has
+      hashed the nodes its own way */
+void bdd_unique_rehash(void)
+{
+   int n;
+
+   bdd_rehash_done();
+
+   for (n=0 ; n<bddnodesize ; n++)
+      bddhash[n] = 0;
+
+   for (n=bddnodesize-1 ; n>=1 ; n--)
+   {
+      BddNode *node = &bddnodes[n];
+
+      if (LOWp(node) != -1)
+      {
+         unsigned int hash = NODEHASH(LEVELp(node), LOWp(node), HIGHp(node));
+         bddnext[n] = bddhash[hash];
+         bddhash[hash] = n;
+      }
+   }
+}
+
+
+   /* Calls fn with the last result of every thread, see bdd_gbc */
+void bdd_forlastres(void (*fn)(int))
+{
+   std::lock_guard<std::mutex> lock(bddthreadlock);
+
+   for (BddThread *t=bddthreads ; t!=NULL ; t=t->next)
+      fn(t->lastres);
+}
+
+
+   /* Runs a garbage collection for a thread whose operator ran out of
+      free nodes in concurrent mode, unless another thread has already
+      done so since, and grows the node table if too little was freed */
+int bdd_gbc_concurrent(int gbcnum)
+{
+   std::unique_lock<std::shared_mutex> lock(bddkernellock);
+   int err = 0;
+
+   bddinexclusive = 1;
+   bddrefstacktop = bddrefstack;
+
+   if (gbcnum == gbcollectnum)
+   {
+      bdd_gbc();
+
+      if ((long)bddfreenum*100 <= (long)bddnodesize*minfreenodes)
+         bdd_noderesize(1);
+
+      if (bddresized)
+         bdd_operator_noderesize();
+      bddresized = 0;
+
+      if (bddfreepos == 0)
+         err = bdd_error(BDD_NODENUM);
+   }
+
+   bddinexclusive = 0;
+   return err;
+}
+
+
+   /* Reference counts are updated atomically in concurrent mode, and
+      under the shared kernel lock so the node table cannot move */
+static BDD bdd_addref_concurrent(BDD root)
+{
+   std::shared_lock<std::shared_mutex> lock(bddkernellock);
+
+   if (NODE(root) >= bddnodesize  ||  ISFREE(root))
+      return bdd_error(BDD_ILLBDD);
+
+   std::atomic_ref<unsigned int> refcou(bddnodes[NODE(root)].refcou);
+   if (refcou.load(std::memory_order_relaxed) < MAXREF)
+      refcou.fetch_add(1, std::memory_order_relaxed);
+   return root;
+}
+
+
+static BDD bdd_delref_concurrent(BDD root)
+{
+   std::shared_lock<std::shared_mutex> lock(bddkernellock);
+
+   if (NODE(root) >= bddnodesize  ||  ISFREE(root))
+      return bdd_error(BDD_ILLBDD);
+
+   std::atomic_ref<unsigned int> refcou(bddnodes[NODE(root)].refcou);
+   unsigned int n = refcou.load(std::memory_order_relaxed);
+   if (n == 0)
+      bdd_error(BDD_BREAK);
+   else if (n != MAXREF)
+      refcou.fetch_sub(1, std::memory_order_relaxed);
+   return root;
+}
+
+
+BDD bdd_addref(BDD root)
+{
+   BDDTHREAD->refcalls++;
+   if (root < 2  ||  !bddrunning)
+      return root;
+   if (bddconcurrent  &&  !bddinexclusive)
+      return bdd_addref_concurrent(root);
+   if (NODE(root) >= bddnodesize)
+      return bdd_error(BDD_ILLBDD);
+   if (ISFREE(root))
+      return bdd_error(BDD_ILLBDD);
+
+   INCREF(NODE(root));
+   return root;
+}
+
+
+BDD bdd_delref(BDD root)
+{
+   BDDTHREAD->refcalls++;
+   if (root < 2  ||  !bddrunning)
+      return root;
+   if (bddconcurrent  &&  !bddinexclusive)
+      return bdd_delref_concurrent(root);
+   if (NODE(root) >= bddnodesize)
+      return bdd_error(BDD_ILLBDD);
+   if (ISFREE(root))
+      return bdd_error(BDD_ILLBDD);
+
+   if (!HASREF(NODE(root)))
+      bdd_error(BDD_BREAK);
+
+   DECREF(NODE(root));
+   return root;
+}
+
+
+void bdd_mark(int i)
+{
+   BddNode *node;
+
+   if (i < 2)
+      return;
+
+   node = &bddnodes[NODE(i)];
+   if (MARKEDp(node)  ||  LOWp(node) == -1)
+      return;
+
+   SETMARKp(node);
+
+   bdd_mark(LOWp(node));
+   bdd_mark(HIGHp(node));
+}
+
+
+void bdd_mark_upto(int i, int level)
+{
+   BddNode *node = &bddnodes[NODE(i)];
+
+   if (i < 2)
+      return;
+
+   if (MARKEDp(node)  ||  LOWp(node) == -1)
+      return;
+
+   if ((int)LEVELp(node) > level)
+      return;
+
+   SETMARKp(node);
+
+   bdd_mark_upto(LOWp(node), level);
+   bdd_mark_upto(HIGHp(node), level);
+}
+
+
+void bdd_markcount(int i, int *cou)
+{
+   BddNode *node;
+
+   if (i < 2)
+      return;
+
+   node = &bddnodes[NODE(i)];
+   if (MARKEDp(node)  ||  LOWp(node) == -1)
+      return;
+
+   SETMARKp(node);
+   *cou += 1;
+
+   bdd_markcount(LOWp(node), cou);
+   bdd_markcount(HIGHp(node), cou);
+}
+
+
+void bdd_unmark(int i)
+{
+   BddNode *node;
+
+   if (i < 2)
+      return;
+
+   node = &bddnodes[NODE(i)];
+
+   if (!MARKEDp(node)  ||  LOWp(node) == -1)
+      return;
+   UNMARKp(node);
+
+   bdd_unmark(LOWp(node));
+   bdd_unmark(HIGHp(node));
+}
+
+
+void bdd_unmark_upto(int i, int level)
+{
+   BddNode *node = &bddnodes[NODE(i)];
+
+   if (i < 2)
+      return;
+
+   if (!(LEVELp(node) & MARKON))
+      return;
+
+   LEVELp(node) &= MARKOFF;
+
+   if ((int)LEVELp(node) > level)
+      return;
+
+   bdd_unmark_upto(LOWp(node), level);
+   bdd_unmark_upto(HIGHp(node), level);
+}
+
+
+/*************************************************************************
+  Unique node table
+*************************************************************************/
+
+   /* Takes a chunk of free nodes for the calling thread */
+static int bdd_refillchunk(BddThread *t)
+{
+   std::lock_guard<std::mutex> lock(bddfreelock);
+   int first = bddfreepos, last = 0, n;
+
+   for (n=0 ; n<NODECHUNK  &&  bddfreepos != 0 ; n++)
+   {
+      last = bddfreepos;
+      bddfreepos = bddnext[last];
+   }
+
+   if (n == 0)
+      return 0;
+
+   bddnext[last] = 0;
+   bddfreenum -= n;
+   t->freepos = first;
+   t->freenum = n;
+   return n;
+}
+
+
+   /* The concurrent counterpart of bdd_makenode below. Each unique
+      chain is guarded by one of the striped locks, and a missing node
+      is taken from the private chunk of the thread */
+int bdd_makenode_concurrent(unsigned int level, int low, int high)
+{
+   BddThread *t = bddthread;
+   unsigned int hash;
+   BddNode *node;
+   int res, neg;
+
+   t->stats.uniqueAccess++;
+
+   if (low == high)
+      return low;
+
+   neg = ISCOMPL(high);
+   low ^= neg;
+   high ^= neg;
+
+   hash = NODEHASH(level, low, high);
+   std::atomic_flag &lock = bddstripes[hash % NODESTRIPES].flag;
+
+   while (lock.test_and_set(std::memory_order_acquire))
+      while (lock.test(std::memory_order_relaxed))
+         ;
+
+   for (res=bddhash[hash] ; res != 0 ; res=bddnext[res])
+   {
+      node = &bddnodes[res];
+      if (LEVELp(node) == level  &&  LOWp(node) == low  &&  HIGHp(node) == high)
+      {
+         lock.clear(std::memory_order_release);
+         t->stats.uniqueHit++;
+         return EDGE(res) | neg;
+      }
+      t->stats.uniqueChain++;
+   }
+
+   t->stats.uniqueMiss++;
+
+   if (t->freepos == 0  &&  !bdd_refillchunk(t))
+   {
+      lock.clear(std::memory_order_release);
+      throw BddNodesExhausted{ gbcollectnum };
+   }
+
+   res = t->freepos;
+   t->freepos = bddnext[res];
+   t->freenum--;
+   t->produced++;
+
+   node = &bddnodes[res];
+   LEVELp(node) = level;
+   LOWp(node) = low;
+   HIGHp(node) = high;
+
+   bddnext[res] = bddhash[hash];
+   bddhash[hash] = res;
+
+   lock.clear(std::memory_order_release);
+   return EDGE(res) | neg;
+}
+
+
+int bdd_makenode(unsigned int level, int low, int high)
+{
+   BddThread *t = bddthread;
+   BddNode *node;
+   unsigned int hash;
+   int res, neg;
+
+   t->stats.uniqueAccess++;
+
+      /* check whether childs are equal */
+   if (low == high)
+      return low;
+
+      /* Only regular high edges are stored, so (l,h) is kept as the
+         negation of (!l,!h) when h is complemented */
+   neg = ISCOMPL(high);
+   low ^= neg;
+   high ^= neg;
+
+      /* Try to find an existing node of this kind */
+   hash = NODEHASH(level, low, high);
+   res = bddhash[hash];
+
+   while(res != 0)
+   {
+      node = &bddnodes[res];
+      if (LEVELp(node) == level  &&  LOWp(node) == low  &&  HIGHp(node) == high)
+      {
+         t->stats.uniqueHit++;
+         return EDGE(res) | neg;
+      }
+
+      res = bddnext[res];
+      t->stats.uniqueChain++;
+   }
+
+      /* Nodes not moved yet since the last resize are in the old chains */
+   if (bddoldhashsize > 0)
+   {
+      for (res=bddoldhash[OLDHASH(level, low, high)] ; res != 0 ; res=bddoldnext[res])
+      {
+         node = &bddnodes[res];
+         if (LEVELp(node) == level  &&  LOWp(node) == low  &&  HIGHp(node) == high)
+         {
+            t->stats.uniqueHit++;
+            return EDGE(res) | neg;
+         }
+         t->stats.uniqueChain++;
+      }
+   }
+
+      /* No existing node -> build one */
+   t->stats.uniqueMiss++;
+
+      /* Any free nodes to use ? */
+   if (bddfreepos == 0)
+   {
+      if (bdderrorcond)
+         return 0;
+
+         /* Try to allocate more nodes */
+      bdd_gbc();
+
+      if ((long)bddfreenum*100 <= (long)bddnodesize*minfreenodes)
+      {
+         bdd_noderesize(1);
+         hash = NODEHASH(level, low, high);
+      }
+
+         /* Panic if that is not possible */
+      if (bddfreepos == 0)
+      {
+         bdd_error(BDD_NODENUM);
+         bdderrorcond = abs(BDD_NODENUM);
+         return 0;
+      }
+   }
+
+      /* Pay off a bit of the last resize. The move would link a node
+         from the old part of the table once more after it is inserted
+         below, so finish first when that is the one taken */
+   if (bddoldhashsize > 0)
+      bdd_rehash_step(bddfreepos < bddoldhashsize ? bddoldhashsize : bddrehashstep);
+
+      /* Build new node */
+   res = bddfreepos;
+   bddfreepos = bddnext[bddfreepos];
+   bddfreenum--;
+   t->produced++;
+
+   node = &bddnodes[res];
+   LEVELp(node) = level;
+   LOWp(node) = low;
+   HIGHp(node) = high;
+
+      /* Insert node */
+   bddnext[res] = bddhash[hash];
+   bddhash[hash] = res;
+
+   return EDGE(res) | neg;
+}
+
+
+   /* Forgets the old chains, whether moved or not */
+static void bdd_rehash_done(void)
+{
+   free(bddoldhash);
+   free(bddoldnext);
+   bddoldhash = bddoldnext = NULL;
+   bddoldhashsize = 0;
+   bddrehashpos = 0;
+}
+
+
+   /* Moves up to num of the nodes from before the last resize into the
+      current unique table. A resize only swaps in an empty table and
+      keeps the old chains, with their own links, for lookups. The nodes
+      are then moved here in index order a few at a time as new nodes
+      are made, so no single operator pays for the whole table. A node
+      made meanwhile is never seen here, see bdd_makenode */
+static void bdd_rehash_step(int num)
+{
+   int end = bddoldhashsize - bddrehashpos < num ? bddoldhashsize : bddrehashpos + num;
+   int n;
+
+   for (n=bddrehashpos ; n < end ; n++)
+   {
+      BddNode *node = &bddnodes[n];
+
+      if (LOWp(node) != -1)
+      {
+         unsigned int hash = NODEHASH(LEVELp(node), LOWp(node), HIGHp(node));
+
+         bddnext[n] = bddhash[hash];
+         bddhash[hash] = n;
+      }
+   }
+   bddrehashpos = end;
+
+   if (bddrehashpos >= bddoldhashsize)
+      bdd_rehash_done();
+}
+
+
+int bdd_noderesize(int doRehash)
+{
+   BddNode *newnodes;
+   int *newhash, *newnext;
+   int oldsize = bddnodesize;
+   int n;
+
+      /* The table is resized with realloc, which only promises malloc
+         alignment */
+   static_assert(alignof(BddNode) <= alignof(std::max_align_t));
+
+   if (bddnodesize >= bddmaxnodesize  &&  bddmaxnodesize > 0)
+      return -1;
+
+      /* Old chains are hashed by the current size, so move them all
+         before the size changes */
+   bdd_rehash_step(bddoldhashsize);
+
+   bddnodesize = bddnodesize << 1;
+
+   if (bddnodesize > oldsize + bddmaxnodeincrease)
+      bddnodesize = oldsize + bddmaxnodeincrease;
+
+   if (bddnodesize > bddmaxnodesize  &&  bddmaxnodesize > 0)
+      bddnodesize = bddmaxnodesize;
+
+   bddnodesize = bdd_prime_lte(bddnodesize);
+   if (bddnodesize <= oldsize)
+   {
+      bddnodesize = oldsize;
+      return -1;
+   }
+
+   if (resize_handler != NULL)
+      resize_handler(oldsize, bddnodesize);
+
+      /* Large blocks are remapped rather than copied by realloc, and the
+         new chain heads come zeroed from calloc */
+   newnodes = (BddNode*)realloc(bddnodes, sizeof(BddNode)*bddnodesize);
+   if (newnodes != NULL)
+      bddnodes = newnodes;
+   newnext = (int*)malloc(sizeof(int)*bddnodesize);
+   newhash = (int*)calloc(bddnodesize, sizeof(int));
+
+   if (newnodes == NULL  ||  newnext == NULL  ||  newhash == NULL)
+   {
+      free(newnext);
+      free(newhash);
+      bddnodesize = oldsize;
+      return bdd_error(BDD_MEMORY);
+   }
+
+      /* Keeps the free list */
+   memcpy(newnext, bddnext, sizeof(int)*oldsize);
+
+   if (doRehash)
+   {
+         /* The new nodes are put first on the free list below, and the
+            old nodes are all moved long before those are used up */
+      bddoldhash = bddhash;
+      bddoldnext = bddnext;
+      bddoldhashsize = oldsize;
+      bddrehashpos = 1;
+      bddrehashstep = (int)(((long)REHASHSPEED*oldsize) / (bddnodesize-oldsize)) + 1;
+   }
+   else
+   {
+      free(bddhash);
+      free(bddnext);
+   }
+   bddhash = newhash;
+   bddnext = newnext;
+
+   for (n=oldsize ; n<bddnodesize ; n++)
+   {
+      bddnodes[n].refcou = 0;
+      bddnodes[n].level = 0;
+      bddnodes[n].low = -1;
+      bddnext[n] = n+1;
+   }
+   bddnext[bddnodesize-1] = bddfreepos;
+   bddfreepos = oldsize;
+   bddfreenum += bddnodesize - oldsize;
+
+      /* Concurrent lookups only search the current chains */
+   if (bddconcurrent)
+      bdd_rehash_step(bddoldhashsize);
+
+   bddresized = 1;
+
+   return 0;
+}
+
+
+/*************************************************************************
+  Variable sets
+*************************************************************************/
+
+int bdd_scanset(BDD r, int **varset, int *varnum)
+{
+   BDD_EXCLUSIVE;
+   int n, num;
+
+   CHECK(r);
+   if (r < 2)
+   {
+      *varnum = 0;
+      *varset = NULL;
+      return 0;
+   }
+
+   for (n=r, num=0 ; n > 1 ; n=HIGH(n))
+      num++;
+
+   if (((*varset) = (int *)malloc(sizeof(int)*num)) == NULL)
+      return bdd_error(BDD_MEMORY);
+
+   for (n=r, num=0 ; n > 1 ; n=HIGH(n))
+      (*varset)[num++] = bddlevel2var[LEVEL(n)];
+
+   *varnum = num;
+
+   return 0;
+}
+
+
+BDD bdd_makeset(int *varset, int varnum)
+{
+   int v, res=1;
+
+   for (v=varnum-1 ; v>=0 ; v--)
+   {
+      BDD tmp;
+      bdd_addref(res);
+      tmp = bdd_apply(res, bdd_ithvar(varset[v]), bddop_and);
+      bdd_delref(res);
+      res = tmp;
+   }
+
+   return res;
+}
+
+
+/* EOF */
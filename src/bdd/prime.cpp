@@ -0,0 +1,39 @@
+/*************************************************************************
+  FILE:  prime.cpp
+  DESCR: Prime number calculations used for sizing the node table
+*************************************************************************/
+
+#include "prime.h"
+
+static bool isprime(unsigned int n)
+{
+   if (n < 2)
+      return false;
+   if (n % 2 == 0)
+      return n == 2;
+
+   for (unsigned int d = 3 ; d <= n / d ; d += 2)
+      if (n % d == 0)
+         return false;
+
+   return true;
+}
+
+
+unsigned int bdd_prime_gte(unsigned int src)
+{
+   while (!isprime(src))
+      src++;
+   return src;
+}
+
+
+unsigned int bdd_prime_lte(unsigned int src)
+{
+   while (src > 2 && !isprime(src))
+      src--;
+   return src;
+}
+
+
+/* EOF */
@@ -0,0 +1,1395 @@
+/*************************************************************************
+  FILE:  reorder.cpp
+  DESCR: Dynamic variable reordering
+*************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "kernel.h"
+#include "bddtree.h"
+#include "imatrix.h"
+
+   /* A block being moved is put back once the table has grown this much
+      (in percent) past the best size seen */
+#define MAXGROWTH 120
+
+   /* Fewest nodes in use before automatic reordering starts */
+#define REORDERSTART 10000
+
+   /* Automatic reordering stops after one that saved less than this (in
+      percent) of the nodes in use, until it is asked for again */
+#define REORDERMINGAIN 10
+
+   /* Per variable data while reordering. The unique table is split into
+      one slice per variable, so a node keeps its chain when the level of
+      its variable changes */
+typedef struct s_levelData
+{
+   int start;    /* First chain of the slice */
+   int size;     /* Number of chains */
+   int nodenum;  /* Nodes of the variable */
+} levelData;
+
+std::atomic<int> bddreorderpending; /* Flag - reorder after the operator */
+
+static int   bddreordermethod;      /* Method used by automatic reordering */
+static BddTree *vartree;            /* Variable blocks */
+static int   blockid;               /* Id given to the next block */
+static int   bddreordertimes;       /* Automatic reorderings left, -1 is any */
+static int   bddreorderdisabled;    /* Flag - automatic reordering disabled */
+static int   bddreorderstopped;     /* Flag - the last one gained too little */
+static int   verbose;               /* Print progress */
+static int   usednum_before;        /* Nodes in use before the last reorder */
+static int   usednum_after;         /* - and after */
+static int   usednum_next;          /* Nodes in use that trigger the next */
+static levelData *levels;           /* Slices, by variable */
+static imatrix *iactmtx;            /* Variables that share a root */
+static imatrix *hintmtx;            /* Interactions given by the user */
+
+static bddinthandler  reorder_handler;
+static bddfilehandler blockfile_handler;
+static bddsizehandler reorder_nodenum_handler;
+
+static void reorder_forroots(void (*)(int));
+
+
+/*************************************************************************
+  Initialization and shutdown
+*************************************************************************/
+
+void bdd_reorder_init(void)
+{
+   vartree = NULL;
+   blockid = 0;
+   bddreordermethod = BDD_REORDER_NONE;
+   bddreordertimes = -1;
+   bddreorderdisabled = 0;
+   bddreorderstopped = 0;
+   bddreorderpending = 0;
+   verbose = 0;
+   usednum_before = usednum_after = 0;
+   usednum_next = REORDERSTART;
+   levels = NULL;
+   iactmtx = NULL;
+   hintmtx = NULL;
+   reorder_handler = bdd_default_reohandler;
+   blockfile_handler = NULL;
+   reorder_nodenum_handler = NULL;
+}
+
+
+void bdd_reorder_done(void)
+{
+   bddtree_del(vartree);
+   vartree = NULL;
+   free(levels);
+   levels = NULL;
+   imatrixDelete(iactmtx);
+   iactmtx = NULL;
+   imatrixDelete(hintmtx);
+   hintmtx = NULL;
+}
+
+
+/*************************************************************************
+  Unique table slices
+*************************************************************************/
+
+#define LEVELHASH(var,l,h) (PAIR(l,h) % levels[var].size + levels[var].start)
+
+   /* Gives every variable an equal share of the chain heads */
+static void reorder_setslices(void)
+{
+   int share = bddnodesize / bddvarnum;
+   int n;
+
+   if (share < 1)
+      share = 1;
+
+   for (n=0 ; n<bddvarnum ; n++)
+   {
+      levels[n].start = n * share;
+      levels[n].size = share;
+   }
+}
+
+
+   /* Puts every live node in the slice of its variable */
+static void reorder_rehashall(void)
+{
+   int n;
+
+   reorder_setslices();
+
+   for (n=0 ; n<bddnodesize ; n++)
+      bddhash[n] = 0;
+
+   for (n=bddnodesize-1 ; n>=1 ; n--)
+   {
+      BddNode *node = &bddnodes[n];
+
+      if (LOWp(node) != -1)
+      {
+         int var = bddlevel2var[LEVELp(node)];
+         unsigned int hash = LEVELHASH(var, LOWp(node), HIGHp(node));
+
+         bddnext[n] = bddhash[hash];
+         bddhash[hash] = n;
+      }
+   }
+}
+
+
+   /* Frees the nodes of var nobody refers to any more. Their children
+      lose a reference but are only freed when their own level is done */
+static void reorder_localgbc(int var)
+{
+   int n;
+
+   for (n=levels[var].start ; n<levels[var].start+levels[var].size ; n++)
+   {
+      int r = bddhash[n];
+
+      bddhash[n] = 0;
+      while (r != 0)
+      {
+         BddNode *node = &bddnodes[r];
+         int next = bddnext[r];
+
+         if (node->refcou > 0)
+         {
+            bddnext[r] = bddhash[n];
+            bddhash[n] = r;
+         }
+         else
+         {
+            DECREF(NODE(LOWp(node)));
+            DECREF(NODE(HIGHp(node)));
+            LOWp(node) = -1;
+            bddnext[r] = bddfreepos;
+            bddfreepos = r;
+            bddfreenum++;
+            levels[var].nodenum--;
+         }
+
+         r = next;
+      }
+   }
+}
+
+
+   /* Frees every dead node, top level first so that whole dead
+      subgraphs go at once */
+static void reorder_gbc(void)
+{
+   int n;
+
+   for (n=0 ; n<bddvarnum ; n++)
+      reorder_localgbc(bddlevel2var[n]);
+}
+
+
+   /* Makes sure a swap can build num new nodes without running out */
+static int reorder_ensurefree(int num)
+{
+   if (bddfreenum >= num)
+      return 0;
+
+   reorder_gbc();
+
+   while (bddfreenum < num)
+   {
+      if (bdd_noderesize(0) < 0)
+         return bdd_error(BDD_NODENUM);
+      reorder_rehashall();
+   }
+
+   return 0;
+}
+
+
+   /* Finds or builds a node for var below the level being swapped. The
+      new node is not referenced yet, but its children are */
+static int reorder_makenode(int var, int low, int high)
+{
+   unsigned int level = bddvar2level[var];
+   unsigned int hash;
+   BddNode *node;
+   int res, neg;
+
+   if (low == high)
+      return low;
+
+   neg = ISCOMPL(high);
+   low ^= neg;
+   high ^= neg;
+
+   hash = LEVELHASH(var, low, high);
+   for (res=bddhash[hash] ; res != 0 ; res=bddnext[res])
+   {
+      node = &bddnodes[res];
+      if (LEVELp(node) == level  &&  LOWp(node) == low  &&  HIGHp(node) == high)
+         return EDGE(res) | neg;
+   }
+
+   res = bddfreepos;
+   bddfreepos = bddnext[res];
+   bddfreenum--;
+   levels[var].nodenum++;
+
+   node = &bddnodes[res];
+   LEVELp(node) = level;
+   LOWp(node) = low;
+   HIGHp(node) = high;
+   node->refcou = 0;
+   INCREF(NODE(low));
+   INCREF(NODE(high));
+
+   bddnext[res] = bddhash[hash];
+   bddhash[hash] = res;
+
+   return EDGE(res) | neg;
+}
+
+
+/*************************************************************************
+  Interaction between variables
+*************************************************************************/
+
+static int *suppvars;    /* Support of the root being scanned */
+static int suppnum;
+static char *insupp;     /* Flag per variable - in suppvars */
+static int *visitroot;   /* Last root that reached a node, by node */
+static int rootid;
+
+static void reorder_support_rec(int n)
+{
+   BddNode *node = &bddnodes[n];
+   int var;
+
+   if (n == 0  ||  visitroot[n] == rootid)
+      return;
+   visitroot[n] = rootid;
+
+   var = bddlevel2var[LEVELp(node)];
+   if (!insupp[var])
+   {
+      insupp[var] = 1;
+      suppvars[suppnum++] = var;
+   }
+
+   reorder_support_rec(NODE(LOWp(node)));
+   reorder_support_rec(NODE(HIGHp(node)));
+}
+
+
+   /* Makes every pair of variables in the support of r interact. A root
+      reached from an earlier one adds nothing new */
+static void reorder_rootinteraction(int r)
+{
+   int n, m;
+
+   if (ISCONST(r)  ||  visitroot[NODE(r)] != 0)
+      return;
+
+   rootid++;
+   suppnum = 0;
+   reorder_support_rec(NODE(r));
+
+   for (n=0 ; n<suppnum ; n++)
+   {
+      insupp[suppvars[n]] = 0;
+      for (m=0 ; m<suppnum ; m++)
+         imatrixSet(iactmtx, suppvars[n], suppvars[m]);
+   }
+}
+
+
+   /* Builds the interaction matrix of the live roots: the references
+      held outside the kernel and the reference stack. No node of a
+      variable has a child of another variable unless the two interact.
+      Without memory for it every pair interacts */
+static void reorder_makematrix(void)
+{
+   int n;
+
+   iactmtx = imatrixNew(bddvarnum);
+   suppvars = NEW(int, bddvarnum);
+   insupp = (char*)calloc(bddvarnum, sizeof(char));
+   visitroot = (int*)calloc(bddnodesize, sizeof(int));
+
+   if (iactmtx != NULL  &&  suppvars != NULL  &&  insupp != NULL  &&
+       visitroot != NULL)
+   {
+      rootid = 0;
+      for (n=1 ; n<bddnodesize ; n++)
+         if (LOWp(&bddnodes[n]) != -1  &&  HASREF(n))
+            reorder_rootinteraction(EDGE(n));
+      reorder_forroots(reorder_rootinteraction);
+   }
+   else
+   {
+      imatrixDelete(iactmtx);
+      iactmtx = NULL;
+   }
+
+   free(suppvars);
+   free(insupp);
+   free(visitroot);
+}
+
+
+   /* Whether nodes of v and w can depend on each other. If not, swapping
+      them changes no node */
+static int reorder_interacts(int v, int w)
+{
+   return iactmtx == NULL  ||  imatrixDepends(iactmtx, v, w);
+}
+
+
+   /* Whether moving v past w may change the size of the table. The
+      interactions given with bdd_addinteraction narrow down those of the
+      roots, for the variables they mention */
+static int reorder_related(int v, int w)
+{
+   if (!reorder_interacts(v, w))
+      return 0;
+   if (hintmtx == NULL  ||  v >= hintmtx->size  ||  w >= hintmtx->size)
+      return 1;
+   if (!imatrixDepends(hintmtx, v, v)  ||  !imatrixDepends(hintmtx, w, w))
+      return 1;
+   return imatrixDepends(hintmtx, v, w) != 0;
+}
+
+
+/*************************************************************************
+  Swapping two adjacent levels
+*************************************************************************/
+
+   /* Swaps the variable at level with the one just below it. Nodes of
+      the upper variable x that do not depend on the lower y just move
+      down a level, and nodes of y move up. A node f = ite(x, f1, f0)
+      with a child on the level of y is rebuilt in place as
+      ite(y, ite(x, f11, f01), ite(x, f10, f00)), so every edge into
+      the table still means the same function afterwards. f1 is regular,
+      and so is f11 and the new high child, which keeps f canonical */
+static int reorder_swap(int level)
+{
+   int x = bddlevel2var[level];
+   int y = bddlevel2var[level+1];
+   int dep = reorder_interacts(x, y);
+   int toprocess = 0;
+   int n, r;
+
+   if (dep  &&  reorder_ensurefree(levels[x].nodenum*2) < 0)
+      return -1;
+
+      /* Take out the nodes of x that depend on y. If no root depends on
+         both there are none, and x only moves down */
+   for (n=levels[x].start ; n<levels[x].start+levels[x].size ; n++)
+   {
+      if (!dep)
+      {
+         for (r=bddhash[n] ; r != 0 ; r=bddnext[r])
+            LEVELp(&bddnodes[r]) = level+1;
+         continue;
+      }
+
+      r = bddhash[n];
+      bddhash[n] = 0;
+
+      while (r != 0)
+      {
+         BddNode *node = &bddnodes[r];
+         int next = bddnext[r];
+
+         if ((int)LEVEL(LOWp(node)) == level+1  ||  (int)LEVEL(HIGHp(node)) == level+1)
+         {
+            bddnext[r] = toprocess;
+            toprocess = r;
+            levels[x].nodenum--;
+         }
+         else
+         {
+            LEVELp(node) = level+1;
+            bddnext[r] = bddhash[n];
+            bddhash[n] = r;
+         }
+
+         r = next;
+      }
+   }
+
+      /* Move y up */
+   for (n=levels[y].start ; n<levels[y].start+levels[y].size ; n++)
+      for (r=bddhash[n] ; r != 0 ; r=bddnext[r])
+         LEVELp(&bddnodes[r]) = level;
+
+   bddvar2level[x]++;
+   bddvar2level[y]--;
+   bddlevel2var[level] = y;
+   bddlevel2var[level+1] = x;
+   bdd_pairs_vardown(level);
+
+      /* Rebuild the nodes taken out as nodes of y */
+   while (toprocess != 0)
+   {
+      BddNode *node = &bddnodes[toprocess];
+      int next = bddnext[toprocess];
+      int f0 = LOWp(node);
+      int f1 = HIGHp(node);
+      int f00, f01, f10, f11, g0, g1;
+      unsigned int hash;
+
+      if ((int)LEVEL(f0) == level)
+      {
+         f00 = LOW(f0);
+         f01 = HIGH(f0);
+      }
+      else
+         f00 = f01 = f0;
+
+      if ((int)LEVEL(f1) == level)
+      {
+         f10 = LOW(f1);
+         f11 = HIGH(f1);
+      }
+      else
+         f10 = f11 = f1;
+
+      g0 = reorder_makenode(x, f00, f10);
+      INCREF(NODE(g0));
+      g1 = reorder_makenode(x, f01, f11);
+      INCREF(NODE(g1));
+
+      DECREF(NODE(f0));
+      DECREF(NODE(f1));
+
+         /* The node is looked up again, the pointer may be stale */
+      node = &bddnodes[toprocess];
+      LOWp(node) = g0;
+      HIGHp(node) = g1;
+
+      hash = LEVELHASH(y, g0, g1);
+      bddnext[toprocess] = bddhash[hash];
+      bddhash[hash] = toprocess;
+      levels[y].nodenum++;
+
+      toprocess = next;
+   }
+
+      /* The old nodes of y that were only used by the rebuilt ones */
+   if (dep)
+      reorder_localgbc(y);
+
+   BDDTHREAD->stats.swapCount++;
+   return 0;
+}
+
+
+static int reorder_varup(int var)
+{
+   int level = bddvar2level[var];
+
+   if (level == 0)
+      return 0;
+   return reorder_swap(level-1);
+}
+
+
+static int reorder_nodenum(void)
+{
+   if (reorder_nodenum_handler != NULL)
+      return reorder_nodenum_handler();
+   return bddnodesize - bddfreenum;
+}
+
+
+/*************************************************************************
+  Start and end of a reordering
+*************************************************************************/
+
+   /* Runs fn on every root that is not an external reference: results
+      on the reference stack of this thread and results other threads
+      have not referenced yet in concurrent mode */
+static void reorder_forroots(void (*fn)(int))
+{
+   int *r;
+
+   for (r=bddrefstack ; r<bddrefstacktop ; r++)
+      fn(*r);
+   bdd_forlastres(fn);
+}
+
+
+   /* Collects garbage and turns the reference counts into counts of all
+      references, internal ones included, so that swaps can tell when a
+      node dies */
+static int reorder_init(void)
+{
+   int n;
+
+   if ((levels=(levelData*)calloc(bddvarnum, sizeof(levelData))) == NULL)
+      return bdd_error(BDD_MEMORY);
+
+   bdd_gbc();
+   reorder_makematrix();
+
+   for (n=1 ; n<bddnodesize ; n++)
+   {
+      BddNode *node = &bddnodes[n];
+
+      if (LOWp(node) != -1)
+      {
+         INCREF(NODE(LOWp(node)));
+         INCREF(NODE(HIGHp(node)));
+         levels[bddlevel2var[LEVELp(node)]].nodenum++;
+      }
+   }
+
+   reorder_forroots([](int r) { INCREF(NODE(r)); });
+
+   reorder_rehashall();
+   return 0;
+}
+
+
+   /* Frees what died, puts back the external reference counts and the
+      ordinary unique table */
+static void reorder_done(void)
+{
+   int n;
+
+   reorder_gbc();
+
+   for (n=1 ; n<bddnodesize ; n++)
+   {
+      BddNode *node = &bddnodes[n];
+
+      if (LOWp(node) != -1)
+      {
+         DECREF(NODE(LOWp(node)));
+         DECREF(NODE(HIGHp(node)));
+      }
+   }
+
+   reorder_forroots([](int r) { DECREF(NODE(r)); });
+
+   bdd_unique_rehash();
+
+   free(levels);
+   levels = NULL;
+   imatrixDelete(iactmtx);
+   iactmtx = NULL;
+
+   bdd_operator_reset();
+   if (bddresized)
+      bdd_operator_noderesize();
+   bddresized = 0;
+}
+
+
+/*************************************************************************
+  Moving blocks
+*************************************************************************/
+
+static int block_size(BddTree *t)
+{
+   return t->last - t->first + 1;
+}
+
+
+static int block_top(BddTree *t)
+{
+   return bddvar2level[t->seq[0]];
+}
+
+
+   /* Swaps the blocks at blk[pos] and blk[pos+1] by moving every
+      variable of the lower one up past the upper one */
+static int block_swap(BddTree **blk, int pos)
+{
+   BddTree *upper = blk[pos];
+   BddTree *lower = blk[pos+1];
+   int top = block_top(upper);
+   int un = block_size(upper);
+   int n, level;
+
+   for (n=0 ; n<block_size(lower) ; n++)
+      for (level=top+un+n-1 ; level>=top+n ; level--)
+         if (reorder_swap(level) < 0)
+            return -1;
+
+   blk[pos] = lower;
+   blk[pos+1] = upper;
+   return 0;
+}
+
+
+   /* Moves the block at blk[*pos] one step towards dest */
+static int block_step(BddTree **blk, int *pos, int dest)
+{
+   if (dest > *pos)
+   {
+      if (block_swap(blk, *pos) < 0)
+         return -1;
+      (*pos)++;
+   }
+   else
+   {
+      if (block_swap(blk, *pos-1) < 0)
+         return -1;
+      (*pos)--;
+   }
+   return 0;
+}
+
+
+static int block_nodenum(BddTree *t)
+{
+   int n, sum = 0;
+
+   for (n=t->first ; n<=t->last ; n++)
+      sum += levels[n].nodenum;
+   return sum;
+}
+
+
+static int block_related(BddTree *a, BddTree *b)
+{
+   int v, w;
+
+   for (v=a->first ; v<=a->last ; v++)
+      for (w=b->first ; w<=b->last ; w++)
+         if (reorder_related(v, w))
+            return 1;
+   return 0;
+}
+
+
+/*************************************************************************
+  Reordering methods. Each one gets the blocks of one tree level in
+  level order and leaves them in their new order
+*************************************************************************/
+
+   /* Swaps neighbours when that makes the table smaller */
+static int reorder_win2(BddTree **blk, int num)
+{
+   int n, best = reorder_nodenum(), improved = 0;
+
+   for (n=0 ; n<num-1 ; n++)
+   {
+      if (!block_related(blk[n], blk[n+1]))
+         continue;
+      if (block_swap(blk, n) < 0)
+         return -1;
+
+      if (reorder_nodenum() < best)
+      {
+         best = reorder_nodenum();
+         improved = 1;
+      }
+      else if (block_swap(blk, n) < 0)
+         return -1;
+   }
+
+   return improved;
+}
+
+
+   /* Tries all orders of three neighbours. The six of them are visited
+      by swapping the first and the last pair in turn */
+static int reorder_win3(BddTree **blk, int num)
+{
+   int n, best = reorder_nodenum(), improved = 0;
+
+   if (num < 3)
+      return reorder_win2(blk, num);
+
+   for (n=0 ; n<num-2 ; n++)
+   {
+      int step, beststep = 0;
+
+      for (step=1 ; step<=6 ; step++)
+      {
+         if (block_swap(blk, n + (step&1 ? 0 : 1)) < 0)
+            return -1;
+         if (step < 6  &&  reorder_nodenum() < best)
+         {
+            best = reorder_nodenum();
+            beststep = step;
+         }
+      }
+
+         /* Back at the start, now walk to the best one */
+      for (step=1 ; step<=beststep ; step++)
+         if (block_swap(blk, n + (step&1 ? 0 : 1)) < 0)
+            return -1;
+
+      if (beststep > 0)
+         improved = 1;
+   }
+
+   return improved;
+}
+
+
+static int compare_size(const void *a, const void *b)
+{
+   const int *sa = (const int*)a;
+   const int *sb = (const int*)b;
+   return sb[0] - sa[0];
+}
+
+
+   /* Moves each block, largest first, to its best position. A block
+      only travels as far as the outermost blocks it is related to, since
+      moving past the others changes nothing. It goes to the nearer end
+      first, then to the other end, and stops early when the table grows
+      too much */
+static int reorder_sift(BddTree **blk, int num)
+{
+   int *order = NEW(int, num*2);
+   int start = reorder_nodenum();
+   int n, k;
+
+   if (order == NULL)
+      return bdd_error(BDD_MEMORY);
+
+   for (n=0 ; n<num ; n++)
+   {
+      order[n*2] = block_nodenum(blk[n]);
+      order[n*2+1] = blk[n]->id;
+   }
+   qsort(order, num, sizeof(int)*2, compare_size);
+
+   for (k=0 ; k<num ; k++)
+   {
+      int pos, best, bestpos, pass, lo, hi;
+
+      for (pos=0 ; blk[pos]->id != order[k*2+1] ; pos++)
+         ;
+
+      lo = hi = pos;
+      for (n=0 ; n<num ; n++)
+         if (n != pos  &&  block_related(blk[pos], blk[n]))
+         {
+            lo = MIN(lo, n);
+            hi = MAX(hi, n);
+         }
+
+      best = reorder_nodenum();
+      bestpos = pos;
+
+      for (pass=0 ; pass<2 ; pass++)
+      {
+         int dest = (pos-lo < hi-pos) == (pass == 0) ? lo : hi;
+
+         while (pos != dest)
+         {
+            if (block_step(blk, &pos, dest) < 0)
+            {
+               free(order);
+               return -1;
+            }
+
+            if (reorder_nodenum() < best)
+            {
+               best = reorder_nodenum();
+               bestpos = pos;
+            }
+            else if ((long)reorder_nodenum()*100 > (long)best*MAXGROWTH)
+               break;
+         }
+      }
+
+      while (pos != bestpos)
+         if (block_step(blk, &pos, bestpos) < 0)
+         {
+            free(order);
+            return -1;
+         }
+   }
+
+   free(order);
+   return reorder_nodenum() < start;
+}
+
+
+static int reorder_random(BddTree **blk, int num)
+{
+   int n;
+
+   for (n=0 ; n<num ; n++)
+   {
+      int pos = rand() % num;
+      int dest = rand() % num;
+
+      while (pos != dest)
+         if (block_step(blk, &pos, dest) < 0)
+            return -1;
+   }
+
+   return 1;
+}
+
+
+static int reorder_method(BddTree **blk, int num, int method)
+{
+   int res;
+
+   switch (method)
+   {
+   case BDD_REORDER_WIN2:
+      return reorder_win2(blk, num);
+   case BDD_REORDER_WIN2ITE:
+      while ((res=reorder_win2(blk, num)) > 0)
+         ;
+      return res;
+   case BDD_REORDER_WIN3:
+      return reorder_win3(blk, num);
+   case BDD_REORDER_WIN3ITE:
+      while ((res=reorder_win3(blk, num)) > 0)
+         ;
+      return res;
+   case BDD_REORDER_SIFT:
+      return reorder_sift(blk, num);
+   case BDD_REORDER_SIFTITE:
+      while ((res=reorder_sift(blk, num)) > 0)
+         ;
+      return res;
+   case BDD_REORDER_RANDOM:
+      return reorder_random(blk, num);
+   }
+
+   return 0;
+}
+
+
+   /* Fills the gaps between the sub-blocks of t with blocks of single
+      variables, so the sub-blocks cover t */
+static int reorder_coverblock(BddTree *t)
+{
+   int v = t->first;
+   BddTree *sub;
+
+   for (sub=t->nextlevel ; v <= t->last ; )
+   {
+      int end = sub != NULL ? sub->first : t->last+1;
+
+      for ( ; v < end ; v++)
+      {
+         BddTree *tnew = bddtree_addrange(t->nextlevel, v, v, BDD_REORDER_FIXED, blockid++);
+         if (tnew == NULL)
+            return bdd_error(BDD_VARBLK);
+         t->nextlevel = tnew;
+      }
+
+      if (sub != NULL)
+      {
+         v = sub->last+1;
+         sub = sub->next;
+      }
+   }
+
+   return 0;
+}
+
+
+static int compare_level(const void *a, const void *b)
+{
+   return block_top(*(BddTree**)a) - block_top(*(BddTree**)b);
+}
+
+
+static int compare_first(const void *a, const void *b)
+{
+   return (*(BddTree**)a)->first - (*(BddTree**)b)->first;
+}
+
+
+   /* Reorders the sub-blocks of t unless t is fixed, then the insides
+      of each of them. The variables of a free block without sub-blocks
+      are moved one by one */
+static int reorder_block(BddTree *t, int method)
+{
+   BddTree **blk, *sub;
+   int num = 0, n;
+
+   if (t->first == t->last  ||
+       (t->nextlevel == NULL  &&  t->fixed == BDD_REORDER_FIXED))
+      return 0;
+   if (reorder_coverblock(t) < 0)
+      return -1;
+
+   for (sub=t->nextlevel ; sub != NULL ; sub=sub->next)
+      num++;
+   if ((blk=NEW(BddTree*, num)) == NULL)
+      return bdd_error(BDD_MEMORY);
+   for (sub=t->nextlevel, n=0 ; sub != NULL ; sub=sub->next)
+      blk[n++] = sub;
+
+   if (t->fixed == BDD_REORDER_FREE)
+   {
+      qsort(blk, num, sizeof(BddTree*), compare_level);
+      if (reorder_method(blk, num, method) < 0)
+      {
+         free(blk);
+         return -1;
+      }
+   }
+
+   for (n=0 ; n<num ; n++)
+      if (reorder_block(blk[n], method) < 0)
+      {
+         free(blk);
+         return -1;
+      }
+
+      /* The list stays sorted by variable, which bddtree_addrange
+         relies on */
+   qsort(blk, num, sizeof(BddTree*), compare_first);
+   for (n=0 ; n<num ; n++)
+   {
+      blk[n]->prev = n > 0 ? blk[n-1] : NULL;
+      blk[n]->next = n < num-1 ? blk[n+1] : NULL;
+   }
+   t->nextlevel = blk[0];
+   free(blk);
+
+   if (t->seq != NULL)
+      bddtree_updateseq(t);
+   return 0;
+}
+
+
+/*************************************************************************
+  Reordering interface
+*************************************************************************/
+
+   /* Builds a free top block over all variables with the user blocks
+      inside it. Variables outside the user blocks get a block each */
+static BddTree *reorder_top(void)
+{
+   BddTree *top = bddtree_new(-1);
+
+   if (top == NULL)
+      return NULL;
+
+   top->first = 0;
+   top->last = bddvarnum-1;
+   top->fixed = BDD_REORDER_FREE;
+   top->nextlevel = vartree;
+
+   return top;
+}
+
+
+void bdd_reorder(int method)
+{
+   BDD_EXCLUSIVE;
+   BddTree *top;
+   clock_t c1 = clock();
+
+   if (bddvarnum < 2  ||  method == BDD_REORDER_NONE)
+      return;
+
+   if (reorder_handler != NULL)
+      reorder_handler(1);
+
+   if ((top=reorder_top()) == NULL)
+      return;
+
+   if (reorder_init() < 0)
+   {
+      free(top);
+      return;
+   }
+
+   usednum_before = bddnodesize - bddfreenum;
+   reorder_block(top, method);
+   vartree = top->nextlevel;
+   free(top);
+
+   reorder_done();
+   usednum_after = bddnodesize - bddfreenum;
+
+   if (verbose)
+      printf("Reordered %d -> %d nodes in %.2f sec\n", usednum_before,
+             usednum_after, (float)(clock()-c1)/CLOCKS_PER_SEC);
+
+   if (reorder_handler != NULL)
+      reorder_handler(0);
+}
+
+
+int bdd_reorder_gain(void)
+{
+   if (usednum_before == 0)
+      return 0;
+
+   return (100*(usednum_before - usednum_after)) / usednum_before;
+}
+
+
+   /* Tells the garbage collector whether a reordering is due. It is, when
+      more nodes are still alive after the collection than were left by
+      the last reordering, doubled */
+int bdd_reorder_ready(void)
+{
+   if (bddreordermethod == BDD_REORDER_NONE  ||  bddreorderdisabled  ||
+       bddreorderstopped  ||  bddreordertimes == 0  ||  levels != NULL)
+      return 0;
+
+   return bddnodesize - bddfreenum > usednum_next;
+}
+
+
+   /* Runs the reordering asked for by the garbage collector. The result
+      of the last operator must be on the reference stack or kept as
+      lastres */
+void bdd_reorder_auto(void)
+{
+   BDD_EXCLUSIVE;
+
+   if (!bddreorderpending)
+      return;
+
+   if (bddreordermethod != BDD_REORDER_NONE  &&  !bddreorderdisabled  &&
+       !bddreorderstopped  &&  bddreordertimes != 0)
+   {
+      bdd_reorder(bddreordermethod);
+      if (bddreordertimes > 0)
+         bddreordertimes--;
+      if (bdd_reorder_gain() < REORDERMINGAIN)
+         bddreorderstopped = 1;
+
+      usednum_next = usednum_after*2 > REORDERSTART ? usednum_after*2 : REORDERSTART;
+   }
+
+   bddreorderpending = 0;
+}
+
+
+int bdd_autoreorder(int method)
+{
+   int old = bddreordermethod;
+
+   bddreordermethod = method;
+   bddreordertimes = -1;
+   bddreorderstopped = 0;
+   return old;
+}
+
+
+int bdd_autoreorder_times(int method, int num)
+{
+   int old = bddreordermethod;
+
+   bddreordermethod = method;
+   bddreordertimes = num;
+   bddreorderstopped = 0;
+   return old;
+}
+
+
+int bdd_getreorder_method(void)
+{
+   return bddreordermethod;
+}
+
+
+int bdd_getreorder_times(void)
+{
+   return bddreordertimes;
+}
+
+
+void bdd_disable_reorder(void)
+{
+   bddreorderdisabled = 1;
+}
+
+
+void bdd_enable_reorder(void)
+{
+   bddreorderdisabled = 0;
+}
+
+
+int bdd_reorder_verbose(int v)
+{
+   int old = verbose;
+   verbose = v;
+   return old;
+}
+
+
+bddinthandler bdd_reorder_hook(bddinthandler handler)
+{
+   bddinthandler tmp = reorder_handler;
+   reorder_handler = handler;
+   return tmp;
+}
+
+
+bddfilehandler bdd_blockfile_hook(bddfilehandler handler)
+{
+   bddfilehandler tmp = blockfile_handler;
+   blockfile_handler = handler;
+   return tmp;
+}
+
+
+bddsizehandler bdd_reorder_probe(bddsizehandler handler)
+{
+   bddsizehandler tmp = reorder_nodenum_handler;
+   reorder_nodenum_handler = handler;
+   return tmp;
+}
+
+
+void bdd_default_reohandler(int prestate)
+{
+   static clock_t c1;
+
+   if (!verbose)
+      return;
+
+   if (prestate)
+   {
+      printf("Start reordering\n");
+      c1 = clock();
+   }
+   else
+      printf("End reordering. Went from %d to %d nodes (%.1f sec)\n",
+             usednum_before, usednum_after, (float)(clock()-c1)/CLOCKS_PER_SEC);
+}
+
+
+/*************************************************************************
+  Variable blocks
+*************************************************************************/
+
+void bdd_clrvarblocks(void)
+{
+   bddtree_del(vartree);
+   vartree = NULL;
+   blockid = 0;
+}
+
+
+int bdd_addvarblock(BDD b, int fixed)
+{
+   int *v, size, n, first, last;
+   BddTree *t;
+
+   if ((n=bdd_scanset(b, &v, &size)) < 0)
+      return n;
+   if (size < 1)
+      return bdd_error(BDD_VARBLK);
+
+   first = last = v[0];
+   for (n=0 ; n<size ; n++)
+   {
+      if (v[n] < first)
+         first = v[n];
+      if (v[n] > last)
+         last = v[n];
+   }
+   free(v);
+
+   if ((t=bddtree_addrange(vartree, first, last, fixed, blockid)) == NULL)
+      return bdd_error(BDD_VARBLK);
+
+   vartree = t;
+   return blockid++;
+}
+
+
+int bdd_intaddvarblock(int first, int last, int fixed)
+{
+   BddTree *t;
+
+   if (first < 0  ||  first >= bddvarnum  ||  last < 0  ||  last >= bddvarnum)
+      return bdd_error(BDD_VAR);
+
+   if ((t=bddtree_addrange(vartree, first, last, fixed, blockid)) == NULL)
+      return bdd_error(BDD_VARBLK);
+
+   vartree = t;
+   return blockid++;
+}
+
+
+void bdd_varblockall(void)
+{
+   int n;
+
+   for (n=0 ; n<bddvarnum ; n++)
+      bdd_intaddvarblock(n, n, BDD_REORDER_FIXED);
+}
+
+
+/*************************************************************************
+  Interaction hints
+*************************************************************************/
+
+   /* Tells reordering that the variables in varset occur together, for
+      instance in one constraint of a conjunction. Once a variable has
+      been mentioned, sifting only moves it past the variables it was
+      mentioned with, even where the roots say more interact */
+int bdd_addinteraction(BDD varset)
+{
+   BDD_EXCLUSIVE;
+   int *v, size, n, m;
+
+   if ((n=bdd_scanset(varset, &v, &size)) < 0)
+      return n;
+
+   if (hintmtx == NULL  ||  hintmtx->size < bddvarnum)
+   {
+      imatrix *mtx = imatrixNew(bddvarnum);
+
+      if (mtx == NULL)
+      {
+         free(v);
+         return bdd_error(BDD_MEMORY);
+      }
+      for (n=0 ; hintmtx != NULL  &&  n<hintmtx->size ; n++)
+         memcpy(mtx->rows[n], hintmtx->rows[n], hintmtx->size/8+1);
+      imatrixDelete(hintmtx);
+      hintmtx = mtx;
+   }
+
+   for (n=0 ; n<size ; n++)
+      for (m=0 ; m<size ; m++)
+         imatrixSet(hintmtx, v[n], v[m]);
+   free(v);
+
+   return 0;
+}
+
+
+void bdd_clrinteraction(void)
+{
+   BDD_EXCLUSIVE;
+
+   imatrixDelete(hintmtx);
+   hintmtx = NULL;
+}
+
+
+void bdd_fprintorder(FILE *ofile)
+{
+   BDD_EXCLUSIVE;
+   int n;
+
+   if (vartree != NULL)
+   {
+      bddtree_print(ofile, vartree, 0);
+      return;
+   }
+
+   for (n=0 ; n<bddvarnum ; n++)
+      fprintf(ofile, "%d%c", bddlevel2var[n], n < bddvarnum-1 ? ' ' : '\n');
+}
+
+
+void bdd_printorder(void)
+{
+   bdd_fprintorder(stdout);
+}
+
+
+/*************************************************************************
+  Explicit orders
+*************************************************************************/
+
+   /* Brings the variable v2 where v1 is and v1 where v2 is. Not allowed
+      with variable blocks, which would end up split */
+int bdd_swapvar(int v1, int v2)
+{
+   BDD_EXCLUSIVE;
+   int l1, l2, n;
+
+   if (vartree != NULL)
+      return bdd_error(BDD_VARBLK);
+   if (v1 < 0  ||  v1 >= bddvarnum  ||  v2 < 0  ||  v2 >= bddvarnum)
+      return bdd_error(BDD_VAR);
+   if (v1 == v2)
+      return 0;
+
+   if (bddvar2level[v1] > bddvar2level[v2])
+   {
+      n = v1;
+      v1 = v2;
+      v2 = n;
+   }
+   l1 = bddvar2level[v1];
+   l2 = bddvar2level[v2];
+
+   if (reorder_init() < 0)
+      return -1;
+
+   for (n=l1 ; n<l2 ; n++)
+      if (reorder_swap(n) < 0)
+         break;
+   for (n=l2-2 ; n>=l1 ; n--)
+      if (reorder_swap(n) < 0)
+         break;
+
+   reorder_done();
+   return bdderrorcond ? -bdderrorcond : 0;
+}
+
+
+   /* Updates the variable order of t and its sub-blocks */
+static int reorder_updateseqs(BddTree *t)
+{
+   for ( ; t != NULL ; t=t->next)
+      if (bddtree_updateseq(t) < 0  ||  reorder_updateseqs(t->nextlevel) < 0)
+         return -1;
+   return 0;
+}
+
+
+   /* Sets the order where neworder[level] is the variable at level. The
+      variable blocks must still be on consecutive levels afterwards, or
+      they are all removed */
+void bdd_setvarorder(int *neworder)
+{
+   BDD_EXCLUSIVE;
+   int level;
+
+   if (reorder_init() < 0)
+      return;
+
+   for (level=0 ; level<bddvarnum ; level++)
+   {
+      int var = neworder[level];
+
+      if (var < 0  ||  var >= bddvarnum)
+      {
+         bdd_error(BDD_VAR);
+         break;
+      }
+
+      while (bddvar2level[var] > level)
+         if (reorder_varup(var) < 0)
+            break;
+   }
+
+   reorder_done();
+
+   if (reorder_updateseqs(vartree) < 0)
+   {
+      bdd_clrvarblocks();
+      bdd_error(BDD_VARBLK);
+   }
+}
+
+
+/* EOF */
@@ -0,0 +1,193 @@
+/*************************************************************************
+  FILE:  tree.cpp
+  DESCR: Trees of variable blocks for reordering
+*************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "kernel.h"
+#include "bddtree.h"
+
+
+BddTree *bddtree_new(int id)
+{
+   BddTree *t = NEW(BddTree,1);
+   if (t == NULL)
+      return NULL;
+
+   t->first = t->last = -1;
+   t->fixed = 1;
+   t->next = t->prev = t->nextlevel = NULL;
+   t->seq = NULL;
+   t->id = id;
+   return t;
+}
+
+
+void bddtree_del(BddTree *t)
+{
+   while (t != NULL)
+   {
+      BddTree *next = t->next;
+
+      bddtree_del(t->nextlevel);
+      free(t->seq);
+      free(t);
+      t = next;
+   }
+}
+
+
+   /* Lists the variables of a block in their current order. They must
+      be on consecutive levels */
+int bddtree_updateseq(BddTree *t)
+{
+   int n, low = t->first;
+
+   for (n=t->first ; n<=t->last ; n++)
+      if (bddvar2level[n] < bddvar2level[low])
+         low = n;
+
+   for (n=t->first ; n<=t->last ; n++)
+   {
+      int pos = bddvar2level[n] - bddvar2level[low];
+      if (pos > t->last - t->first)
+         return -1;
+      t->seq[pos] = n;
+   }
+
+   return 0;
+}
+
+
+static BddTree *bddtree_newrange(int first, int last, int fixed, int id)
+{
+   BddTree *t = bddtree_new(id);
+
+   if (t == NULL)
+      return NULL;
+
+   t->first = first;
+   t->last = last;
+   t->fixed = fixed;
+   if ((t->seq=NEW(int,last-first+1)) == NULL  ||  bddtree_updateseq(t) < 0)
+   {
+      bddtree_del(t);
+      return NULL;
+   }
+
+   return t;
+}
+
+
+static BddTree *bddtree_addrange_rec(BddTree *t, BddTree *prev,
+                                     int first, int last, int fixed, int id)
+{
+   if (first < 0  ||  last < 0  ||  last < first)
+      return NULL;
+
+      /* Empty tree -> build one */
+   if (t == NULL)
+   {
+      if ((t=bddtree_newrange(first, last, fixed, id)) == NULL)
+         return NULL;
+      t->prev = prev;
+      return t;
+   }
+
+      /* Same block twice */
+   if (first == t->first  &&  last == t->last)
+      return t;
+
+      /* Before this block -> insert */
+   if (last < t->first)
+   {
+      BddTree *tnew = bddtree_newrange(first, last, fixed, id);
+      if (tnew == NULL)
+         return NULL;
+      tnew->next = t;
+      tnew->prev = t->prev;
+      t->prev = tnew;
+      return tnew;
+   }
+
+      /* After this block -> go to the next */
+   if (first > t->last)
+   {
+      BddTree *next = bddtree_addrange_rec(t->next, t, first, last, fixed, id);
+      if (next == NULL)
+         return NULL;
+      t->next = next;
+      return t;
+   }
+
+      /* Inside this block -> insert one level down */
+   if (first >= t->first  &&  last <= t->last)
+   {
+      BddTree *sub = bddtree_addrange_rec(t->nextlevel, NULL, first, last, fixed, id);
+      if (sub == NULL)
+         return NULL;
+      t->nextlevel = sub;
+      return t;
+   }
+
+      /* Covering this and maybe more blocks -> insert above them */
+   if (first <= t->first)
+   {
+      BddTree *cur = t;
+
+      for (;;)
+      {
+            /* Partial cover -> error */
+         if (last >= cur->first  &&  last < cur->last)
+            return NULL;
+
+         if (cur->next == NULL  ||  last < cur->next->first)
+         {
+            BddTree *tnew = bddtree_newrange(first, last, fixed, id);
+            if (tnew == NULL)
+               return NULL;
+            tnew->nextlevel = t;
+            tnew->next = cur->next;
+            tnew->prev = t->prev;
+            if (cur->next != NULL)
+               cur->next->prev = tnew;
+            cur->next = NULL;
+            t->prev = NULL;
+            return tnew;
+         }
+
+         cur = cur->next;
+      }
+   }
+
+   return NULL;
+}
+
+
+   /* Adds the block of variables first..last to the tree t and returns
+      the new tree, or NULL if the block overlaps another one partially */
+BddTree *bddtree_addrange(BddTree *t, int first, int last, int fixed, int id)
+{
+   return bddtree_addrange_rec(t, NULL, first, last, fixed, id);
+}
+
+
+void bddtree_print(FILE *o, BddTree *t, int level)
+{
+   for ( ; t != NULL ; t=t->next)
+   {
+      int n;
+
+      fprintf(o, "%*s", level*3, "");
+      fprintf(o, "%3d {", t->id);
+      for (n=0 ; n<=t->last-t->first ; n++)
+         fprintf(o, " %d", t->seq[n]);
+      fprintf(o, " }%s\n", t->fixed ? " fixed" : "");
+
+      bddtree_print(o, t->nextlevel, level+1);
+   }
+}
+
+
+/* EOF */
@@ -19,28 +19,50 @@ void config::readProperties(std::string &filename) {
         auto v2 = split(str, '.');
 
         auto arr = split(v2[v2.size()-1], '=');
+        // Branch on the key only: a value may contain anything, a path
+        // like /var/cache/x.order too.
+        const auto &key = v1[0];
 
-        if (str.contains("first")) {
+        if (key.contains("first")) {
             firstCondition.emplace_back(magic_enum::enum_cast<Object>(arr[0]).value(), magic_enum::enum_cast<Nation>(arr[1]).value());
-        } else if (str.contains("second")) {
-            if (str.contains("owns")) {
+        } else if (key.contains("second")) {
+            if (key.contains("owns")) {
                 secondConditionWithOwns.emplace_back(magic_enum::enum_cast<Nation>(arr[0]).value(), mapO[arr[1]]);
-            } else if (str.contains("transport")) {
+            } else if (key.contains("transport")) {
                 secondConditionWithTransport.emplace_back(magic_enum::enum_cast<Nation>(arr[0]).value(), mapP[arr[1]]);
-            } else if (str.contains("hair")) {
+            } else if (key.contains("hair")) {
                 secondConditionWithColor.emplace_back(magic_enum::enum_cast<Nation>(arr[0]).value(), mapC[arr[1]]);
             }
-        } else if (str.contains("third")) {
+        } else if (key.contains("third")) {
             forthCondition.emplace_back(magic_enum::enum_cast<Nation>(arr[0]).value(), magic_enum::enum_cast<Nation>(arr[1]).value());
-        } else if (str.contains("forth")) {
+        } else if (key.contains("forth")) {
             forthCondition.emplace_back(magic_enum::enum_cast<Nation>(arr[0]).value(), magic_enum::enum_cast<Nation>(arr[1]).value());
-        } else if (str.contains("neigh")) {
-            if (str.contains("left")) {
+        } else if (key.contains("neigh")) {
+            if (key.contains("left")) {
                 leftNeighbourXYOffset.emplace_back(stoi(arr[arr.size()-1]));
             } else {
                 rightNeighbourXYOffset.emplace_back(stoi(arr[arr.size()-1]));
             }
-        } else if (str.contains("vertSkleika")) {
+        } else if (key.starts_with("bdd.")) {
+            if (key.contains("nodes")) {
+                nodeNum = stoi(arr[1]);
+            } else if (key.contains("cache")) {
+                cacheSize = stoi(arr[1]);
+            } else if (key.contains("backend")) {
+                backend = arr[1];
+            } else if (key.contains("encoding")) {
+                encoding = arr[1];
+            } else if (key.contains("conjoin")) {
+                conjoin = arr[1];
+            } else if (key.contains("orderfile")) {
+                // Everything after the first '=', which a path may contain.
+                orderFile = v1.size() > 1 ? str.substr(str.find('=') + 1) : "";
+            } else if (key.contains("reorder")) {
+                reorderMethod = arr[1];
+            } else if (key.contains("order")) {
+                order = arr[1];
+            }
+        } else if (key.contains("vertSkleika")) {
             vertSkleika = arr[1] == "1";
         } else {
             horSkleika = arr[1] == "1";
@@ -83,6 +105,12 @@ const std::vector<std::tuple<Nation, Nation>> &config::getForthCondition() const
     return forthCondition;
 }
 
+int config::getConstraintCount() const {
+    return static_cast<int>(firstCondition.size() + secondConditionWithOwns.size()
+        + secondConditionWithTransport.size() + secondConditionWithColor.size()
+        + thirdCondition.size() + forthCondition.size());
+}
+
 std::vector<int> & config::getLeftNeighbourXyOffset() {
     return leftNeighbourXYOffset;
 }
@@ -22,6 +22,15 @@ private:
     bool vertSkleika;
     bool horSkleika;
 
+    int nodeNum = 0;
+    int cacheSize = 0;
+    std::string reorderMethod = "none";
+    std::string order = "object";
+    std::string orderFile;
+    std::string backend = "bdd";
+    std::string encoding = "bits";
+    std::string conjoin = "sequential";
+
     std::map<std::string, Transport> mapP = {
             {"HELICOPTER", Transport::HELICOPTER},
             {"BUS", Transport::BUS},
@@ -86,6 +95,54 @@ public:
     [[nodiscard]] bool isHorSkleika() const {
         return horSkleika;
     }
+
+    // Number of constraints loaded from the properties file.
+    [[nodiscard]] int getConstraintCount() const;
+
+    // bdd.nodes and bdd.cache from the properties file, 0 when not set.
+    [[nodiscard]] int getNodeNum() const {
+        return nodeNum;
+    }
+
+    [[nodiscard]] int getCacheSize() const {
+        return cacheSize;
+    }
+
+    // bdd.reorder from the properties file: none, win2, win2ite, win3,
+    // win3ite, sift, siftite or random.
+    [[nodiscard]] const std::string &getReorderMethod() const {
+        return reorderMethod;
+    }
+
+    // bdd.order from the properties file: object, property, interleaved
+    // or heuristic.
+    [[nodiscard]] const std::string &getOrder() const {
+        return order;
+    }
+
+    // bdd.orderfile from the properties file, empty or "none" when orders are not saved.
+    [[nodiscard]] const std::string &getOrderFile() const {
+        return orderFile;
+    }
+
+    // bdd.backend from the properties file: bdd, mdd for one 9-valued
+    // variable per object and property, or zdd for one-hot variables.
+    [[nodiscard]] const std::string &getBackend() const {
+        return backend;
+    }
+
+    // bdd.encoding from the properties file: bits, or fdd for a finite
+    // domain per object and property (fdd.h).
+    [[nodiscard]] const std::string &getEncoding() const {
+        return encoding;
+    }
+
+    // bdd.conjoin from the properties file: sequential, balanced to
+    // conjoin the two smallest formulas first, or scheduled to cluster and
+    // order the conditions by their supports (BDDFormulaBuilder::Mode).
+    [[nodiscard]] const std::string &getConjoin() const {
+        return conjoin;
+    }
 };
 
 
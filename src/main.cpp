@@ -2,13 +2,27 @@
 #include <vector>
 #include <ranges>
 #include <algorithm>
+#include <optional>
+#include <chrono>
+#include <optional>
 #include <set>
+#include <string_view>
+#include <thread>
+#include <utility>
 #include "bdd.h"
 #include "BDDHelper.hpp"
 #include "BDDFormulaBuilder.hpp"
 #include "Conditions.hpp"
 #include "PrintHelper.hpp"
 #include "config.h"
+#include "BDDSizing.hpp"
+#include "BDDMetrics.hpp"
+#include "VarOrder.hpp"
+#include "OrderCache.hpp"
+#include "MDDHelper.hpp"
+#include "ZDDHelper.hpp"
+#include "DiagramFormulaBuilder.hpp"
+#include "magic_enum.h"
 
 using namespace bddHelper;
 
@@ -60,7 +74,28 @@ void printProp(Property prop, int valNum)
       }
     }
 
-    void printObjects()
+    // Prints every object with valueOf(objNum, propNum) for its properties,
+    // or only for the one given.
+    template < class ValueOf >
+    void printObjectValues(ValueOf valueOf, std::optional< Property > only = std::nullopt)
+    {
+      for (auto objNum : std::views::iota(0, nObjs))
+      {
+        auto obj = static_cast< Object >(objNum);
+        std::cout << to_string(obj) << " {\n";
+        for (auto propNum : std::views::iota(0, nProps))
+        {
+          auto prop = static_cast< Property >(propNum);
+          if (only && prop != *only)
+            continue;
+          std::cout << '\t' << to_string(prop) << ": ";
+          printProp(prop, valueOf(objNum, propNum));
+        }
+        std::cout << "}\n";
+      }
+    }
+
+    void printObjects(const varOrder::VarOrder &order, std::optional< Property > only = std::nullopt)
     {
       if (varset.empty())
       {
@@ -73,49 +108,136 @@ void printProp(Property prop, int valNum)
                           Otherwise there is an error in calculations.\n";
             return;
       }
-      for (auto objNum : std::views::iota(0, nObjs))
+      // A bit left out of the path (-1) may take either value.
+      printObjectValues([&order](int objNum, int propNum) {
+        int valNum = 0;
+        for (auto bit : std::views::iota(0, nValueBits))
+          valNum = (valNum << 1) + (varset.at(order.var(objNum, propNum, bit)) == 1);
+        return valNum;
+      }, only);
+    }
+
+    // Reads "--name=N" or "--name N" from the command line, 0 when absent.
+    int intOption(int argc, char **argv, std::string_view name)
+    {
+      for (int i = 1; i < argc; ++i)
       {
-        auto obj = static_cast< Object >(objNum);
-        std::cout << to_string(obj) << " {\n";
-        for (auto propNum : std::views::iota(0, nProps))
-        {
-          auto prop = static_cast< Property >(propNum);
-          std::cout << '\t' << to_string(prop) << ": ";
-          auto baseIndex = objNum * nProps * nValueBits + propNum * nValueBits;
-          int valNum = (varset.at(baseIndex) << 3) +
-                       (varset.at(baseIndex + 1) << 2) +
-                       (varset.at(baseIndex + 2) << 1) +
-                       (varset.at(baseIndex + 3) << 0);
-          printProp(prop, valNum);
-        }
-        std::cout << "}\n";
+        std::string_view arg = argv[i];
+        if (!arg.starts_with(name))
+          continue;
+        arg.remove_prefix(name.size());
+        if (arg.starts_with('='))
+          return std::stoi(std::string(arg.substr(1)));
+        if (arg.empty() && i + 1 < argc)
+          return std::stoi(argv[i + 1]);
+      }
+      return 0;
+    }
+
+    bool flagOption(int argc, char **argv, std::string_view name)
+    {
+      return std::find(argv + 1, argv + argc, name) != argv + argc;
+    }
+
+    // Reads "--name=value" or "--name value", nothing when absent. The
+    // value may be empty.
+    std::optional< std::string_view > optionValue(int argc, char **argv, std::string_view name)
+    {
+      for (int i = 1; i < argc; ++i)
+      {
+        std::string_view arg = argv[i];
+        if (!arg.starts_with(name))
+          continue;
+        arg.remove_prefix(name.size());
+        if (arg.starts_with('='))
+          return arg.substr(1);
+        if (arg.empty() && i + 1 < argc)
+          return argv[i + 1];
+      }
+      return std::nullopt;
+    }
+
+    // Reads "--name=value" or "--name value", empty when absent.
+    std::string_view stringOption(int argc, char **argv, std::string_view name)
+    {
+      return optionValue(argc, argv, name).value_or(std::string_view{});
+    }
+
+    // Maps a reordering method name to its BDD_REORDER_ constant, -1 if unknown.
+    int reorderMethod(std::string_view name)
+    {
+      constexpr std::pair< std::string_view, int > methods[] = {
+        {"none", BDD_REORDER_NONE},
+        {"win2", BDD_REORDER_WIN2},
+        {"win2ite", BDD_REORDER_WIN2ITE},
+        {"win3", BDD_REORDER_WIN3},
+        {"win3ite", BDD_REORDER_WIN3ITE},
+        {"sift", BDD_REORDER_SIFT},
+        {"siftite", BDD_REORDER_SIFTITE},
+        {"random", BDD_REORDER_RANDOM} };
+      for (auto [methodName, method] : methods)
+        if (methodName == name)
+          return method;
+      return -1;
+    }
+
+    // Builds the puzzle on the MDD backend (one nVals-valued variable per
+    // object and property) or the ZDD one (one-hot), which need no upper
+    // bound conditions.
+    template < class Helper_t, class Manager_t >
+    void runDiagram(std::string_view name, Manager_t &manager, const std::set<ConditionTypes> &types)
+    {
+      Helper_t h(manager);
+      DiagramFormulaBuilder builder(h.trueFormula());
+      conditions::addConditions(h, builder, types);
+      auto result = builder.result();
+      std::cout << name << " formula created with " << manager.nodeCount(result) << " nodes ("
+                << manager.allocated() << " built).\n";
+      std::cout << "Starting counting sets...\n";
+      std::cout << "Count of true variables values combinations: " << manager.satCount(result) << '\n';
+      std::cout << "Objects are...\n";
+      auto solution = h.anySolution(result);
+      if (!solution)
+      {
+        std::cout << "No suitable object property value combination was found.\n";
+        return;
       }
+      printObjectValues([&solution](int objNum, int propNum) { return (*solution)[objNum][propNum]; });
     }
 
-    int main() {
-      bdd_init(3000000, 100000);
+    int main(int argc, char **argv) {
+      config config;
+      // Command line takes precedence over bdd.nodes / bdd.cache in the properties.
+      int nodesOverride = intOption(argc, argv, "--nodes");
+      int cacheOverride = intOption(argc, argv, "--cache");
+      auto tableSize = bddSizing::estimate(nTotalVars, config.getConstraintCount(),
+        nodesOverride ? nodesOverride : config.getNodeNum(),
+        cacheOverride ? cacheOverride : config.getCacheSize());
+      bdd_init(tableSize.nodes, tableSize.cache);
+      // Collections only go parallel once the table is large, see GBCMINPART.
+      int gcThreads = intOption(argc, argv, "--gc-threads");
+      bdd_setgbcthreads(gcThreads ? gcThreads : std::max(1u, std::thread::hardware_concurrency()));
+      bddMetrics::install();
       bdd_setvarnum(BDDHelper::nTotalVars);
-      std::vector< bdd > vars(nTotalVars);
-      { // Here we just put all these variables in array.
-        int i = 0;
-        std::generate(std::begin(vars), std::end(vars),
-          [&i]() {
-          return bdd_ithvar(i++);
-        });
+      // Command line takes precedence over bdd.order / bdd.reorder in the properties.
+      std::string_view orderName = stringOption(argc, argv, "--order");
+      if (orderName.empty())
+        orderName = config.getOrder();
+      auto strategy = varOrder::parse(orderName);
+      if (!strategy)
+      {
+        std::cerr << "Unknown variable order " << orderName << ", using object\n";
+        strategy = varOrder::Strategy::OBJECT_MAJOR;
       }
-      auto structedVars = vect< vect< vect< bdd > > >(nObjs);
-      for (auto objNum : std::views::iota(0, nObjs))
+      std::string_view reorderName = stringOption(argc, argv, "--reorder");
+      if (reorderName.empty())
+        reorderName = config.getReorderMethod();
+      int reorder = reorderMethod(reorderName);
+      if (reorder < 0)
       {
-        structedVars[objNum] = vect< vect< bdd > >(nProps);
-        for (auto propNum : std::views::iota(0, nProps))
-        {
-          auto baseIndex = objNum * nProps * nValueBits + propNum * nValueBits;
-          structedVars[objNum][propNum] = vect< bdd >{
-            bdd_ithvar(baseIndex + 0),
-            bdd_ithvar(baseIndex + 1),
-            bdd_ithvar(baseIndex + 2),
-            bdd_ithvar(baseIndex + 3) };
-        }
+        std::cerr << "Unknown reordering method " << reorderName << ", using none\n";
+        reorderName = "none";
+        reorder = BDD_REORDER_NONE;
       }
 
     std::set<ConditionTypes> types = {
@@ -126,20 +248,177 @@ void printProp(Property prop, int valNum)
           ConditionTypes::UPPER_BOUND
     };
 
-    config config;
+    // Command line takes precedence over bdd.backend in the properties.
+    std::string_view backend = stringOption(argc, argv, "--backend");
+    if (backend.empty())
+      backend = config.getBackend();
+    if (backend == "mdd")
+    {
+      mdd::Manager manager(MDDHelper::arities());
+      runDiagram< MDDHelper >("Mdd", manager, types);
+      bdd_done();
+      return 0;
+    }
+    if (backend == "zdd")
+    {
+      zdd::Manager manager(ZDDHelper::nTotalVars);
+      runDiagram< ZDDHelper >("Zdd", manager, types);
+      bdd_done();
+      return 0;
+    }
+    if (backend != "bdd")
+      std::cerr << "Unknown backend " << backend << ", using bdd\n";
 
+    varOrder::VarOrder order(*strategy);
+    if (*strategy == varOrder::Strategy::HEURISTIC)
+    {
+      // The heuristic looks at the conditions one by one, which are cheap
+      // to build; only their conjunction is expensive.
+      order = varOrder::VarOrder::heuristic([&types](const varOrder::VarOrder &probe) {
+        BDDFormulaBuilder collect(BDDFormulaBuilder::Mode::COLLECT);
+        bddHelper::BDDHelper probeHelper(probe.structedVars());
+        conditions::addConditions(probeHelper, collect, types);
+        return collect.conditions();
+      });
+    }
+    // Command line takes precedence over bdd.encoding in the properties.
+    std::string_view encodingName = stringOption(argc, argv, "--encoding");
+    if (encodingName.empty())
+      encodingName = config.getEncoding();
+    auto domainGroups = order.domainGroups();
+    bool fdd = encodingName == "fdd" && !domainGroups.empty();
+    if (!fdd && encodingName != "bits")
+    {
+      std::cerr << "Unknown encoding " << encodingName << " for this order, using bits\n";
+      encodingName = "bits";
+    }
+    // Blocks keep the bits of a value together (see VarOrder::blocks), so
+    // reordering moves whole values around and never splits one. The FDD
+    // helper adds the same blocks for its domains itself.
+    if (!fdd)
+      for (auto block : order.blocks())
+        bdd_intaddvarblock(block.first, block.last, block.fixed);
     // Let's explore what is BDDHelper
-    bddHelper::BDDHelper h(structedVars);
+    auto h = fdd ? bddHelper::BDDHelper(domainGroups) : bddHelper::BDDHelper(order.structedVars());
+    // An order reordering found for this puzzle shape before is loaded
+    // before the first condition is built, and reordering is skipped.
+    // An empty --order-file or "none" turns that off.
+    std::string orderFile(optionValue(argc, argv, "--order-file").value_or(config.getOrderFile()));
+    if (orderFile == "none")
+      orderFile.clear();
+    auto shapeKey = orderCache::shapeKey(std::string(varOrder::name(order.strategy())) + (fdd ? "+fdd" : ""),
+                                         types, config);
+    bool orderLoaded = false;
+    if (!orderFile.empty() && reorder != BDD_REORDER_NONE)
+    {
+      auto levelOrder = orderCache::load(orderFile, shapeKey, nTotalVars);
+      if (!levelOrder.empty() && orderCache::respectsBlocks(levelOrder, order.blocks()))
+      {
+        bdd_setvarorder(levelOrder.data());
+        orderLoaded = true;
+        reorder = BDD_REORDER_NONE;
+        std::cout << "Variable order loaded from " << orderFile << ".\n";
+      }
+    }
+
+    // Command line takes precedence over bdd.conjoin in the properties.
+    std::string_view conjoinName = stringOption(argc, argv, "--conjoin");
+    if (conjoinName.empty())
+      conjoinName = config.getConjoin();
+    if (conjoinName != "sequential" && conjoinName != "balanced" && conjoinName != "scheduled")
+    {
+      std::cerr << "Unknown conjoin mode " << conjoinName << ", using sequential\n";
+      conjoinName = "sequential";
+    }
+    bool balanced = conjoinName == "balanced";
+    bool scheduled = conjoinName == "scheduled";
+    // Batches of a few conditions do best on this puzzle, see
+    // BDDFormulaBuilder::conjoinPending.
+    int batch = intOption(argc, argv, "--batch");
+    if (!batch)
+      batch = 4;
     // Simpliest class in the world. Just contains result formula.
-    BDDFormulaBuilder builder;
+    BDDFormulaBuilder builder(balanced    ? BDDFormulaBuilder::Mode::BALANCED
+                              : scheduled ? BDDFormulaBuilder::Mode::SCHEDULED
+                                          : BDDFormulaBuilder::Mode::CONJOIN,
+                              batch);
+    bool largest = balanced || scheduled || flagOption(argc, argv, "--largest");
+    if (largest)
+      builder.measureLargest();
+    // Only the values of one property are wanted: the others are
+    // quantified out while the conditions are conjoined.
+    std::optional< Property > projected;
+    if (auto name = stringOption(argc, argv, "--project"); !name.empty())
+    {
+      projected = magic_enum::enum_cast< Property >(name, magic_enum::case_insensitive);
+      if (projected)
+        builder.project(h.propertyVars(*projected));
+      else
+        std::cerr << "Unknown property " << name << ", keeping all of them\n";
+    }
+    // Blocks are sifted while the conditions are conjoined, whenever the
+    // table has grown enough since the last time.
+    auto buildStart = std::chrono::steady_clock::now();
+    bdd_autoreorder(reorder);
     conditions::addConditions(h, builder, types);
-    std::cout << "Bdd formula created. Starting counting sets...\n";
-    std::cout << "Count of true variables values combinations: " << bdd_satcount(builder.result()) << '\n';
+    auto result = builder.result();
+    bdd_autoreorder(BDD_REORDER_NONE);
+    std::chrono::duration< double, std::milli > buildTime = std::chrono::steady_clock::now() - buildStart;
+    // Without a reordering that moved something, the next run would load
+    // the initial order and skip reordering for good.
+    if (!orderFile.empty() && reorder != BDD_REORDER_NONE && orderCache::reordered())
+    {
+      if (orderCache::save(orderFile, shapeKey))
+        std::cout << "Variable order saved to " << orderFile << ".\n";
+      else
+        std::cerr << "Could not save the variable order to " << orderFile << '\n';
+    }
+    std::cout << "Bdd formula created with " << bdd_nodecount(result)
+              << " nodes (order: " << varOrder::name(order.strategy())
+              << ", encoding: " << encodingName
+              << ", reordering: " << (orderLoaded ? "skipped" : reorderName) << ").\n";
+    std::cout << "Built in " << buildTime.count() << " ms (conjoin: " << conjoinName;
+    if (balanced)
+      std::cout << ", batch: " << batch;
+    if (largest)
+      std::cout << ", largest intermediate formula: " << builder.largestNodes() << " nodes";
+    std::cout << ").\n";
+    std::cout << "Starting counting sets...\n";
+    if (projected)
+      std::cout << "Count of " << to_string(*projected) << " values combinations: "
+                << bdd_satcountset(result, h.propertyVars(*projected)) << '\n';
+    else
+      std::cout << "Count of true variables values combinations: " << bdd_satcount(result) << '\n';
+    if (scheduled && flagOption(argc, argv, "--schedule-json"))
+      builder.printSchedule(std::cout);
+    if (flagOption(argc, argv, "--metrics-json"))
+      bddMetrics::printJson(std::cout);
+    else
+      bddMetrics::printSummary(std::cout);
     std::cout << "Objects are...\n";
-    // Iterate over true combinations and extract one of them in varset variable.
-    bdd_allsat(builder.result(), extractSet);
-    // Print one of suitable objects properties combinations
-    printObjects();
+    if (fdd)
+    {
+      // fdd_scanallvar reads every domain off one path of the result.
+      auto solution = h.anySolution(result);
+      if (solution)
+        printObjectValues([&solution](int objNum, int propNum) { return (*solution)[objNum][propNum]; }, projected);
+      else
+        std::cout << "No suitable object property value combination was found.\n";
+    }
+    else
+    {
+      // Iterate over true combinations and extract one of them in varset variable.
+      bdd_allsat(result, extractSet);
+      // Print one of suitable objects properties combinations
+      printObjects(order, projected);
+    }
+    bddStat stats;
+    bdd_stats(stats);
+    std::cout << "Reference count calls: " << stats.refcalls << " made, "
+              << stats.refsaved << " avoided by moving handles\n";
+    std::cout << "Node table: " << tableSize.nodes << " initial, " << bdd_getallocnum()
+              << " final, " << bddMetrics::resizeEvents().size() << " resizes\n";
+    std::cout << "Peak RSS: " << bddSizing::peakRssKb() << " KB\n";
     bdd_done();
     return 0;
 }
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <bitset>
+#include <random>
+#include <thread>
+#include <vector>
+#include "bdd.h"
+
+namespace
+{
+  constexpr int nVars = 8;
+
+  // Value of a formula for every assignment; bit v of the assignment is
+  // variable v.
+  using Table = std::bitset< 1 << nVars >;
+
+  struct Formula
+  {
+    bdd root;
+    Table table;
+  };
+
+  Table varTable(int var)
+  {
+    Table res;
+    for (unsigned assignment = 0; assignment < res.size(); assignment++)
+      res[assignment] = assignment >> var & 1;
+    return res;
+  }
+
+  bool eval(bdd root, unsigned assignment)
+  {
+    while (root != bdd_true() && root != bdd_false())
+      root = assignment >> bdd_var(root) & 1 ? bdd_high(root) : bdd_low(root);
+    return root == bdd_true();
+  }
+
+  // Builds count random formulas over the variables with and, or, xor,
+  // not and ite, each from earlier ones, and the truth table of each.
+  // Only the last window formulas are kept, so the others become garbage.
+  std::vector< Formula > randomFormulas(unsigned seed, int count, size_t window)
+  {
+    std::mt19937 rng(seed);
+    std::vector< Formula > res;
+    for (int var = 0; var < nVars; var++)
+      res.push_back({ bdd_ithvar(var), varTable(var) });
+    for (int n = 0; n < count; n++)
+    {
+      const Formula &a = res[rng() % res.size()];
+      const Formula &b = res[rng() % res.size()];
+      const Formula &c = res[rng() % res.size()];
+      Formula formula;
+      switch (rng() % 5)
+      {
+        case 0: formula = { a.root & b.root, a.table & b.table }; break;
+        case 1: formula = { a.root | b.root, a.table | b.table }; break;
+        case 2: formula = { a.root ^ b.root, a.table ^ b.table }; break;
+        case 3: formula = { !a.root, ~a.table }; break;
+        default: formula = { bdd_ite(a.root, b.root, c.root), (a.table & b.table) | (~a.table & c.table) };
+      }
+      if (res.size() < window)
+        res.push_back(std::move(formula));
+      else
+        res[n % window] = std::move(formula);
+    }
+    return res;
+  }
+}
+
+// Several threads build random formulas at once in a node table so small
+// that it is collected and grown many times while they run, so operators
+// are abandoned and restarted. Every result must match its truth table.
+TEST(ConcurrentApply, MatchesTruthTables)
+{
+  unsigned seed = std::random_device{}();
+  SCOPED_TRACE("seed " + std::to_string(seed));
+  std::mt19937 rng(seed);
+  int nThreads = 8 + rng() % 9;
+
+  bdd_init(500, 100);
+  bdd_setminfreenodes(5);
+  bdd_setvarnum(nVars);
+  bdd_setconcurrent(1);
+  std::vector< std::vector< Formula > > results(nThreads);
+  {
+    std::vector< std::jthread > threads;
+    for (int t = 0; t < nThreads; t++)
+      threads.emplace_back([&results, t, threadSeed = rng()] { results[t] = randomFormulas(threadSeed, 20000, 64); });
+  }
+  bdd_setconcurrent(0);
+
+  bddStat stat;
+  bdd_stats(&stat);
+  EXPECT_GT(stat.gbcnum, 0);
+  for (const auto &formulas : results)
+    for (const auto &formula : formulas)
+    {
+      int wrong = 0;
+      for (unsigned assignment = 0; assignment < formula.table.size(); assignment++)
+        wrong += eval(formula.root, assignment) != formula.table[assignment];
+      ASSERT_EQ(wrong, 0);
+    }
+  results.clear();
+  bdd_done();
+}
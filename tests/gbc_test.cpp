@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+#include "bdd.h"
+#include "kernel.h"
+
+namespace
+{
+  // The node table, free list and unique chains after a collection.
+  // The order within a chain depends on the threads, so each is sorted.
+  struct Collected
+  {
+    std::vector< std::array< int, 4 > > nodes;
+    std::vector< int > freeList;
+    std::vector< std::vector< int > > chains;
+    std::vector< double > counts;
+  };
+
+  // Builds the same random disjunctions of cubes every time, drops every
+  // other one and collects with threads threads.
+  Collected collect(int threads)
+  {
+    Collected res;
+    bdd_init(300000, 10000);
+    bdd_gbc_hook(nullptr);
+    bdd_setvarnum(60);
+    bdd_setgbcthreads(threads);
+    {
+      std::mt19937 rng(11);
+      std::vector< bdd > formulas;
+      for (int n = 0; n < 60; n++)
+      {
+        bdd f = bddfalse;
+        for (int step = 0; step < 20; step++)
+        {
+          bdd cube = bddtrue;
+          for (int lit = 0; lit < 10; lit++)
+          {
+            int var = rng() % 60;
+            cube &= rng() & 1 ? bdd_ithvarpp(var) : bdd_nithvarpp(var);
+          }
+          f |= cube;
+        }
+        formulas.push_back(f);
+      }
+      for (size_t n = 0; n < formulas.size(); n += 2)
+        formulas[n] = bddfalse;
+
+      bdd_gbc();
+
+      for (int n = 0; n < bddnodesize; n++)
+        res.nodes.push_back({ static_cast< int >(bddnodes[n].level), bddnodes[n].low, bddnodes[n].high,
+                              static_cast< int >(bddnodes[n].refcou) });
+      for (int n = bddfreepos; n != 0; n = bddnext[n])
+        res.freeList.push_back(n);
+      res.chains.resize(bddnodesize);
+      for (int hash = 0; hash < bddnodesize; hash++)
+      {
+        for (int n = bddhash[hash]; n != 0; n = bddnext[n])
+          res.chains[hash].push_back(n);
+        std::ranges::sort(res.chains[hash]);
+      }
+      for (const auto &formula : formulas)
+        res.counts.push_back(bdd_satcount(formula));
+    }
+    bdd_done();
+    return res;
+  }
+}
+
+// The table is large enough for the parallel mark and sweep; it must
+// leave everything as the serial one does.
+TEST(ParallelGbc, MatchesSerial)
+{
+  Collected serial = collect(1);
+  ASSERT_GT(serial.freeList.size(), 0u);
+  for (int threads : { 2, 3, 4 })
+  {
+    SCOPED_TRACE(std::to_string(threads) + " threads");
+    Collected parallel = collect(threads);
+    EXPECT_TRUE(parallel.nodes == serial.nodes);
+    EXPECT_TRUE(parallel.freeList == serial.freeList);
+    EXPECT_TRUE(parallel.chains == serial.chains);
+    EXPECT_TRUE(parallel.counts == serial.counts);
+  }
+}
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "bdd.h"
+#include "kernel.h"
+
+namespace
+{
+  // Times each node is reached from the chain heads of the unique table,
+  // following at most one link per node so that a loop ends the walk.
+  std::vector< int > chainVisits()
+  {
+    std::vector< int > res(bddnodesize);
+    for (int hash = 0; hash < bddnodesize; hash++)
+    {
+      int steps = 0;
+      for (int n = bddhash[hash]; n != 0 && steps < bddnodesize; n = bddnext[n], steps++)
+        res[n]++;
+    }
+    return res;
+  }
+}
+
+// While the chains of the last resize are still being moved, a free node
+// from the old part of the table, not moved yet, is taken for a new node.
+// It must end up on one chain once, not linked to itself.
+TEST(IncrementalRehash, OldFreeNodeIsLinkedOnce)
+{
+  bdd_init(1000, 100);
+  bdd_setvarnum(24);
+  int oldSize = bddnodesize;
+  ASSERT_EQ(bdd_noderesize(1), 0);
+
+  // The new nodes come first on the free list; put the first old one
+  // before them.
+  int prev = 0;
+  int old = bddfreepos;
+  while (old >= oldSize)
+  {
+    prev = old;
+    old = bddnext[old];
+  }
+  ASSERT_NE(old, 0);
+  ASSERT_NE(prev, 0);
+  bddnext[prev] = bddnext[old];
+  bddnext[old] = bddfreepos;
+  bddfreepos = old;
+
+  {
+    bdd both = bdd_ithvarpp(22) & bdd_ithvarpp(23);
+    EXPECT_NE(bddnext[old], old);
+    EXPECT_EQ(chainVisits()[old], 1);
+    EXPECT_TRUE((bdd_ithvarpp(22) & bdd_ithvarpp(23)) == both);
+  }
+  bdd_done();
+}